@@ -1,5 +1,6 @@
 #include "api/ApiService.h"
 #include "json.hpp"
+#include "logger/logger.h"
 #include <sstream>
 #include <iostream>
 #include <iomanip>
@@ -237,7 +238,6 @@ std::string ApiService::handleLogin(const std::string& body, const std::string&
         }
         
         Session session;
-        session.token = generateSessionToken();
         session.userId = std::to_string(user.userId);
         session.email = user.email;
         session.userOS = userOS;
@@ -245,10 +245,20 @@ std::string ApiService::handleLogin(const std::string& body, const std::string&
         session.createdAt = std::chrono::system_clock::now();
         session.lastActivity = session.createdAt;
         session.expiresAt = session.createdAt + std::chrono::hours(apiConfig.sessionTimeoutHours);
+        session.token = tokenSigner.enabled()
+                            ? tokenSigner.issue(user.userId, session.createdAt, session.expiresAt)
+                            : generateSessionToken();
+        if (session.token.empty()) {
+            json errorResponse;
+            errorResponse["success"] = false;
+            errorResponse["error"] = "Не удалось создать сессию.";
+            return createJsonResponse(errorResponse.dump(), 500);
+        }
         
         if (dbService.addSession(session)) {
-            std::lock_guard<std::mutex> lock(sessionsMutex);
-            sessions[session.token] = session;
+            sessionStore.put(session);
+            // Токен мог быть отклонен раньше (например, повтор запроса до входа)
+            rejectedTokens.remove(session.token);
             
             json response;
             response["success"] = true;
@@ -361,6 +371,12 @@ std::string ApiService::handleResetPassword(const std::string& body) {
         
         user.passwordHash = hashPassword(newPassword);
         if (dbService.updateUser(user)) {
+            // После сброса пароля ни одна из прежних сессий не должна оставаться действительной
+            if (!revokeAllUserSessions(std::to_string(user.userId), nullptr)) {
+                Logger::getInstance().log("⚠️ Пароль сброшен, но сессии пользователя " + std::to_string(user.userId) +
+                                          " не отозваны", "WARNING");
+            }
+            
             json response;
             response["success"] = true;
             response["message"] = "Пароль успешно сброшен";
@@ -391,10 +407,10 @@ std::string ApiService::handleLogout(const std::string& sessionToken, const std:
     
     if (!sessionToken.empty()) {
         dbService.deleteSession(sessionToken);
-        {
-            std::lock_guard<std::mutex> lock(sessionsMutex);
-            sessions.erase(sessionToken);
-        }
+        sessionStore.erase(sessionToken);
+        sessionActivity.forget(sessionToken);
+        rejectedTokens.add(sessionToken);
+        revokeSignedToken(sessionToken);
     }
     
     json response;
@@ -0,0 +1,571 @@
+#include "api/ApiService.h"
+#include "logger/logger.h"
+#include <vector>
+#include <cstring>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+namespace {
+
+const int CLIENT_READ_TIMEOUT_SECONDS = 30;
+
+// Сколько конвейерных данных держим в памяти, пока предыдущий запрос в работе
+const size_t MAX_PIPELINED_BYTES = HttpParser::MAX_HEADERS_SIZE + HttpParser::MAX_BODY_SIZE;
+
+bool wouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EWOULDBLOCK || errno == EAGAIN;
+#endif
+}
+
+bool interrupted() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEINTR;
+#else
+    return errno == EINTR;
+#endif
+}
+
+// Добавляет заголовки Connection/Keep-Alive сразу после строки статуса
+void applyConnectionHeaders(std::string& response, bool keepAlive, int timeoutSeconds, int remainingRequests) {
+    size_t statusLineEnd = response.find("\r\n");
+    if (statusLineEnd == std::string::npos) return;
+
+    std::string headers;
+    if (keepAlive) {
+        headers = "Connection: keep-alive\r\nKeep-Alive: timeout=" + std::to_string(timeoutSeconds) +
+                  ", max=" + std::to_string(remainingRequests) + "\r\n";
+    } else {
+        headers = "Connection: close\r\n";
+    }
+    response.insert(statusLineEnd + 2, headers);
+}
+
+// Код из строки статуса "HTTP/1.1 NNN ..."; 0, если строка не распознана
+int responseStatus(const std::string& response) {
+    if (response.size() < 12 || response.compare(0, 5, "HTTP/") != 0) return 0;
+    int status = 0;
+    for (size_t i = 9; i < 12; i++) {
+        if (response[i] < '0' || response[i] > '9') return 0;
+        status = status * 10 + (response[i] - '0');
+    }
+    return status;
+}
+
+}
+
+void ApiService::acceptConnections() {
+    // Edge-triggered: принимаем все ожидающие соединения до EAGAIN
+    while (running) {
+        sockaddr_in clientAddr;
+        socklen_t addrLen = sizeof(clientAddr);
+        SOCKET_TYPE clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &addrLen);
+
+        if (clientSocket == INVALID_SOCKET_VAL) {
+            if (wouldBlock()) {
+                return;
+            }
+            if (interrupted()) {
+                continue;
+            }
+#ifdef _WIN32
+            Logger::getInstance().log("❌ Ошибка accept: " + std::to_string(WSAGetLastError()), "ERROR");
+#else
+            Logger::getInstance().log("❌ Ошибка accept: " + std::string(strerror(errno)), "ERROR");
+#endif
+            return;
+        }
+
+        // Заблокированные адреса отбрасываются до регистрации, буферов и логов:
+        // поток соединений из плохой подсети не должен стоить больше accept+close
+        uint32_t clientAddress = ntohl(clientAddr.sin_addr.s_addr);
+        if (ipFilter.isBlocked(clientAddress)) {
+            CLOSE_SOCKET(clientSocket);
+            continue;
+        }
+
+        if (!EventLoop::setNonBlocking(clientSocket) || !eventLoop.add(clientSocket, EventLoop::EVENT_READ)) {
+            Logger::getInstance().log("❌ Не удалось зарегистрировать клиентский сокет", "ERROR");
+            CLOSE_SOCKET(clientSocket);
+            continue;
+        }
+
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, ip, INET_ADDRSTRLEN);
+
+        ClientConnection& conn = connections[clientSocket];
+        conn = ClientConnection();
+        conn.id = nextConnectionId++;
+        conn.socket = clientSocket;
+        conn.clientIP = ip;
+        conn.clientAddress = clientAddress;
+        conn.acceptedAt = std::chrono::steady_clock::now();
+        conn.lastActivity = conn.acceptedAt;
+    }
+}
+
+void ApiService::handleClientEvent(SOCKET_TYPE clientSocket, uint32_t events) {
+    auto it = connections.find(clientSocket);
+    if (it == connections.end()) {
+        return;
+    }
+    ClientConnection& conn = it->second;
+
+    if (events & EventLoop::EVENT_ERROR) {
+        closeConnection(clientSocket);
+        return;
+    }
+
+    bool readable = (events & EventLoop::EVENT_READ) != 0;
+
+    if (conn.transport == ClientConnection::Transport::UNKNOWN) {
+        if (!classifyConnection(conn)) {
+            // Ни HTTP, ни TLS: закрываем, не читая поток и не записывая его в лог
+            recordClientStrike(conn.clientAddress, conn.clientIP, 400);
+            closeConnection(clientSocket);
+            return;
+        }
+        if (conn.transport == ClientConnection::Transport::UNKNOWN) {
+            if (conn.peerClosed) {
+                closeConnection(clientSocket);
+            }
+            return;
+        }
+    }
+
+    if (conn.transport == ClientConnection::Transport::TLS && !conn.tlsEstablished) {
+        if (!continueTlsHandshake(conn)) {
+            closeConnection(clientSocket);
+            return;
+        }
+        if (!conn.tlsEstablished) {
+            return;
+        }
+        // Запрос мог прийти вместе с последним сообщением рукопожатия и уже лежать в буфере OpenSSL
+        readable = true;
+    }
+
+    if ((events & EventLoop::EVENT_WRITE) && !writeToClient(conn)) {
+        closeConnection(clientSocket);
+        return;
+    }
+
+    if (readable) {
+        if (!readFromClient(conn)) {
+            Logger::getInstance().log("❌ Ошибка чтения от клиента " + conn.clientIP, "ERROR");
+            closeConnection(clientSocket);
+            return;
+        }
+        // SSL_write мог ждать входящих данных TLS - после чтения пробуем дописать ответ
+        if (conn.tls && conn.outOffset < conn.outBuffer.size() && !writeToClient(conn)) {
+            closeConnection(clientSocket);
+            return;
+        }
+        dispatchRequests(conn);
+    }
+
+    bool drained = conn.outOffset >= conn.outBuffer.size();
+    if (drained && !conn.requestInFlight && (conn.closeAfterWrite || conn.peerClosed)) {
+        closeConnection(clientSocket);
+    }
+}
+
+bool ApiService::classifyConnection(ClientConnection& conn) {
+    unsigned char head[2];
+    int received;
+    do {
+        received = recv(conn.socket, reinterpret_cast<char*>(head), sizeof(head), MSG_PEEK);
+    } while (received < 0 && interrupted());
+
+    if (received < 0) {
+        return wouldBlock();
+    }
+    if (received == 0) {
+        conn.peerClosed = true;
+        return true;
+    }
+
+    if (TlsContext::looksLikeClientHello(head, static_cast<size_t>(received))) {
+        if (!tlsContext.enabled()) {
+            return false;
+        }
+        conn.tls = tlsContext.createSession(conn.socket);
+        if (!conn.tls) {
+            return false;
+        }
+        conn.transport = ClientConnection::Transport::TLS;
+        return true;
+    }
+
+    // Запрос начинается с метода: GET, POST, PUT, DELETE, OPTIONS...
+    if (head[0] >= 'A' && head[0] <= 'Z') {
+        conn.transport = ClientConnection::Transport::PLAIN;
+        return true;
+    }
+    return false;
+}
+
+bool ApiService::continueTlsHandshake(ClientConnection& conn) {
+    int result = SSL_do_handshake(conn.tls.get());
+    if (result == 1) {
+        conn.tlsEstablished = true;
+        conn.lastActivity = std::chrono::steady_clock::now();
+        if (conn.writeInterest && conn.outOffset >= conn.outBuffer.size()) {
+            conn.writeInterest = false;
+            eventLoop.modify(conn.socket, EventLoop::EVENT_READ);
+        }
+        return true;
+    }
+
+    int error = SSL_get_error(conn.tls.get(), result);
+    if (error == SSL_ERROR_WANT_READ) {
+        return true;
+    }
+    if (error == SSL_ERROR_WANT_WRITE) {
+        watchWritable(conn);
+        return true;
+    }
+    ERR_clear_error();
+    return false;
+}
+
+void ApiService::watchWritable(ClientConnection& conn) {
+    if (!conn.writeInterest) {
+        conn.writeInterest = true;
+        eventLoop.modify(conn.socket, EventLoop::EVENT_READ | EventLoop::EVENT_WRITE);
+    }
+}
+
+bool ApiService::pipelineFull(ClientConnection& conn) {
+    // Остаток оставляем в сокете: TCP притормозит клиента, а дочитаем после ответа.
+    // Событий edge-triggered больше не будет, поэтому возобновляет чтение deliverCompletedResponses
+    if (conn.requestInFlight && conn.inBuffer.size() >= MAX_PIPELINED_BYTES) {
+        conn.readPaused = true;
+        return true;
+    }
+    return false;
+}
+
+bool ApiService::readFromClient(ClientConnection& conn) {
+    char buffer[8192];
+
+    if (conn.tls) {
+        // SSL_read читает сокет сам; как и recv, крутим до WANT_READ
+        while (true) {
+            if (pipelineFull(conn)) {
+                return true;
+            }
+            int bytesReceived = SSL_read(conn.tls.get(), buffer, sizeof(buffer));
+            if (bytesReceived > 0) {
+                conn.inBuffer.append(buffer, bytesReceived);
+                conn.lastActivity = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            int error = SSL_get_error(conn.tls.get(), bytesReceived);
+            if (error == SSL_ERROR_WANT_READ) {
+                return true;
+            }
+            if (error == SSL_ERROR_WANT_WRITE) {
+                watchWritable(conn);
+                return true;
+            }
+            if (error == SSL_ERROR_ZERO_RETURN || (error == SSL_ERROR_SYSCALL && ERR_peek_error() == 0)) {
+                conn.peerClosed = true;
+                return true;
+            }
+            ERR_clear_error();
+            return false;
+        }
+    }
+
+    // Edge-triggered: читаем до EAGAIN, иначе следующего события не будет
+    while (true) {
+        if (pipelineFull(conn)) {
+            return true;
+        }
+        int bytesReceived = recv(conn.socket, buffer, sizeof(buffer), 0);
+
+        if (bytesReceived > 0) {
+            conn.inBuffer.append(buffer, bytesReceived);
+            conn.lastActivity = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        if (bytesReceived == 0) {
+            conn.peerClosed = true;
+            return true;
+        }
+
+        if (wouldBlock()) {
+            return true;
+        }
+        if (interrupted()) {
+            continue;
+        }
+        return false;
+    }
+}
+
+bool ApiService::writeToClient(ClientConnection& conn) {
+    while (conn.outOffset < conn.outBuffer.size()) {
+        if (conn.tls) {
+            int written = SSL_write(conn.tls.get(), conn.outBuffer.data() + conn.outOffset,
+                                    static_cast<int>(conn.outBuffer.size() - conn.outOffset));
+            if (written > 0) {
+                conn.outOffset += written;
+                conn.lastActivity = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            int error = SSL_get_error(conn.tls.get(), written);
+            if (error == SSL_ERROR_WANT_WRITE) {
+                watchWritable(conn);
+                return true;
+            }
+            if (error == SSL_ERROR_WANT_READ) {
+                // Допишем после следующего чтения
+                return true;
+            }
+            ERR_clear_error();
+            Logger::getInstance().log("❌ Ошибка отправки ответа клиенту " + conn.clientIP, "ERROR");
+            return false;
+        }
+
+        int bytesSent = send(conn.socket, conn.outBuffer.data() + conn.outOffset,
+                             static_cast<int>(conn.outBuffer.size() - conn.outOffset), SEND_FLAGS);
+
+        if (bytesSent > 0) {
+            conn.outOffset += bytesSent;
+            conn.lastActivity = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        if (bytesSent < 0 && wouldBlock()) {
+            // Сокет переполнен - допишем, когда станет доступен для записи
+            watchWritable(conn);
+            return true;
+        }
+        if (bytesSent < 0 && interrupted()) {
+            continue;
+        }
+
+        Logger::getInstance().log("❌ Ошибка отправки ответа клиенту " + conn.clientIP, "ERROR");
+        return false;
+    }
+
+    conn.outBuffer.clear();
+    conn.outOffset = 0;
+    if (conn.writeInterest) {
+        conn.writeInterest = false;
+        eventLoop.modify(conn.socket, EventLoop::EVENT_READ);
+    }
+    return true;
+}
+
+void ApiService::dispatchRequests(ClientConnection& conn) {
+    // Ответ уже сформирован, соединение будет закрыто после отправки
+    if (conn.closeAfterWrite) {
+        conn.inBuffer.clear();
+        return;
+    }
+
+    // Конвейерные (pipelined) запросы обрабатываются строго по порядку:
+    // следующий уходит в пул только после того, как готов ответ на текущий
+    if (conn.requestInFlight) {
+        return;
+    }
+
+    // Парсер продолжает с того места, где остановился на прошлом recv
+    HttpParser::State state = conn.parser.parse(conn.inBuffer);
+
+    if (state == HttpParser::State::ERROR) {
+        Logger::getInstance().log("🔗 Поступил запрос от IP: " + conn.clientIP);
+        Logger::getInstance().log("❌ Некорректный запрос от " + conn.clientIP + ": " + conn.parser.errorMessage() +
+                                  " (" + std::to_string(conn.inBuffer.size()) + " байт)", "WARNING");
+        recordClientStrike(conn.clientAddress, conn.clientIP, conn.parser.errorStatus());
+        conn.inBuffer.clear();
+        conn.closeAfterWrite = true;
+        std::string response = createJsonResponse(std::string("{\"success\": false, \"error\": \"") +
+                                                  conn.parser.errorMessage() + "\"}", conn.parser.errorStatus());
+        applyConnectionHeaders(response, false, 0, 0);
+        conn.outBuffer.append(response);
+        if (!writeToClient(conn)) {
+            conn.outBuffer.clear();
+            conn.outOffset = 0;
+        }
+        return;
+    }
+
+    if (state != HttpParser::State::COMPLETE) {
+        if (conn.peerClosed && conn.requestsServed == 0) {
+            if (conn.inBuffer.empty()) {
+                Logger::getInstance().log("📭 Пустой запрос от клиента: " + conn.clientIP, "WARNING");
+            } else {
+                Logger::getInstance().log("🔌 Клиент отключился: " + conn.clientIP);
+            }
+        }
+        return;
+    }
+
+    Logger::getInstance().log("🔗 Поступил запрос от IP: " + conn.clientIP);
+
+    conn.requestsServed++;
+    int maxRequests = apiConfig.maxKeepAliveRequests;
+    bool keepAlive = conn.parser.keepAlive() && running &&
+                     (maxRequests <= 0 || conn.requestsServed < maxRequests);
+    int remainingRequests = maxRequests > 0 ? maxRequests - conn.requestsServed : 0;
+    if (!keepAlive) {
+        conn.closeAfterWrite = true;
+    }
+
+    // Запрос забираем из буфера без копирования, если за ним нет конвейерных данных
+    size_t length = conn.parser.messageLength();
+    std::string rawRequest;
+    if (length == conn.inBuffer.size()) {
+        rawRequest.swap(conn.inBuffer);
+    } else {
+        rawRequest = conn.inBuffer.substr(0, length);
+        conn.inBuffer.erase(0, length);
+    }
+
+    HttpParser request = conn.parser;
+    conn.parser.reset();
+    conn.requestInFlight = true;
+
+    SOCKET_TYPE socket = conn.socket;
+    uint64_t connectionId = conn.id;
+    std::string clientIP = conn.clientIP;
+    uint32_t clientAddress = conn.clientAddress;
+    int keepAliveTimeout = apiConfig.keepAliveTimeoutSeconds;
+
+    // Маршрутизация и работа с БД выполняются в пуле, поток событий не блокируется.
+    // Асинхронный обработчик отдает ответ позже, обычно из потока событий
+    workerPool.submit([this, socket, connectionId, clientIP, clientAddress, keepAlive, keepAliveTimeout, remainingRequests,
+                       request = std::move(request), rawRequest = std::move(rawRequest)]() mutable {
+        Router::Responder respond = [this, socket, connectionId, clientIP, clientAddress, keepAlive,
+                                     keepAliveTimeout, remainingRequests](std::string response) {
+            recordClientStrike(clientAddress, clientIP, responseStatus(response));
+            applyConnectionHeaders(response, keepAlive, keepAliveTimeout, remainingRequests);
+            {
+                std::lock_guard<std::mutex> lock(completedMutex);
+                completedResponses.push_back(CompletedResponse{socket, connectionId, std::move(response)});
+            }
+            eventLoop.wakeup();
+        };
+
+        request.rebind(rawRequest);
+        bool deferred = false;
+        std::string response = processHttpRequest(request, clientIP, respond, &deferred);
+        if (!deferred) {
+            respond(std::move(response));
+        }
+    });
+}
+
+void ApiService::deliverCompletedResponses() {
+    std::vector<CompletedResponse> ready;
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        ready.swap(completedResponses);
+    }
+
+    for (auto& completed : ready) {
+        auto it = connections.find(completed.socket);
+        // Клиент мог отключиться, пока запрос обрабатывался
+        if (it == connections.end() || it->second.id != completed.connectionId) {
+            continue;
+        }
+
+        ClientConnection& conn = it->second;
+        conn.requestInFlight = false;
+        conn.outBuffer.append(completed.response);
+
+        if (!writeToClient(conn)) {
+            closeConnection(completed.socket);
+            continue;
+        }
+
+        // Берем следующий запрос, пришедший по тому же соединению
+        dispatchRequests(conn);
+
+        // Если буфер все еще полон, readFromClient снова поставит чтение на паузу
+        if (conn.readPaused) {
+            conn.readPaused = false;
+            if (!readFromClient(conn)) {
+                closeConnection(completed.socket);
+                continue;
+            }
+            dispatchRequests(conn);
+        }
+
+        bool drained = conn.outOffset >= conn.outBuffer.size();
+        if (drained && !conn.requestInFlight && (conn.closeAfterWrite || conn.peerClosed)) {
+            closeConnection(completed.socket);
+        }
+    }
+}
+
+void ApiService::recordClientStrike(uint32_t address, const std::string& clientIP, int statusCode) {
+    if (statusCode != 400 && statusCode != 429) {
+        return;
+    }
+    if (ipFilter.recordStrike(address)) {
+        // Параметры бана не логируем: их может менять перезагрузка конфигурации в cleanupThread
+        Logger::getInstance().log("⛔ IP " + clientIP + " временно заблокирован: слишком много ответов 400/429", "WARNING");
+    }
+}
+
+void ApiService::closeConnection(SOCKET_TYPE clientSocket) {
+    auto it = connections.find(clientSocket);
+    if (it != connections.end() && it->second.tlsEstablished) {
+        // close_notify без ожидания ответа клиента; сокет неблокирующий
+        SSL_shutdown(it->second.tls.get());
+        ERR_clear_error();
+    }
+    eventLoop.remove(clientSocket);
+    CLOSE_SOCKET(clientSocket);
+    connections.erase(clientSocket);
+}
+
+void ApiService::closeIdleConnections() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<SOCKET_TYPE> expired;
+
+    for (const auto& entry : connections) {
+        const ClientConnection& conn = entry.second;
+        // Медленный ответ сервера не повод рвать соединение
+        if (conn.requestInFlight) continue;
+
+        // Между запросами keep-alive соединение живет keepAliveTimeoutSeconds,
+        // недочитанный запрос ждем дольше
+        bool idleKeepAlive = conn.requestsServed > 0 && conn.inBuffer.empty() &&
+                             conn.outOffset >= conn.outBuffer.size();
+        int timeout = idleKeepAlive ? apiConfig.keepAliveTimeoutSeconds : CLIENT_READ_TIMEOUT_SECONDS;
+
+        auto idle = std::chrono::duration_cast<std::chrono::seconds>(now - conn.lastActivity);
+        if (idle.count() >= timeout) {
+            expired.push_back(entry.first);
+        }
+    }
+
+    for (SOCKET_TYPE socket : expired) {
+        ClientConnection& conn = connections[socket];
+        if (conn.requestsServed == 0 || !conn.inBuffer.empty()) {
+            Logger::getInstance().log("⏰ Таймаут чтения от клиента: " + conn.clientIP, "WARNING");
+        }
+        closeConnection(socket);
+    }
+}
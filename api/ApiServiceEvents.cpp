@@ -1,7 +1,14 @@
 #include "api/ApiService.h"
+#include "database/StatementRegistry.h"
 #include "json.hpp"
 #include <iostream>
 
+namespace {
+
+const PreparedStatement PORTFOLIO_EXISTS("portfolio_exists", "SELECT 1 FROM student_portfolio WHERE measure_code = $1");
+
+}
+
 using json = nlohmann::json;
 
 std::string ApiService::handleAddPortfolio(const std::string& body) {
@@ -180,16 +187,14 @@ std::string ApiService::handleAddEvent(const std::string& body) {
 }
 
 bool DatabaseService::portfolioExists(int measureCode) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "SELECT 1 FROM student_portfolio WHERE measure_code = $1";
     const char* params[1] = { std::to_string(measureCode).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = PORTFOLIO_EXISTS.execute(connection, 1, params);
     bool exists = (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0);
     
     PQclear(res);
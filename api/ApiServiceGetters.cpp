@@ -1,21 +1,11 @@
 #include "api/ApiService.h"
 #include "json.hpp"
-#include <mutex>
 #include <iostream>
 
 using json = nlohmann::json;
 
-static std::mutex dbMutex;
-
-std::string ApiService::getProfile(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
-    }
-    
-    std::string userId = getUserIdFromSession(sessionToken);
+std::string ApiService::getProfile(const Principal& principal) {
+    const std::string& userId = principal.userId;
     if (userId.empty()) {
         json errorResponse;
         errorResponse["success"] = false;
@@ -23,7 +13,6 @@ std::string ApiService::getProfile(const std::string& sessionToken) {
         return createJsonResponse(errorResponse.dump(), 401);
     }
     
-    std::lock_guard<std::mutex> lock(dbMutex);
     User user = dbService.getUserById(std::stoi(userId));
     if (user.userId == 0) {
         json errorResponse;
@@ -32,32 +21,6 @@ std::string ApiService::getProfile(const std::string& sessionToken) {
         return createJsonResponse(errorResponse.dump(), 404);
     }
     
-    auto userSessions = dbService.getSessionsByUserId(userId);
-    json sessionsArray = json::array();
-    auto now = std::chrono::system_clock::now();
-    
-    for (const auto& session : userSessions) {
-        if (now > session.expiresAt) continue;
-        
-        auto age = std::chrono::duration_cast<std::chrono::hours>(now - session.createdAt);
-        auto inactive = std::chrono::duration_cast<std::chrono::minutes>(now - session.lastActivity);
-        
-        json sessionJson;
-        sessionJson["token"] = session.token;
-        sessionJson["email"] = session.email;
-        sessionJson["userOS"] = session.userOS;
-        sessionJson["ipAddress"] = session.ipAddress;
-        sessionJson["createdAt"] = std::chrono::duration_cast<std::chrono::seconds>(
-            session.createdAt.time_since_epoch()).count();
-        sessionJson["lastActivity"] = std::chrono::duration_cast<std::chrono::seconds>(
-            session.lastActivity.time_since_epoch()).count();
-        sessionJson["ageHours"] = age.count();
-        sessionJson["inactiveMinutes"] = inactive.count();
-        sessionJson["isCurrent"] = (session.token == sessionToken);
-        
-        sessionsArray.push_back(sessionJson);
-    }
-    
     json userJson;
     userJson["userId"] = user.userId;
     userJson["login"] = user.login;
@@ -66,7 +29,7 @@ std::string ApiService::getProfile(const std::string& sessionToken) {
     userJson["lastName"] = user.lastName;
     userJson["middleName"] = user.middleName;
     userJson["phoneNumber"] = user.phoneNumber;
-    userJson["sessions"] = sessionsArray;
+    userJson["sessions"] = buildSessionListJson(userId, principal.session.token);
     
     json response;
     response["success"] = true;
@@ -75,15 +38,7 @@ std::string ApiService::getProfile(const std::string& sessionToken) {
     return createJsonResponse(response.dump());
 }
 
-std::string ApiService::getTeachersJson(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
-    }
-
-    std::lock_guard<std::mutex> lock(dbMutex);
+std::string ApiService::getTeachersJson() {
     auto teachers = dbService.getTeachers();
     json teachersArray = json::array();
     
@@ -126,15 +81,7 @@ std::string ApiService::getTeachersJson(const std::string& sessionToken) {
     return createJsonResponse(response.dump());
 }
 
-std::string ApiService::getStudentsJson(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
-    }
-    
-    std::lock_guard<std::mutex> lock(dbMutex);
+std::string ApiService::getStudentsJson() {
     auto students = dbService.getStudents();
     json j = json::array();
     
@@ -159,15 +106,7 @@ std::string ApiService::getStudentsJson(const std::string& sessionToken) {
     return createJsonResponse(response.dump());
 }
 
-std::string ApiService::getGroupsJson(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
-    }
-    
-    std::lock_guard<std::mutex> lock(dbMutex);
+std::string ApiService::getGroupsJson() {
     auto groups = dbService.getGroups();
     json j = json::array();
     
@@ -187,15 +126,7 @@ std::string ApiService::getGroupsJson(const std::string& sessionToken) {
     return createJsonResponse(response.dump());
 }
 
-std::string ApiService::getSpecializationsJson(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
-    }
-
-    std::lock_guard<std::mutex> lock(dbMutex);
+std::string ApiService::getSpecializationsJson() {
     auto uniqueNames = dbService.getUniqueSpecializationNames();
 
     json data = json::array();
@@ -213,7 +144,6 @@ std::string ApiService::getSpecializationsJson(const std::string& sessionToken)
 }
 
 std::string ApiService::getTeacherSpecializationsJson(int teacherId) {
-    std::lock_guard<std::mutex> lock(dbMutex);
     auto specializations = dbService.getTeacherSpecializations(teacherId);
     json j = json::array();
     
@@ -247,11 +177,7 @@ std::string ApiService::getEventCategoriesJson() {
     return createJsonResponse(response.dump());
 }
 
-std::string ApiService::getPortfolioJson(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        return createJsonResponse("{\"success\": false, \"error\": \"Unauthorized\"}", 401);
-    }
-    
+std::string ApiService::getPortfolioJson() {
     auto portfolios = dbService.getPortfolios();
     json response;
     response["success"] = true;
@@ -271,27 +197,46 @@ std::string ApiService::getPortfolioJson(const std::string& sessionToken) {
     return createJsonResponse(response.dump());
 }
 
-std::string ApiService::handleGetDashboard(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        return createJsonResponse("{\"success\": false, \"error\": \"Unauthorized\"}", 401);
-    }
-    
+std::string ApiService::handleGetDashboard(const Principal& principal) {
     try {
-        std::string userId = getUserIdFromSession(sessionToken);
-        User user = dbService.getUserById(std::stoi(userId));
+        User user = dbService.getUserById(std::stoi(principal.userId));
         
         if (user.userId == 0) {
             return createJsonResponse("{\"success\": false, \"error\": \"User not found\"}", 404);
         }
         
-        std::lock_guard<std::mutex> lock(dbMutex);
-        
-        int teachersCount = dbService.getTeachersCount();
-        int studentsCount = dbService.getStudentsCount();
-        int groupsCount = dbService.getGroupsCount();
-        int portfoliosCount = dbService.getPortfoliosCount();
-        int eventsCount = dbService.getEventsCount();
+        return createDashboardResponse(user, dbService.getDashboardCounts());
         
+    } catch (const std::exception& e) {
+        return createJsonResponse("{\"success\": false, \"error\": \"Dashboard data error\"}", 500);
+    }
+}
+
+void ApiService::handleGetDashboardAsync(const Principal& principal, Router::Responder respond) {
+    User user;
+    try {
+        user = dbService.getUserById(std::stoi(principal.userId));
+    } catch (const std::exception& e) {
+        respond(createJsonResponse("{\"success\": false, \"error\": \"Dashboard data error\"}", 500));
+        return;
+    }
+    if (user.userId == 0) {
+        respond(createJsonResponse("{\"success\": false, \"error\": \"User not found\"}", 404));
+        return;
+    }
+    
+    // Пять счетчиков уходят в конвейер асинхронного соединения; ответ собирается в потоке
+    // событий по приходу последнего. Без асинхронных соединений - обычный пакет
+    bool started = dbService.getDashboardCountsAsync([this, user, respond](const DashboardCounts& counts) {
+        respond(createDashboardResponse(user, counts));
+    });
+    if (!started) {
+        respond(createDashboardResponse(user, dbService.getDashboardCounts()));
+    }
+}
+
+std::string ApiService::createDashboardResponse(const User& user, const DashboardCounts& counts) {
+    try {
         json dashboardData;
         dashboardData["user"] = {
             {"login", user.login},
@@ -301,11 +246,11 @@ std::string ApiService::handleGetDashboard(const std::string& sessionToken) {
         };
         
         dashboardData["stats"] = {
-            {"teachers", teachersCount},
-            {"students", studentsCount},
-            {"groups", groupsCount},
-            {"portfolios", portfoliosCount},
-            {"events", eventsCount}
+            {"teachers", counts.teachers},
+            {"students", counts.students},
+            {"groups", counts.groups},
+            {"portfolios", counts.portfolios},
+            {"events", counts.events}
         };
         
         dashboardData["timestamp"] = std::chrono::duration_cast<std::chrono::seconds>(
@@ -323,7 +268,6 @@ std::string ApiService::handleGetDashboard(const std::string& sessionToken) {
 }
 
 std::string ApiService::handleGetStudentsByGroup(int groupId) {
-    std::lock_guard<std::mutex> lock(dbMutex);
     auto students = dbService.getStudentsByGroup(groupId);
     json j = json::array();
 
@@ -81,11 +81,7 @@ std::string ApiService::handleDeleteGroup(int groupId) {
     }
 }
 
-std::string ApiService::getEventsJson(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        return createJsonResponse("{\"success\": false, \"error\": \"Unauthorized\"}", 401);
-    }
-    
+std::string ApiService::getEventsJson() {
     auto events = dbService.getEvents();
     json response;
     response["success"] = true;
@@ -2,7 +2,6 @@
 #include "json.hpp"
 #include "logger/logger.h"
 #include <sstream>
-#include <regex>
 #include <iostream>
 #include <iomanip>
 #include <openssl/rand.h>
@@ -11,6 +10,7 @@
 #include <random>
 #include <atomic>
 #include <cctype>
+#include <csignal>
 
 #ifndef _WIN32
 #include <fcntl.h>
@@ -31,50 +31,28 @@
 
 using json = nlohmann::json;
 
-// Глобальный объект для ограничения запросов
-class RateLimiter {
-private:
-    std::unordered_map<std::string, std::vector<std::chrono::steady_clock::time_point>> requests;
-    std::mutex mutex;
-    
-public:
-    bool isAllowed(const std::string& ip, size_t maxRequests = 100, std::chrono::seconds window = std::chrono::seconds(60)) {
-        std::lock_guard<std::mutex> lock(mutex);
-        auto now = std::chrono::steady_clock::now();
-        
-        // Удаляем старые запросы
-        auto& timestamps = requests[ip];
-        timestamps.erase(
-            std::remove_if(timestamps.begin(), timestamps.end(),
-                [now, window](const auto& timestamp) {
-                    return now - timestamp > window;
-                }),
-            timestamps.end()
-        );
-        
-        // Проверяем лимит
-        if (timestamps.size() >= maxRequests) {
-            return false;
-        }
-        
-        timestamps.push_back(now);
-        return true;
-    }
-};
-
-static RateLimiter rateLimiter;
-
 ApiService::ApiService(DatabaseService& dbService)
     : dbService(dbService),
+      sessionCacheComplete(false),
       running(false),
-      serverSocket(INVALID_SOCKET_VAL) {
+      serverSocket(INVALID_SOCKET_VAL),
+      nextConnectionId(1) {
     Logger::getInstance().log("🔧 Initializing ApiService...");
+    registerMiddleware();
+    registerRoutes();
     initializeNetwork();
-    loadSessionsFromDB();
+    // Путь к снимку сессий нужен до start(), поэтому конфигурация читается уже здесь
+    if (!configManager.loadApiConfig(apiConfig)) {
+        apiConfig = configManager.getDefaultApiConfig();
+    }
+    loadSessions();
 }
 
 ApiService::~ApiService() {
     stop();
+    if (reconcileThread.joinable()) {
+        reconcileThread.join();
+    }
     cleanupNetwork();
 }
 
@@ -95,24 +73,6 @@ void ApiService::cleanupNetwork() {
 }
 
 
-#include <string>
-std::string urlDecode(const std::string& encoded) {
-    std::string decoded;
-    for (size_t i = 0; i < encoded.length(); ++i) {
-        if (encoded[i] == '%' && i + 2 < encoded.length()) {
-            unsigned int hexValue; 
-            sscanf(encoded.substr(i + 1, 2).c_str(), "%x", &hexValue);
-            decoded += static_cast<char>(hexValue);
-            i += 2;
-        } else if (encoded[i] == '+') {
-            decoded += ' ';
-        } else {
-            decoded += encoded[i];
-        }
-    }
-    return decoded;
-}
-
 bool ApiService::start() {
     if (running) return true;
     
@@ -120,6 +80,42 @@ bool ApiService::start() {
         Logger::getInstance().log("❌ Не удалось загрузить конфигурацию API", "ERROR");
         return false;
     }
+    sessionActivity.configure(std::chrono::seconds(apiConfig.sessionFlushIntervalSeconds),
+                              std::chrono::seconds(apiConfig.sessionMaxExpiryDriftSeconds));
+    rateLimiter.configure(static_cast<size_t>(std::max(apiConfig.rateLimitMaxKeys, 1)));
+    // Стоимости маршрутов берутся из конфигурации; дальше таблица маршрутов только читается
+    applyRouteCosts();
+    applyIpFilterConfig(apiConfig, true);
+    if (apiConfig.enableSSL) {
+        std::string error;
+        if (!tlsContext.load(apiConfig.sslCertPath, apiConfig.sslKeyPath, apiConfig.sslSessionCacheSize,
+                             apiConfig.sslSessionTimeoutSeconds, error)) {
+            Logger::getInstance().log("❌ Не удалось загрузить сертификат TLS: " + error, "ERROR");
+            return false;
+        }
+#ifndef _WIN32
+        // OpenSSL пишет в сокет через write(), а не send(MSG_NOSIGNAL): закрытый клиентом сокет
+        // иначе завершил бы процесс сигналом
+        signal(SIGPIPE, SIG_IGN);
+#endif
+        Logger::getInstance().log("🔒 TLS включен: HTTPS и HTTP принимаются на одном порту");
+    }
+    if (apiConfig.rateLimitMode == "cluster") {
+        Logger::getInstance().log("🌐 Лимиты запросов сводятся между экземплярами через БД каждые " +
+                                  std::to_string(apiConfig.rateLimitSyncIntervalSeconds) + " сек");
+    }
+    
+    if (apiConfig.sessionTokenFormat == "signed") {
+        std::string signingKey = apiConfig.sessionSigningKey;
+        if (signingKey.empty()) {
+            // Без общего ключа токены не примут другие экземпляры и этот же сервер после перезапуска
+            Logger::getInstance().log("⚠️ sessionSigningKey не задан - используется случайный ключ", "WARNING");
+            signingKey = SessionTokenSigner::generateKey();
+        }
+        tokenSigner.setKey(signingKey);
+        refreshRevokedTokens();
+        Logger::getInstance().log("🔏 Включены подписанные токены сессий");
+    }
 
     // Создаем сокет
     serverSocket = socket(AF_INET, SOCK_STREAM, 0);
@@ -207,7 +203,34 @@ bool ApiService::start() {
         return false;
     }
     
+    // Поднимаем реактор и регистрируем в нем слушающий сокет
+    if (!eventLoop.open() || !eventLoop.add(serverSocket, EventLoop::EVENT_READ)) {
+        Logger::getInstance().log("❌ Не удалось инициализировать цикл событий", "ERROR");
+        eventLoop.close();
+        CLOSE_SOCKET(serverSocket);
+        serverSocket = INVALID_SOCKET_VAL;
+        return false;
+    }
+
+    // Сокеты асинхронных соединений БД опрашивает тот же реактор. Ответ БД может прийти
+    // порциями, а libpq не читает сокет до EAGAIN, поэтому они в level-triggered режиме
+    AsyncDatabase::Reactor reactor;
+    reactor.add = [this](int socket) {
+        eventLoop.add(static_cast<SOCKET_TYPE>(socket), EventLoop::EVENT_READ | EventLoop::EVENT_LEVEL);
+    };
+    reactor.setWritable = [this](int socket, bool writable) {
+        eventLoop.modify(static_cast<SOCKET_TYPE>(socket), EventLoop::EVENT_READ | EventLoop::EVENT_LEVEL |
+                                                           (writable ? EventLoop::EVENT_WRITE : 0));
+    };
+    reactor.remove = [this](int socket) { eventLoop.remove(static_cast<SOCKET_TYPE>(socket)); };
+    reactor.notify = [this]() { eventLoop.wakeup(); };
+    if (dbService.openAsync(std::move(reactor))) {
+        Logger::getInstance().log("🗄️ Асинхронные запросы к БД: " +
+                                  std::to_string(dbService.getAsyncStats().connected) + " соединений");
+    }
+    
     running = true;
+    workerPool.start(apiConfig.workerThreads > 0 ? static_cast<size_t>(apiConfig.workerThreads) : 0);
     serverThread = std::thread(&ApiService::runServer, this);
     cleanupThread = std::thread(&ApiService::runCleanup, this);
     
@@ -221,285 +244,249 @@ void ApiService::stop() {
     Logger::getInstance().log("🛑 Останавливаем API сервер...");
     running = false;
     
-    // Закрываем серверный сокет чтобы прервать accept
-    if (serverSocket != INVALID_SOCKET_VAL) {
-        // Создаем временное соединение чтобы разблокировать accept
-        SOCKET_TYPE tempSocket = socket(AF_INET, SOCK_STREAM, 0);
-        if (tempSocket != INVALID_SOCKET_VAL) {
-            sockaddr_in serverAddr;
-            memset(&serverAddr, 0, sizeof(serverAddr));
-            serverAddr.sin_family = AF_INET;
-            serverAddr.sin_addr.s_addr = inet_addr("127.0.0.1");
-            serverAddr.sin_port = htons(apiConfig.port);
-            
-            // Пытаемся подключиться чтобы разблокировать accept
-            connect(tempSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr));
-            
-            // Даем время на обработку
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            
-            CLOSE_SOCKET(tempSocket);
-        }
-        
-        // Теперь закрываем серверный сокет
-        CLOSE_SOCKET(serverSocket);
-        serverSocket = INVALID_SOCKET_VAL;
-    }
-    
+    // Будим поток событий, чтобы он увидел running == false
+    eventLoop.wakeup();
+
     // Ждем завершения потоков
     if (serverThread.joinable()) {
         serverThread.join();
     }
     
+    // Дожидаемся запросов, которые уже выполняются в пуле
+    workerPool.stop();
+    completedResponses.clear();
+    
+    if (serverSocket != INVALID_SOCKET_VAL) {
+        CLOSE_SOCKET(serverSocket);
+        serverSocket = INVALID_SOCKET_VAL;
+    }
+    eventLoop.close();
+    
     if (cleanupThread.joinable()) {
         cleanupThread.join();
     }
     
+    // Записываем продления сессий, накопленные с последнего сброса
+    flushSessionActivity();
+    saveSessionSnapshot();
+    
     Logger::getInstance().log("🔴 API сервер остановлен");
 }
 
 void ApiService::runServer() {
-    
+    AsyncDatabase& asyncDatabase = dbService.getAsyncDatabase();
     while (running) {
-        sockaddr_in clientAddr;
-        socklen_t addrLen = sizeof(clientAddr);
-        
-        // Используем select для неблокирующего accept с таймаутом
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(serverSocket, &readfds);
-        
-        struct timeval timeout;
-        timeout.tv_sec = 1;  // Таймаут 1 секунда
-        timeout.tv_usec = 0;
-        
-        int activity = select(serverSocket + 1, &readfds, nullptr, nullptr, &timeout);
-        
-        if (activity < 0) {
-#ifdef _WIN32
-            int err = WSAGetLastError();
-            if (err != WSAEINTR) {
-                Logger::getInstance().log("❌ Ошибка select: " + std::to_string(err), "ERROR");
-            }
-#else
-            if (errno != EINTR) {
-                Logger::getInstance().log("❌ Ошибка select: " + std::string(strerror(errno)), "ERROR");
+        int result = eventLoop.poll(1000, [this, &asyncDatabase](SOCKET_TYPE socket, uint32_t events) {
+            if (socket == serverSocket) {
+                acceptConnections();
+            } else if (asyncDatabase.owns(static_cast<int>(socket))) {
+                // Ответы БД: обработчики запросов выполняются здесь же, в потоке событий
+                asyncDatabase.handleEvent(static_cast<int>(socket),
+                                          (events & (EventLoop::EVENT_READ | EventLoop::EVENT_ERROR)) != 0,
+                                          (events & EventLoop::EVENT_WRITE) != 0);
+            } else {
+                handleClientEvent(socket, events);
             }
-#endif
-            continue;
+        });
+
+        if (result < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
-        
+
+        // Запросы, поставленные рабочими потоками с прошлого опроса, уходят в БД
+        asyncDatabase.process();
+        deliverCompletedResponses();
+
         // Проверяем, был ли остановлен сервер во время ожидания
         if (!running) break;
-        
-        if (activity == 0) {
-            // Таймаут - продолжаем цикл
-            continue;
-        }
-        
-        if (FD_ISSET(serverSocket, &readfds)) {
-            SOCKET_TYPE clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &addrLen);
-            
-            if (clientSocket == INVALID_SOCKET_VAL) {
-#ifdef _WIN32
-                int err = WSAGetLastError();
-                if (err == WSAEWOULDBLOCK) {
-                    continue;
-                }
-                if (err != WSAEINTR) {
-                    Logger::getInstance().log("❌ Ошибка accept: " + std::to_string(err), "ERROR");
-                }
-#else
-                if (errno == EWOULDBLOCK || errno == EAGAIN) {
-                    continue;
-                }
-                if (errno != EINTR) {
-                    Logger::getInstance().log("❌ Ошибка accept: " + std::string(strerror(errno)), "ERROR");
-                }
-#endif
-                continue;
-            }
-            
-            // Настраиваем клиентский сокет
-#ifdef _WIN32
-            u_long mode = 1;
-            ioctlsocket(clientSocket, FIONBIO, &mode);
-#else
-            int flags = fcntl(clientSocket, F_GETFL, 0);
-            fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
-#endif
-            
-            handleClient(clientSocket);
-        }
+
+        closeIdleConnections();
     }
-    
-}
 
+    // Ожидающие ответа БД запросы завершаются ошибкой; новые рабочие потоки выполнят сами
+    asyncDatabase.close();
 
-std::string ApiService::getClientInfo(SOCKET_TYPE clientSocket) {
-#ifdef _WIN32
-    sockaddr_in clientAddr;
-    int addrLen = sizeof(clientAddr);
-    if (getpeername(clientSocket, (sockaddr*)&clientAddr, &addrLen) == 0) {
-        char ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, ip, INET_ADDRSTRLEN);
-        return std::string(ip);
-    } else {
-        int error = WSAGetLastError();
-        Logger::getInstance().log("❌ Ошибка получения IP клиента: " + std::to_string(error), "ERROR");
-        return "unknown";
+    // Закрываем все оставшиеся клиентские соединения
+    for (auto& entry : connections) {
+        eventLoop.remove(entry.first);
+        CLOSE_SOCKET(entry.first);
     }
-#else
-    sockaddr_in clientAddr;
-    socklen_t addrLen = sizeof(clientAddr);
-    if (getpeername(clientSocket, (sockaddr*)&clientAddr, &addrLen) == 0) {
-        char ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, ip, INET_ADDRSTRLEN);
-        return std::string(ip);
-    } else {
-        Logger::getInstance().log("❌ Ошибка получения IP клиента: " + std::string(strerror(errno)), "ERROR");
-        return "unknown";
-    }
-#endif
+    connections.clear();
 }
 
-void ApiService::handleClient(SOCKET_TYPE clientSocket) {
-    std::string clientIP = getClientInfo(clientSocket);
-    Logger::getInstance().log("🔗 Поступил запрос от IP: " + clientIP);
+void ApiService::syncRateLimits() {
+    auto usage = rateLimiter.takeUsage();
+    if (usage.empty()) {
+        return;
+    }
     
-    std::string rawRequest;
-    char buffer[8192];
-    int bytesReceived;
-    auto startTime = std::chrono::steady_clock::now();
+    std::vector<RateLimitUsage> shared;
+    if (!dbService.syncRateLimits(usage, shared)) {
+        // Потребление этого интервала теряется для других экземпляров, но не для этого:
+        // локальные TAT его уже учитывают
+        Logger::getInstance().log("⚠️ Не удалось синхронизировать лимиты запросов (" +
+                                  std::to_string(usage.size()) + " ключей)", "WARNING");
+        return;
+    }
+    rateLimiter.mergeShared(shared);
+}
 
-    // Увеличиваем таймаут и улучшаем чтение
-    while (true) {
-        memset(buffer, 0, sizeof(buffer));  // Очищаем буфер
-        bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytesReceived > 0) {
-            rawRequest.append(buffer, bytesReceived);
-            
-            // Проверяем конец заголовков
-            if (rawRequest.find("\r\n\r\n") != std::string::npos) {
-                // Если есть Content-Length, читаем тело
-                size_t headersEnd = rawRequest.find("\r\n\r\n");
-                std::string headers = rawRequest.substr(0, headersEnd);
-                
-                // Ищем Content-Length
-                size_t clPos = headers.find("Content-Length:");
-                if (clPos != std::string::npos) {
-                    size_t clEnd = headers.find("\r\n", clPos);
-                    std::string clStr = headers.substr(clPos + 15, clEnd - clPos - 15);
-                    try {
-                        size_t contentLength = std::stoul(clStr);
-                        size_t bodyStart = headersEnd + 4;
-                        if (rawRequest.length() - bodyStart >= contentLength) {
-                            break;  // Все данные получены
-                        }
-                    } catch (...) {
-                        // Если не удалось распарсить Content-Length, считаем что заголовки закончились
-                        break;
-                    }
-                } else {
-                    // Нет тела - запрос завершен
-                    break;
-                }
-            }
-        } else if (bytesReceived == 0) {
-            Logger::getInstance().log("🔌 Клиент отключился: " + clientIP);
-            break;
-        } else {
-#ifdef _WIN32
-            if (WSAGetLastError() == WSAEWOULDBLOCK) {
-#else
-            if (errno == EWOULDBLOCK || errno == EAGAIN) {
-#endif
-                auto now = std::chrono::steady_clock::now();
-                if (std::chrono::duration_cast<std::chrono::seconds>(now - startTime).count() > 30) {
-                    Logger::getInstance().log("⏰ Таймаут чтения от клиента: " + clientIP, "WARNING");
-                    break;
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                continue;
-            }
-            Logger::getInstance().log("❌ Ошибка чтения от клиента " + clientIP, "ERROR");
-            break;
-        }
+void ApiService::applyIpFilterConfig(const ApiConfig& config, bool log) {
+    std::vector<std::string> invalid;
+    ipFilter.load(config.ipBlocklist, config.ipAllowlist, invalid);
+    ipFilter.configureBans(config.ipAutoBanThreshold,
+                           std::chrono::seconds(std::max(config.ipAutoBanWindowSeconds, 1)),
+                           std::chrono::seconds(std::max(config.ipAutoBanDurationSeconds, 0)));
+    for (const auto& entry : invalid) {
+        Logger::getInstance().log("⚠️ Фильтр IP: некорректная запись \"" + entry + "\" пропущена", "WARNING");
     }
+    if (log && ipFilter.ruleCount() > 0) {
+        Logger::getInstance().log("🛡️ Фильтр IP: " + std::to_string(ipFilter.ruleCount()) + " правил CIDR");
+    }
+}
 
-    if (rawRequest.empty()) {
-        Logger::getInstance().log("📭 Пустой запрос от клиента: " + clientIP, "WARNING");
-        CLOSE_SOCKET(clientSocket);
+void ApiService::reloadIpFilterConfig() {
+    ApiConfig fresh;
+    if (!configManager.loadApiConfig(fresh)) {
+        return;
+    }
+    if (fresh.ipBlocklist == apiConfig.ipBlocklist && fresh.ipAllowlist == apiConfig.ipAllowlist &&
+        fresh.ipAutoBanThreshold == apiConfig.ipAutoBanThreshold &&
+        fresh.ipAutoBanWindowSeconds == apiConfig.ipAutoBanWindowSeconds &&
+        fresh.ipAutoBanDurationSeconds == apiConfig.ipAutoBanDurationSeconds) {
         return;
     }
 
-    // Обрабатываем запрос
-    std::string response = processRequestFromRaw(rawRequest, clientIP);
-    
-    // Отправляем ответ
-    int totalSent = 0;
-    const char* responseData = response.c_str();
-    size_t responseLength = response.length();
-    
-    while (totalSent < static_cast<int>(responseLength)) {
-        int bytesSent = send(clientSocket, responseData + totalSent, responseLength - totalSent, 0);
-        if (bytesSent <= 0) {
-            Logger::getInstance().log("❌ Ошибка отправки ответа клиенту " + clientIP, "ERROR");
-            break;
+    // Остальные поля apiConfig читают рабочие потоки, поэтому меняем только настройки фильтра
+    apiConfig.ipBlocklist = fresh.ipBlocklist;
+    apiConfig.ipAllowlist = fresh.ipAllowlist;
+    apiConfig.ipAutoBanThreshold = fresh.ipAutoBanThreshold;
+    apiConfig.ipAutoBanWindowSeconds = fresh.ipAutoBanWindowSeconds;
+    apiConfig.ipAutoBanDurationSeconds = fresh.ipAutoBanDurationSeconds;
+    applyIpFilterConfig(apiConfig, false);
+    Logger::getInstance().log("🛡️ Фильтр IP перезагружен: " + std::to_string(ipFilter.ruleCount()) + " правил CIDR");
+}
+
+void ApiService::logDatabasePoolStats() {
+    ConnectionPool::Stats stats = dbService.getPoolStats();
+    uint64_t averageWait = stats.checkouts > 0 ? stats.totalWaitMicros / stats.checkouts : 0;
+    Logger::getInstance().log("🗄️ Пул БД: открыто " + std::to_string(stats.open) + "/" + std::to_string(stats.maxSize) +
+                              ", свободно " + std::to_string(stats.idle) +
+                              ", выдач " + std::to_string(stats.checkouts) +
+                              ", с ожиданием " + std::to_string(stats.waits) +
+                              ", ожидание среднее/макс " + std::to_string(averageWait) + "/" +
+                              std::to_string(stats.maxWaitMicros) + " мкс" +
+                              ", таймаутов " + std::to_string(stats.timeouts) +
+                              ", ошибок подключения " + std::to_string(stats.connectFailures));
+
+    // Счетчики накапливаются с запуска; показываем самые частые запросы
+    const size_t topStatements = 5;
+    std::vector<StatementRegistry::StatementStats> statements = dbService.getStatementStats();
+    uint64_t totalCalls = 0;
+    std::string top;
+    for (size_t i = 0; i < statements.size(); i++) {
+        totalCalls += statements[i].calls;
+        if (i < topStatements && statements[i].calls > 0) {
+            top += (top.empty() ? "" : ", ") + statements[i].name + " " + std::to_string(statements[i].calls);
         }
-        totalSent += bytesSent;
     }
-    
-    CLOSE_SOCKET(clientSocket);
+    Logger::getInstance().log("🗄️ Подготовленные запросы: " + std::to_string(statements.size()) +
+                              ", вызовов " + std::to_string(totalCalls) +
+                              (top.empty() ? "" : ", чаще всего: " + top));
+
+    AsyncDatabase::Stats async = dbService.getAsyncStats();
+    if (async.connections > 0) {
+        Logger::getInstance().log("🗄️ Асинхронные запросы: соединений " + std::to_string(async.connected) + "/" +
+                                  std::to_string(async.connections) +
+                                  ", в работе " + std::to_string(async.inFlight) +
+                                  ", выполнено " + std::to_string(async.completed) +
+                                  ", с ошибкой " + std::to_string(async.failed));
+    }
 }
 
 void ApiService::runCleanup() {
+    // Задачи со своим интервалом планируются по сроку: счетчик цикла ниже обнуляется
+    // каждые 5 минут, и интервал больше 300 секунд (или не делящий 300) по нему не отсчитать
+    auto nextRateLimitSync = std::chrono::steady_clock::now() +
+                             std::chrono::seconds(apiConfig.rateLimitSyncIntervalSeconds);
+    auto nextSnapshot = std::chrono::steady_clock::now() +
+                        std::chrono::seconds(apiConfig.sessionSnapshotIntervalSeconds);
     while (running) {
-        cleanupExpiredSessions();
+        // Сессии, не попавшие в кэш (например, созданные другим экземпляром), чистит БД
         dbService.deleteExpiredSessions();
+        if (tokenSigner.enabled()) {
+            dbService.deleteExpiredRevokedTokens();
+        }
+        // Строки сессий, отозванных сменой поколения и так и не предъявленных, удаляются здесь
+        dbService.deleteStaleGenerationSessions();
+        if (apiConfig.rateLimitMode == "cluster") {
+            dbService.deleteIdleRateLimits();
+        }
+        logDatabasePoolStats();
         
-        // Используем прерываемый sleep
+        // Используем прерываемый sleep; раз в секунду снимаем истекшие сессии кэша
+        // (это стоит O(истекших)) и проверяем, не пора ли сбросить продления
         for (int i = 0; i < 300 && running; i++) { // 5 минут = 300 секунд
             std::this_thread::sleep_for(std::chrono::seconds(1));
+            cleanupExpiredSessions();
+            auto now = std::chrono::steady_clock::now();
+            if (apiConfig.rateLimitMode == "cluster" && apiConfig.rateLimitSyncIntervalSeconds > 0 &&
+                now >= nextRateLimitSync) {
+                syncRateLimits();
+                nextRateLimitSync = now + std::chrono::seconds(apiConfig.rateLimitSyncIntervalSeconds);
+            }
+            if (sessionActivity.flushDue(std::chrono::system_clock::now())) {
+                flushSessionActivity();
+            }
+            // Отзывы, сделанные на других экземплярах, подхватываем с задержкой до 10 секунд
+            if (i % 10 == 9) {
+                // Правка database_config.json применяется без перезапуска; без правки это один stat()
+                if (dbService.reloadConfigIfChanged()) {
+                    Logger::getInstance().log("🔄 Конфигурация БД перечитана");
+                }
+                reloadIpFilterConfig();
+                ipFilter.purgeExpired();
+                refreshSessionGenerations();
+                if (tokenSigner.enabled()) {
+                    refreshRevokedTokens();
+                }
+            }
+            if (apiConfig.sessionSnapshotIntervalSeconds > 0 && now >= nextSnapshot) {
+                saveSessionSnapshot();
+                nextSnapshot = std::chrono::steady_clock::now() +
+                               std::chrono::seconds(apiConfig.sessionSnapshotIntervalSeconds);
+            }
         }
     }
 }
 
-std::string ApiService::processRequestFromRaw(const std::string& rawRequest, const std::string& clientIP) {
-    // ПРОВЕРКА RATE LIMITING
-    if (!rateLimiter.isAllowed(clientIP, apiConfig.rateLimitRequests, 
-                               std::chrono::seconds(apiConfig.rateLimitWindow))) {
-        Logger::getInstance().log("🚫 Rate limit exceeded для " + clientIP + 
-                                 ": " + std::to_string(apiConfig.rateLimitRequests) + 
-                                 " запросов за " + std::to_string(apiConfig.rateLimitWindow) + " сек", "WARNING");
-        return createJsonResponse("{\"success\": false, \"error\": \"Too many requests, please try again later\"}", 429);
-    }
-    
+std::string ApiService::processHttpRequest(const HttpParser& request, const std::string& clientIP,
+                                           const Router::Responder& respond, bool* deferred) {
+    // Ограничение частоты - во взвешенном middleware после аутентификации (ApiServiceRoutes.cpp)
     // ПРОВЕРКА НА МИНИМАЛЬНО ВАЛИДНЫЙ HTTP ЗАПРОС
-    if (rawRequest.length() < 14) {
-        Logger::getInstance().log("❌ Слишком короткий запрос от " + clientIP + ": " + std::to_string(rawRequest.length()) + " байт", "WARNING");
+    if (request.messageLength() < 14) {
+        Logger::getInstance().log("❌ Слишком короткий запрос от " + clientIP + ": " + std::to_string(request.messageLength()) + " байт", "WARNING");
         return createJsonResponse("{\"success\": false, \"error\": \"Invalid HTTP request\"}", 400);
     }
     
     // ПРОВЕРКА НА БАЗОВЫЙ HTTP СИНТАКСИС
-    if (rawRequest.find("HTTP/") == std::string::npos) {
+    if (request.protocol().substr(0, 5) != "HTTP/") {
         Logger::getInstance().log("❌ Не HTTP запрос от " + clientIP, "WARNING");
         return createJsonResponse("{\"success\": false, \"error\": \"Invalid HTTP protocol\"}", 400);
     }
     
     try {
-        std::istringstream iss(rawRequest);
-        std::string method, path, protocol;
-        iss >> method >> path >> protocol;
+        std::string method(request.method());
+        std::string path(request.path());
+        std::string_view protocol = request.protocol();
         
         // Логируем куда идет запрос
         Logger::getInstance().log("📍 Запрос от " + clientIP + ": " + method + " " + path);
         
         // ВАЛИДАЦИЯ МЕТОДА
-        std::vector<std::string> allowedMethods = {"GET", "POST", "PUT", "DELETE", "OPTIONS"};
+        static const char* const allowedMethods[] = {"GET", "POST", "PUT", "DELETE", "OPTIONS"};
         bool validMethod = false;
-        for (const auto& m : allowedMethods) {
+        for (const char* m : allowedMethods) {
             if (method == m) {
                 validMethod = true;
                 break;
@@ -519,116 +506,53 @@ std::string ApiService::processRequestFromRaw(const std::string& rawRequest, con
         
         // ВАЛИДАЦИЯ ПРОТОКОЛА
         if (protocol != "HTTP/1.0" && protocol != "HTTP/1.1") {
-            Logger::getInstance().log("❌ Неподдерживаемый протокол от " + clientIP + ": " + protocol, "WARNING");
+            Logger::getInstance().log("❌ Неподдерживаемый протокол от " + clientIP + ": " + std::string(protocol), "WARNING");
             return createJsonResponse("{\"success\": false, \"error\": \"Unsupported HTTP version\"}", 505);
         }
         
-        // Извлекаем заголовки и тело
-        std::unordered_map<std::string, std::string> headers;
-        std::string line;
-        std::string body;
-        
-        // Пропускаем первую строку
-        std::getline(iss, line);
-        
-        // Читаем заголовки
+        // Заголовки и тело уже разобраны парсером соединения
         std::string userOS = "unknown";
-        while (std::getline(iss, line)) {
-            if (line.empty() || line == "\r") break;
-            
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
-            }
-            
-            // Пропускаем пустые строки
-            if (line.empty()) continue;
-            
-            size_t colonPos = line.find(": ");
-            if (colonPos != std::string::npos) {
-                std::string key = line.substr(0, colonPos);
-                std::string value = line.substr(colonPos + 2);
-                
-                // Валидация ключа заголовка
-                bool validHeader = true;
-                for (char c : key) {
-                    if (!std::isalnum(c) && c != '-') {
-                        validHeader = false;
-                        break;
-                    }
-                }
-                
-                if (validHeader) {
-                    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-                    headers[key] = value;
-                    
-                    // Сохраняем OS
-                    if (key == "user-os") {
-                        userOS = value;
-                    }
-                }
-            }
+        std::string_view userOSHeader = request.header("user-os");
+        if (!userOSHeader.empty()) {
+            userOS = std::string(userOSHeader);
         }
         
-        // Читаем тело для POST, PUT и DELETE запросов
+        // Тело передаем обработчикам только для POST, PUT и DELETE запросов
+        std::string body;
         if (method == "POST" || method == "PUT" || method == "DELETE") {
-            std::string contentLengthStr = headers["content-length"];
-            if (!contentLengthStr.empty()) {
-                try {
-                    size_t contentLength = std::stoul(contentLengthStr);
-                    
-                    if (contentLength > 10 * 1024 * 1024) {
-                        Logger::getInstance().log("❌ Слишком большое тело запроса от " + clientIP + ": " + std::to_string(contentLength) + " байт", "WARNING");
-                        return createJsonResponse("{\"success\": false, \"error\": \"Request body too large\"}", 413);
-                    }
-                    
-                    if (contentLength > 0) {
-                        body.resize(contentLength);
-                        iss.read(&body[0], contentLength);
-                        
-                        size_t bytesRead = iss.gcount();
-                        if (bytesRead != contentLength) {
-                            Logger::getInstance().log("❌ Несоответствие размера тела от " + clientIP 
-                                      + ": ожидалось " + std::to_string(contentLength) + ", получено " + std::to_string(bytesRead), "WARNING");
-                            return createJsonResponse("{\"success\": false, \"error\": \"Incomplete request body\"}", 400);
-                        }
-                    }
-                } catch (const std::exception& e) {
-                    Logger::getInstance().log("❌ Ошибка парсинга content-length от " + clientIP + ": " + std::string(e.what()), "WARNING");
-                    return createJsonResponse("{\"success\": false, \"error\": \"Invalid Content-Length\"}", 400);
-                }
-            } else {
-                // Для DELETE запросов с телом Content-Length обязателен
-                if (!body.empty()) {
-                    return createJsonResponse("{\"success\": false, \"error\": \"Content-Length header required\"}", 411);
-                }
-            }
+            body = std::string(request.body());
         }
         
         // Извлекаем токен с ВАЛИДАЦИЕЙ
         std::string sessionToken;
-        auto authIt = headers.find("authorization");
-        if (authIt != headers.end()) {
-            std::string authHeader = authIt->second;
-            
+        std::string_view authHeader = request.header("authorization");
+        if (!authHeader.empty()) {
             // ВАЛИДАЦИЯ ФОРМАТА AUTHORIZATION HEADER
-            if (authHeader.find("Bearer ") == 0) {
-                sessionToken = authHeader.substr(7);
-            } else {
-                sessionToken = authHeader;
+            if (authHeader.substr(0, 7) == "Bearer ") {
+                authHeader.remove_prefix(7);
             }
             
             // ВАЛИДАЦИЯ ДЛИНЫ ТОКЕНА
-            if (sessionToken.length() > 512) {
-                Logger::getInstance().log("❌ Слишком длинный токен от " + clientIP + ": " + std::to_string(sessionToken.length()) + " символов", "WARNING");
+            if (authHeader.length() > 512) {
+                Logger::getInstance().log("❌ Слишком длинный токен от " + clientIP + ": " + std::to_string(authHeader.length()) + " символов", "WARNING");
                 return createJsonResponse("{\"success\": false, \"error\": \"Invalid token format\"}", 400);
             }
+            sessionToken = std::string(authHeader);
         }
         
         // Формируем clientInfo для передачи в processRequest
         std::string clientInfo = "IP: " + clientIP + ", OS: " + userOS;
         
         // ОБРАБАТЫВАЕМ ЗАПРОС с передачей clientInfo
-        std::string response = processRequest(method, path, body, sessionToken, clientInfo);
+        bool asyncDispatched = false;
+        std::string response = processRequest(method, path, body, sessionToken, clientInfo, respond, &asyncDispatched);
+        if (asyncDispatched) {
+            // Ответ придет в respond
+            if (deferred) {
+                *deferred = true;
+            }
+            return std::string();
+        }
         
         // ПРОВЕРКА ЧТО PROCESSREQUEST ВЕРНУЛ ВАЛИДНЫЙ ОТВЕТ
         if (response.empty()) {
@@ -639,13 +563,14 @@ std::string ApiService::processRequestFromRaw(const std::string& rawRequest, con
         return response;
         
     } catch (const std::exception& e) {
-        Logger::getInstance().log("💥 EXCEPTION в processRequestFromRaw для клиента " + clientIP + ": " + std::string(e.what()), "ERROR");
+        Logger::getInstance().log("💥 EXCEPTION в processHttpRequest для клиента " + clientIP + ": " + std::string(e.what()), "ERROR");
         return createJsonResponse("{\"success\": false, \"error\": \"Internal server error\"}", 500);
     }
 }
 
 std::string ApiService::processRequest(const std::string& method, const std::string& path, 
-    const std::string& body, const std::string& sessionToken, const std::string& clientInfo) {
+    const std::string& body, const std::string& sessionToken, const std::string& clientInfo,
+    const Router::Responder& respond, bool* deferred) {
     
     // Извлекаем IP и User-OS из clientInfo
     std::string clientIP = "unknown";
@@ -710,264 +635,44 @@ std::string ApiService::processRequest(const std::string& method, const std::str
         }
     }
     
-    // ОБЪЯВЛЕНИЕ РЕГУЛЯРНЫХ ВЫРАЖЕНИЙ ДЛЯ МАРШРУТИЗАЦИИ
-    std::regex teacherRegex("^/teachers/(\\d+)$");
-    std::regex studentRegex("^/students/(\\d+)$");
-    std::regex groupRegex("^/groups/(\\d+)$");
-    std::regex specializationRegex("^/specializations/(\\d+)$");
-    std::regex teacherSpecializationsRegex("^/teachers/(\\d+)/specializations$");
-    std::regex teacherSpecializationRegex("^/teachers/(\\d+)/specializations/(\\d+)$");
-    std::regex sessionTokenRegex("^/sessions/([a-fA-F0-9]+)$");
-    std::regex eventRegex("^/events/(\\d+)$");
-    std::regex portfolioRegex("^/portfolio/(\\d+)$");
-    std::regex newsRegex("^/news/(\\d+)$");
-    std::regex eventCategoryRegex("^/event-categories/(\\d+)$");
-    std::regex groupStudentsRegex("^/groups/(\\d+)/students$");
-    std::smatch matches;
-    
     try {
+        // Таблица маршрутов построена в registerRoutes(), здесь только поиск по дереву
+        Router::Match match = router.match(method, path);
         
-        if (method == "GET" && path == "/news") {
-            return handleGetNewsList();
-        } else if (method == "GET" && path.find("/news/") == 0) {
-            std::string encodedFilename = path.substr(6);
-            std::string filename = urlDecode(encodedFilename);
-            return handleGetNews(filename);
-        }
-
-        // АУТЕНТИФИКАЦИЯ И РЕГИСТРАЦИЯ
-        else if (method == "POST" && path == "/register") {
-            return handleRegister(body, clientInfo);
-        } else if (method == "POST" && path == "/login") {
-            return handleLogin(body, clientInfo);
-        } else if (method == "POST" && path == "/logout") {
-            return handleLogout(sessionToken, clientInfo);
-        } else if ((method == "GET" || method == "POST") && path == "/verify-token") {
-            std::string tokenToValidate = sessionToken;
-            
-            // Если это POST запрос, пытаемся извлечь токен из тела
-            if (method == "POST" && !body.empty()) {
-                try {
-                    json j = json::parse(body);
-                    if (j.contains("token") && !j["token"].is_null()) {
-                        tokenToValidate = j["token"];
-                    }
-                } catch (const std::exception& e) {
-                    Logger::getInstance().log("⚠️ Не удалось распарсить тело verify-token запроса: " + std::string(e.what()), "WARNING");
-                }
-            } 
-            
-            if (tokenToValidate.empty()) {
-                json errorResponse;
-                errorResponse["success"] = false;
-                errorResponse["valid"] = false;
-                errorResponse["error"] = "Token is required";
-                return createJsonResponse(errorResponse.dump(), 400);
-            }
-            
-            // УНИВЕРСАЛЬНАЯ ПРОВЕРКА ТОКЕНА
-            bool isValid = validateTokenInDatabase(tokenToValidate);
-            
-            if (isValid) {
-                // Токен валиден, получаем информацию о пользователе
-                std::string userId = getUserIdFromSession(tokenToValidate);
-                User user = dbService.getUserById(std::stoi(userId));
-                
-                if (user.userId == 0) {
-                    json errorResponse;
-                    errorResponse["success"] = false;
-                    errorResponse["valid"] = false;
-                    errorResponse["error"] = "User not found";
-                    return createJsonResponse(errorResponse.dump(), 404);
-                }
-                
-                // ФОРМИРУЕМ УНИВЕРСАЛЬНЫЙ ОТВЕТ ДЛЯ КЛИЕНТА
-                json responseData;
-                responseData["valid"] = true;
-                responseData["userId"] = userId;
-                responseData["user"] = {
-                    {"userId", user.userId},
-                    {"login", user.login},
-                    {"email", user.email},
-                    {"firstName", user.firstName},
-                    {"lastName", user.lastName},
-                    {"middleName", user.middleName},
-                    {"phoneNumber", user.phoneNumber}
-                };
-                
-                json response;
-                response["success"] = true;
-                response["valid"] = true;
-                response["data"] = responseData;
-                response["message"] = "Token is valid";
-                
-                return createJsonResponse(response.dump());
-            } else {
-                json errorResponse;
-                errorResponse["success"] = false;
-                errorResponse["valid"] = false;
-                errorResponse["error"] = "Invalid or expired token";
-                return createJsonResponse(errorResponse.dump(), 401);
-            }
-        
-        } 
-        
-        // СТАТУС СЕРВЕРА
-        else if (method == "GET" && path == "/status") {
-            return handleStatus();
-        } 
-        
-        if (!validateSession(sessionToken)) {
-            json errorResponse;
-            errorResponse["success"] = false;
-            errorResponse["error"] = "Unauthorized";
-            return createJsonResponse(errorResponse.dump(), 401);
+        // OPTIONS отвечает списком методов пути без авторизации (CORS preflight)
+        if (method == "OPTIONS" && match.allowedMethods != 0) {
+            return createJsonResponse("{\"success\": true}", 200,
+                                      "Allow: " + Router::allowHeader(match.allowedMethods | Router::METHOD_OPTIONS) + "\r\n");
         }
-
-        else if (method == "GET" && path == "/dashboard") {
-            return handleGetDashboard(sessionToken);
-        } else if (method == "GET" && path == "/session-info") {
-            return getSessionInfo(sessionToken);
-        } else if (method == "GET" && path == "/profile") {
-            return getProfile(sessionToken);
-        } else if (method == "PUT" && path == "/profile") {
-            return handleUpdateProfile(body, sessionToken);
-        } else if (method == "POST" && path == "/change-password") {
-            return handleChangePassword(body, sessionToken);
-        } else if (method == "GET" && path == "/sessions") {
-            return handleGetSessions(sessionToken);
         
-        // НОВЫЙ МАРШРУТ ДЛЯ УДАЛЕНИЯ СЕССИИ ПО ТОКЕНУ В URL
-        } else if (method == "DELETE" && std::regex_match(path, matches, sessionTokenRegex)) {
-            std::string targetToken = matches[1];
-            return handleRevokeSessionByToken(targetToken, sessionToken);
+        RequestContext context{method, path, body, sessionToken, clientInfo, clientIP, match.params, Principal()};
         
-        // УПРАВЛЕНИЕ ПРЕПОДАВАТЕЛЯМИ
-        } else if (method == "GET" && path == "/teachers") {
-            return getTeachersJson(sessionToken);
-        } else if (method == "POST" && path == "/teachers") {
-            return handleAddTeacher(body);
-        } else if (method == "PUT" && std::regex_match(path, matches, teacherRegex)) {
-            int teacherId = std::stoi(matches[1]);
-            return handleUpdateTeacher(body, teacherId);
-        } else if (method == "PUT" && path.find("/teachers/") == 0) {
-            try {
-                json j = json::parse(body);
-                if (j.contains("teacher_id") && !j["teacher_id"].is_null()) {
-                    int teacherId = j["teacher_id"];
-                    return handleUpdateTeacher(body, teacherId);
-                } else {
-                    json errorResponse;
-                    errorResponse["success"] = false;
-                    errorResponse["error"] = "Teacher ID is required";
-                    return createJsonResponse(errorResponse.dump(), 400);
-                }
-            } catch (const std::exception& e) {
-                json errorResponse;
-                errorResponse["success"] = false;
-                errorResponse["error"] = "Неверный запрос на сервер.";
-                return createJsonResponse(errorResponse.dump(), 400);
+        // Аутентификация и прочие сквозные проверки выполняются один раз до обработчика
+        std::string stageResponse;
+        for (const auto& stage : middleware) {
+            if (!stage(match, context, stageResponse)) {
+                return stageResponse;
             }
-        } else if (method == "DELETE" && std::regex_match(path, matches, teacherRegex)) {
-            int teacherId = std::stoi(matches[1]);
-            return handleDeleteTeacher(teacherId);
-        
-        // УПРАВЛЕНИЕ СТУДЕНТАМИ
-        } else if (method == "GET" && path == "/students") {
-            return getStudentsJson(sessionToken);
-        } else if (method == "POST" && path == "/students") {
-            return handleAddStudent(body);
-        } else if (method == "PUT" && std::regex_match(path, matches, studentRegex)) {
-            int studentId = std::stoi(matches[1]);
-            return handleUpdateStudent(body, studentId);
-        } else if (method == "DELETE" && std::regex_match(path, matches, studentRegex)) {
-            int studentId = std::stoi(matches[1]);
-            return handleDeleteStudent(studentId);
-        
-        // УПРАВЛЕНИЕ СПЕЦИАЛИЗАЦИЯМИ
-        } else if (method == "GET" && path == "/specializations") {
-            return getSpecializationsJson(sessionToken);
-        } else if (method == "POST" && path == "/specializations") {
-            return handleAddSpecialization(body);
-        } else if (method == "DELETE" && std::regex_match(path, matches, specializationRegex)) {
-            int specializationCode = std::stoi(matches[1]);
-            return handleDeleteSpecialization(specializationCode);
-        
-        // СПЕЦИАЛИЗАЦИИ ПРЕПОДАВАТЕЛЕЙ
-        } else if (method == "POST" && std::regex_match(path, matches, teacherSpecializationsRegex)) {
-            return handleAddTeacherSpecialization(body);
-        } else if (method == "DELETE" && std::regex_match(path, matches, teacherSpecializationRegex)) {
-            int teacherId = std::stoi(matches[1]);
-            int specializationCode = std::stoi(matches[2]);
-            return handleRemoveTeacherSpecialization(teacherId, specializationCode);
-        } else if (method == "GET" && std::regex_match(path, matches, teacherSpecializationsRegex)) {
-            int teacherId = std::stoi(matches[1]);
-            return getTeacherSpecializationsJson(teacherId);
-        
-        // УПРАВЛЕНИЕ ГРУППАМИ
-        } else if (method == "GET" && path == "/groups") {
-            return getGroupsJson(sessionToken);
-        } else if (method == "GET" && std::regex_match(path, matches, groupStudentsRegex)) {
-            int groupId = std::stoi(matches[1]);
-            return handleGetStudentsByGroup(groupId);
-        } else if (method == "POST" && path == "/groups") {
-            return handleAddGroup(body);
-        } else if (method == "PUT" && std::regex_match(path, matches, groupRegex)) {
-            int groupId = std::stoi(matches[1]);
-            return handleUpdateGroup(body, groupId);
-        } else if (method == "DELETE" && std::regex_match(path, matches, groupRegex)) {
-            int groupId = std::stoi(matches[1]);
-            return handleDeleteGroup(groupId);
-        
-        // ПОРТФОЛИО
-        } else if (method == "GET" && path == "/portfolio") {
-            return getPortfolioJson(sessionToken);
-        } else if (method == "POST" && path == "/portfolio") {
-            return handleAddPortfolio(body);
-        } else if (method == "PUT" && std::regex_match(path, matches, portfolioRegex)) {
-            int portfolioId = std::stoi(matches[1]);
-            return handleUpdatePortfolio(body, portfolioId);
-        } else if (method == "DELETE" && std::regex_match(path, matches, portfolioRegex)) {
-            int portfolioId = std::stoi(matches[1]);
-            return handleDeletePortfolio(portfolioId);
-        
-        // СОБЫТИЯ
-        } else if (method == "GET" && path == "/events") {
-            return getEventsJson(sessionToken);
-        } else if (method == "POST" && path == "/events") {
-            return handleAddEvent(body);
-        } else if (method == "PUT" && std::regex_match(path, matches, eventRegex)) {
-            int eventId = std::stoi(matches[1]);
-            return handleUpdateEvent(body, eventId);
-        } else if (method == "DELETE" && std::regex_match(path, matches, eventRegex)) {
-            int eventId = std::stoi(matches[1]);
-            return handleDeleteEvent(eventId);
-        } else if (method == "GET" && path == "/event-categories") {
-            return getEventCategoriesJson();
         }
-        else if (method == "POST" && path == "/event-categories") {
-            return handleAddEventCategory(body);
-        }
-        else if (method == "PUT" && std::regex_match(path, matches, eventCategoryRegex)) {
-            int eventCode = std::stoi(matches[1]);  // ИЗВЛЕКАЕМ ЧИСЛО
-            return handleUpdateEventCategory(body, eventCode);
-        }
-        else if (method == "DELETE" && std::regex_match(path, matches, eventCategoryRegex)) {
-            int eventCode = std::stoi(matches[1]);
-            return handleDeleteEventCategory(eventCode);
-        } else if (method == "PUT" && std::regex_match(path, matches, eventCategoryRegex)) {
-            int eventCode = std::stoi(matches[1]);
-            return handleUpdateEventCategory(body, eventCode);
+        
+        if (match.result == Router::Result::METHOD_NOT_ALLOWED) {
+            Logger::getInstance().log("❌ Метод не поддерживается маршрутом: " + method + " " + path, "WARNING");
+            return createJsonResponse("{\"success\": false, \"error\": \"Method not allowed\"}", 405,
+                                      "Allow: " + Router::allowHeader(match.allowedMethods | Router::METHOD_OPTIONS) + "\r\n");
         }
-        else if (method == "DELETE" && std::regex_match(path, matches, eventCategoryRegex)) {
-            int eventCode = std::stoi(matches[1]);
-            return handleDeleteEventCategory(eventCode);
-            
+        
+        if (match.result == Router::Result::NOT_FOUND) {
+            // Если не найден подходящий маршрут
+            Logger::getInstance().log("❌ Маршрут не найден: " + method + " " + path, "WARNING");
+            return createJsonResponse("{\"success\": false, \"error\": \"Endpoint not found\"}", 404);
         }
         
-        // Если не найден подходящий маршрут
-        Logger::getInstance().log("❌ Маршрут не найден: " + method + " " + path, "WARNING");
-        return createJsonResponse("{\"success\": false, \"error\": \"Endpoint not found\"}", 404);
+        if (respond && deferred && match.route->asyncHandler) {
+            match.route->asyncHandler(context, respond);
+            *deferred = true;
+            return std::string();
+        }
+        return match.route->handler(context);
         
     } catch (const std::exception& e) {
         Logger::getInstance().log("💥 EXCEPTION в processRequest для клиента " + clientIP + ": " + std::string(e.what()), "ERROR");
@@ -975,7 +680,7 @@ std::string ApiService::processRequest(const std::string& method, const std::str
     }
 }
 
-std::string ApiService::createJsonResponse(const std::string& content, int statusCode) {
+std::string ApiService::createJsonResponse(const std::string& content, int statusCode, const std::string& extraHeaders) {
     // ВАЛИДАЦИЯ ВХОДНЫХ ДАННЫХ
     if (content.empty()) {
         Logger::getInstance().log("⚠️ Пустой контент в createJsonResponse, статус: " + std::to_string(statusCode), "WARNING");
@@ -998,6 +703,7 @@ std::string ApiService::createJsonResponse(const std::string& content, int statu
         case 413: statusText = "Payload Too Large"; break;
         case 429: statusText = "Too Many Requests"; break;
         case 500: statusText = "Internal Server Error"; break;
+        case 501: statusText = "Not Implemented"; break;
         case 505: statusText = "HTTP Version Not Supported"; break;
         default: statusText = "OK";
     }
@@ -1013,7 +719,8 @@ std::string ApiService::createJsonResponse(const std::string& content, int statu
                  << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
     }
     
-    response << "Content-Length: " << content.length() << "\r\n"
+    response << extraHeaders
+             << "Content-Length: " << content.length() << "\r\n"
              << "\r\n"
              << content;
     
@@ -1039,10 +746,18 @@ std::string ApiService::generateSessionToken() {
 }
 
 std::string ApiService::getUserIdFromSession(const std::string& token) {
-    std::lock_guard<std::mutex> lock(sessionsMutex);
-    auto it = sessions.find(token);
-    if (it != sessions.end()) {
-        return it->second.userId;
+    SignedTokenClaims claims;
+    if (tokenSigner.verify(token, claims)) {
+        return std::to_string(claims.userId);
+    }
+    
+    Session cached;
+    if (sessionStore.find(token, cached)) {
+        return cached.userId;
+    }
+    
+    if (rejectedTokens.contains(token)) {
+        return "";
     }
     
     // Check DB
@@ -1065,10 +780,10 @@ std::string ApiService::handleStatus() {
 }
 
 // функция отзыва сессии
-std::string ApiService::handleRevokeSessionByToken(const std::string& targetToken, const std::string& sessionToken) {
-    std::string userId = getUserIdFromSession(sessionToken);
+std::string ApiService::handleRevokeSessionByToken(const std::string& targetToken, const Principal& principal) {
+    const std::string& userId = principal.userId;
 
-    if (targetToken == sessionToken) {
+    if (targetToken == principal.session.token) {
         Logger::getInstance().log("❌ Пользователь пытается отозвать текущую сессию", "WARNING");
         json errorResponse;
         errorResponse["success"] = false;
@@ -1101,10 +816,10 @@ std::string ApiService::handleRevokeSessionByToken(const std::string& targetToke
 
     if (deleteSuccess) {
         // УДАЛЯЕМ СЕССИЮ ИЗ ПАМЯТИ
-        {
-            std::lock_guard<std::mutex> lock(sessionsMutex);
-            sessions.erase(targetToken);
-        }
+        sessionStore.erase(targetToken);
+        sessionActivity.forget(targetToken);
+        rejectedTokens.add(targetToken);
+        revokeSignedToken(targetToken);
 
         Logger::getInstance().log("✅ Сессия успешно отозвана!");
 
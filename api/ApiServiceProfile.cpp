@@ -1,20 +1,14 @@
 #include "api/ApiService.h"
 #include "json.hpp"
+#include "logger/logger.h"
 #include <iostream>
 
 using json = nlohmann::json;
 
-std::string ApiService::handleUpdateProfile(const std::string& body, const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
-    }
-    
+std::string ApiService::handleUpdateProfile(const std::string& body, const Principal& principal) {
     try {
         json j = json::parse(body);
-        std::string userId = getUserIdFromSession(sessionToken);
+        const std::string& userId = principal.userId;
         if (userId.empty()) {
             json errorResponse;
             errorResponse["success"] = false;
@@ -117,19 +111,12 @@ std::string ApiService::handleUpdateProfile(const std::string& body, const std::
     }
 }
 
-std::string ApiService::handleChangePassword(const std::string& body, const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
-    }
-    
+std::string ApiService::handleChangePassword(const std::string& body, const Principal& principal) {
     try {
         json j = json::parse(body);
         std::string currentPassword = j["currentPassword"];
         std::string newPassword = j["newPassword"];
-        std::string userId = getUserIdFromSession(sessionToken);
+        const std::string& userId = principal.userId;
         
         if (userId.empty()) {
             json errorResponse;
@@ -156,17 +143,8 @@ std::string ApiService::handleChangePassword(const std::string& body, const std:
         
         user.passwordHash = hashPassword(newPassword);
         if (dbService.updateUser(user)) {
-            {
-                std::lock_guard<std::mutex> lock(sessionsMutex);
-                auto it = sessions.begin();
-                while (it != sessions.end()) {
-                    if (it->second.userId == userId && it->first != sessionToken) {
-                        dbService.deleteSession(it->first);
-                        it = sessions.erase(it);
-                    } else {
-                        ++it;
-                    }
-                }
+            if (!revokeAllUserSessions(userId, &principal.session)) {
+                Logger::getInstance().log("⚠️ Пароль изменен, но другие сессии пользователя " + userId + " не отозваны", "WARNING");
             }
             
             json response;
@@ -0,0 +1,363 @@
+#include "api/ApiService.h"
+#include "json.hpp"
+#include "logger/logger.h"
+#include <algorithm>
+#include <cstdio>
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string urlDecode(const std::string& encoded) {
+    std::string decoded;
+    for (size_t i = 0; i < encoded.length(); ++i) {
+        if (encoded[i] == '%' && i + 2 < encoded.length()) {
+            unsigned int hexValue;
+            sscanf(encoded.substr(i + 1, 2).c_str(), "%x", &hexValue);
+            decoded += static_cast<char>(hexValue);
+            i += 2;
+        } else if (encoded[i] == '+') {
+            decoded += ' ';
+        } else {
+            decoded += encoded[i];
+        }
+    }
+    return decoded;
+}
+
+}
+
+bool ApiService::chargeRateLimit(const Router::Match& match, const RequestContext& ctx, std::string& response) {
+    uint32_t cost = match.route ? match.route->cost : 1;
+    bool allowed = ctx.principal.authenticated
+        ? rateLimiter.isAllowed("user:" + ctx.principal.userId,
+                                static_cast<uint32_t>(std::max(apiConfig.rateLimitUserRequests, 0)),
+                                std::chrono::seconds(apiConfig.rateLimitUserWindow), cost)
+        : rateLimiter.isAllowed("ip:" + ctx.clientIP,
+                                static_cast<uint32_t>(std::max(apiConfig.rateLimitAnonymousRequests, 0)),
+                                std::chrono::seconds(apiConfig.rateLimitAnonymousWindow), cost);
+    if (allowed) {
+        return true;
+    }
+    
+    Logger::getInstance().log("🚫 Исчерпан бюджет запросов (" + ctx.method + " " + ctx.path + ", стоимость " +
+                              std::to_string(cost) + ") для " +
+                              (ctx.principal.authenticated ? "пользователя " + ctx.principal.userId : ctx.clientIP),
+                              "WARNING");
+    response = createJsonResponse("{\"success\": false, \"error\": \"Too many requests, please try again later\"}", 429);
+    return false;
+}
+
+void ApiService::registerMiddleware() {
+    // АУТЕНТИФИКАЦИЯ: сессия проверяется и продлевается один раз за запрос,
+    // обработчики получают готовый principal из контекста
+    middleware.push_back([this](const Router::Match& match, RequestContext& ctx, std::string& response) {
+        bool publicRoute = match.result == Router::Result::FOUND
+                               ? !match.route->requiresAuth
+                               : match.publicMethods != 0;
+        if (publicRoute) {
+            return true;
+        }
+        
+        if (authenticateSession(ctx.sessionToken, ctx.principal)) {
+            return true;
+        }
+        
+        // Неудачная попытка тратит анонимный бюджет IP: иначе перебор токенов (каждый новый -
+        // запрос к БД) и сканирование закрытых маршрутов не ограничены ничем, а 401 не идет
+        // в автобан. Исчерпанный бюджет дает 429, и повторы приводят к бану IP
+        if (!chargeRateLimit(match, ctx, response)) {
+            return false;
+        }
+        
+        json errorResponse;
+        errorResponse["success"] = false;
+        errorResponse["error"] = "Unauthorized";
+        response = createJsonResponse(errorResponse.dump(), 401);
+        return false;
+    });
+    
+    // ВЗВЕШЕННЫЙ ЛИМИТ: после аутентификации, чтобы пользователь тратил свой бюджет,
+    // а не бюджет общего IP; дорогие маршруты списывают больше единиц
+    middleware.push_back([this](const Router::Match& match, RequestContext& ctx, std::string& response) {
+        return chargeRateLimit(match, ctx, response);
+    });
+}
+
+void ApiService::applyRouteCosts() {
+    for (const auto& entry : apiConfig.rateLimitRouteCosts) {
+        size_t space = entry.first.find(' ');
+        bool applied = space != std::string::npos && entry.second > 0 &&
+                       router.setCost(std::string_view(entry.first).substr(0, space),
+                                      std::string_view(entry.first).substr(space + 1),
+                                      static_cast<uint32_t>(entry.second));
+        if (!applied) {
+            Logger::getInstance().log("⚠️ rateLimitRouteCosts: неизвестный маршрут или стоимость \"" + entry.first + "\"", "WARNING");
+        }
+    }
+}
+
+void ApiService::registerRoutes() {
+    const bool PUBLIC = false;
+
+    // НОВОСТИ
+    router.add("GET", "/news", [this](const RequestContext&) {
+        return handleGetNewsList();
+    }, PUBLIC);
+    router.add("GET", "/news/{tail}", [this](const RequestContext& ctx) {
+        return handleGetNews(urlDecode(ctx.params.value(0)));
+    }, PUBLIC);
+
+    // АУТЕНТИФИКАЦИЯ И РЕГИСТРАЦИЯ
+    router.add("POST", "/register", [this](const RequestContext& ctx) {
+        return handleRegister(ctx.body, ctx.clientInfo);
+    }, PUBLIC);
+    router.add("POST", "/login", [this](const RequestContext& ctx) {
+        return handleLogin(ctx.body, ctx.clientInfo);
+    }, PUBLIC);
+    router.add("POST", "/logout", [this](const RequestContext& ctx) {
+        return handleLogout(ctx.sessionToken, ctx.clientInfo);
+    }, PUBLIC);
+    router.add("GET", "/verify-token", [this](const RequestContext& ctx) {
+        return handleVerifyToken(ctx.method, ctx.body, ctx.sessionToken);
+    }, PUBLIC);
+    router.add("POST", "/verify-token", [this](const RequestContext& ctx) {
+        return handleVerifyToken(ctx.method, ctx.body, ctx.sessionToken);
+    }, PUBLIC);
+
+    // СТАТУС СЕРВЕРА
+    router.add("GET", "/status", [this](const RequestContext&) {
+        return handleStatus();
+    }, PUBLIC);
+
+    // ПРОФИЛЬ И СЕССИИ
+    router.add("GET", "/dashboard", [this](const RequestContext& ctx) {
+        return handleGetDashboard(ctx.principal);
+    });
+    router.setAsyncHandler("GET", "/dashboard", [this](const RequestContext& ctx, Router::Responder respond) {
+        handleGetDashboardAsync(ctx.principal, std::move(respond));
+    });
+    router.add("GET", "/session-info", [this](const RequestContext& ctx) {
+        return getSessionInfo(ctx.principal);
+    });
+    router.add("GET", "/profile", [this](const RequestContext& ctx) {
+        return getProfile(ctx.principal);
+    });
+    router.add("PUT", "/profile", [this](const RequestContext& ctx) {
+        return handleUpdateProfile(ctx.body, ctx.principal);
+    });
+    router.add("POST", "/change-password", [this](const RequestContext& ctx) {
+        return handleChangePassword(ctx.body, ctx.principal);
+    });
+    router.add("GET", "/sessions", [this](const RequestContext& ctx) {
+        return handleGetSessions(ctx.principal);
+    });
+    router.add("POST", "/sessions/revoke-all", [this](const RequestContext& ctx) {
+        return handleRevokeAllSessions(ctx.principal);
+    });
+    router.add("DELETE", "/sessions/{hex}", [this](const RequestContext& ctx) {
+        return handleRevokeSessionByToken(ctx.params.value(0), ctx.principal);
+    });
+
+    // УПРАВЛЕНИЕ ПРЕПОДАВАТЕЛЯМИ
+    router.add("GET", "/teachers", [this](const RequestContext&) {
+        return getTeachersJson();
+    });
+    router.add("POST", "/teachers", [this](const RequestContext& ctx) {
+        return handleAddTeacher(ctx.body);
+    });
+    router.add("PUT", "/teachers/{id}", [this](const RequestContext& ctx) {
+        return handleUpdateTeacher(ctx.body, ctx.params.id(0));
+    });
+    // Старые клиенты передают teacher_id в теле, а не в пути
+    router.add("PUT", "/teachers/{str}", [this](const RequestContext& ctx) {
+        return handleUpdateTeacherFromBody(ctx.body);
+    });
+    router.add("DELETE", "/teachers/{id}", [this](const RequestContext& ctx) {
+        return handleDeleteTeacher(ctx.params.id(0));
+    });
+
+    // УПРАВЛЕНИЕ СТУДЕНТАМИ
+    router.add("GET", "/students", [this](const RequestContext&) {
+        return getStudentsJson();
+    });
+    router.add("POST", "/students", [this](const RequestContext& ctx) {
+        return handleAddStudent(ctx.body);
+    });
+    router.add("PUT", "/students/{id}", [this](const RequestContext& ctx) {
+        return handleUpdateStudent(ctx.body, ctx.params.id(0));
+    });
+    router.add("DELETE", "/students/{id}", [this](const RequestContext& ctx) {
+        return handleDeleteStudent(ctx.params.id(0));
+    });
+
+    // УПРАВЛЕНИЕ СПЕЦИАЛИЗАЦИЯМИ
+    router.add("GET", "/specializations", [this](const RequestContext&) {
+        return getSpecializationsJson();
+    });
+    router.add("POST", "/specializations", [this](const RequestContext& ctx) {
+        return handleAddSpecialization(ctx.body);
+    });
+    router.add("DELETE", "/specializations/{id}", [this](const RequestContext& ctx) {
+        return handleDeleteSpecialization(ctx.params.id(0));
+    });
+
+    // СПЕЦИАЛИЗАЦИИ ПРЕПОДАВАТЕЛЕЙ
+    router.add("GET", "/teachers/{id}/specializations", [this](const RequestContext& ctx) {
+        return getTeacherSpecializationsJson(ctx.params.id(0));
+    });
+    router.add("POST", "/teachers/{id}/specializations", [this](const RequestContext& ctx) {
+        return handleAddTeacherSpecialization(ctx.body);
+    });
+    router.add("DELETE", "/teachers/{id}/specializations/{id}", [this](const RequestContext& ctx) {
+        return handleRemoveTeacherSpecialization(ctx.params.id(0), ctx.params.id(1));
+    });
+
+    // УПРАВЛЕНИЕ ГРУППАМИ
+    router.add("GET", "/groups", [this](const RequestContext&) {
+        return getGroupsJson();
+    });
+    router.add("POST", "/groups", [this](const RequestContext& ctx) {
+        return handleAddGroup(ctx.body);
+    });
+    router.add("GET", "/groups/{id}/students", [this](const RequestContext& ctx) {
+        return handleGetStudentsByGroup(ctx.params.id(0));
+    });
+    router.add("PUT", "/groups/{id}", [this](const RequestContext& ctx) {
+        return handleUpdateGroup(ctx.body, ctx.params.id(0));
+    });
+    router.add("DELETE", "/groups/{id}", [this](const RequestContext& ctx) {
+        return handleDeleteGroup(ctx.params.id(0));
+    });
+
+    // ПОРТФОЛИО
+    router.add("GET", "/portfolio", [this](const RequestContext&) {
+        return getPortfolioJson();
+    });
+    router.add("POST", "/portfolio", [this](const RequestContext& ctx) {
+        return handleAddPortfolio(ctx.body);
+    });
+    router.add("PUT", "/portfolio/{id}", [this](const RequestContext& ctx) {
+        return handleUpdatePortfolio(ctx.body, ctx.params.id(0));
+    });
+    router.add("DELETE", "/portfolio/{id}", [this](const RequestContext& ctx) {
+        return handleDeletePortfolio(ctx.params.id(0));
+    });
+
+    // СОБЫТИЯ
+    router.add("GET", "/events", [this](const RequestContext&) {
+        return getEventsJson();
+    });
+    router.add("POST", "/events", [this](const RequestContext& ctx) {
+        return handleAddEvent(ctx.body);
+    });
+    router.add("PUT", "/events/{id}", [this](const RequestContext& ctx) {
+        return handleUpdateEvent(ctx.body, ctx.params.id(0));
+    });
+    router.add("DELETE", "/events/{id}", [this](const RequestContext& ctx) {
+        return handleDeleteEvent(ctx.params.id(0));
+    });
+
+    // КАТЕГОРИИ СОБЫТИЙ
+    router.add("GET", "/event-categories", [this](const RequestContext&) {
+        return getEventCategoriesJson();
+    });
+    router.add("POST", "/event-categories", [this](const RequestContext& ctx) {
+        return handleAddEventCategory(ctx.body);
+    });
+    router.add("PUT", "/event-categories/{id}", [this](const RequestContext& ctx) {
+        return handleUpdateEventCategory(ctx.body, ctx.params.id(0));
+    });
+    router.add("DELETE", "/event-categories/{id}", [this](const RequestContext& ctx) {
+        return handleDeleteEventCategory(ctx.params.id(0));
+    });
+}
+
+std::string ApiService::handleVerifyToken(const std::string& method, const std::string& body, const std::string& sessionToken) {
+    std::string tokenToValidate = sessionToken;
+
+    // Если это POST запрос, пытаемся извлечь токен из тела
+    if (method == "POST" && !body.empty()) {
+        try {
+            json j = json::parse(body);
+            if (j.contains("token") && !j["token"].is_null()) {
+                tokenToValidate = j["token"];
+            }
+        } catch (const std::exception& e) {
+            Logger::getInstance().log("⚠️ Не удалось распарсить тело verify-token запроса: " + std::string(e.what()), "WARNING");
+        }
+    }
+
+    if (tokenToValidate.empty()) {
+        json errorResponse;
+        errorResponse["success"] = false;
+        errorResponse["valid"] = false;
+        errorResponse["error"] = "Token is required";
+        return createJsonResponse(errorResponse.dump(), 400);
+    }
+
+    // УНИВЕРСАЛЬНАЯ ПРОВЕРКА ТОКЕНА
+    bool isValid = validateTokenInDatabase(tokenToValidate);
+
+    if (isValid) {
+        // Токен валиден, получаем информацию о пользователе
+        std::string userId = getUserIdFromSession(tokenToValidate);
+        User user = dbService.getUserById(std::stoi(userId));
+
+        if (user.userId == 0) {
+            json errorResponse;
+            errorResponse["success"] = false;
+            errorResponse["valid"] = false;
+            errorResponse["error"] = "User not found";
+            return createJsonResponse(errorResponse.dump(), 404);
+        }
+
+        // ФОРМИРУЕМ УНИВЕРСАЛЬНЫЙ ОТВЕТ ДЛЯ КЛИЕНТА
+        json responseData;
+        responseData["valid"] = true;
+        responseData["userId"] = userId;
+        responseData["user"] = {
+            {"userId", user.userId},
+            {"login", user.login},
+            {"email", user.email},
+            {"firstName", user.firstName},
+            {"lastName", user.lastName},
+            {"middleName", user.middleName},
+            {"phoneNumber", user.phoneNumber}
+        };
+
+        json response;
+        response["success"] = true;
+        response["valid"] = true;
+        response["data"] = responseData;
+        response["message"] = "Token is valid";
+
+        return createJsonResponse(response.dump());
+    }
+
+    json errorResponse;
+    errorResponse["success"] = false;
+    errorResponse["valid"] = false;
+    errorResponse["error"] = "Invalid or expired token";
+    return createJsonResponse(errorResponse.dump(), 401);
+}
+
+std::string ApiService::handleUpdateTeacherFromBody(const std::string& body) {
+    try {
+        json j = json::parse(body);
+        if (j.contains("teacher_id") && !j["teacher_id"].is_null()) {
+            int teacherId = j["teacher_id"];
+            return handleUpdateTeacher(body, teacherId);
+        }
+
+        json errorResponse;
+        errorResponse["success"] = false;
+        errorResponse["error"] = "Teacher ID is required";
+        return createJsonResponse(errorResponse.dump(), 400);
+    } catch (const std::exception& e) {
+        json errorResponse;
+        errorResponse["success"] = false;
+        errorResponse["error"] = "Неверный запрос на сервер.";
+        return createJsonResponse(errorResponse.dump(), 400);
+    }
+}
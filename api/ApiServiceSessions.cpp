@@ -1,51 +1,109 @@
 #include "api/ApiService.h"
+#include "logger/logger.h"
 #include "json.hpp"
+#include <algorithm>
 #include <iostream>
 
 using json = nlohmann::json;
 
 void ApiService::loadSessionsFromDB() {
     auto activeSessions = dbService.getAllActiveSessions();
-    {
-        std::lock_guard<std::mutex> lock(sessionsMutex);
-        sessions.clear();
-        for (const auto& sess : activeSessions) {
-            sessions[sess.token] = sess;
-        }
+    sessionStore.replaceAll(activeSessions);
+    sessionCacheComplete = true;
+}
+
+void ApiService::loadSessions() {
+    refreshSessionGenerations();
+
+    std::chrono::system_clock::time_point snapshotTime;
+    if (apiConfig.sessionSnapshotPath.empty() ||
+        !sessionStore.loadSnapshot(apiConfig.sessionSnapshotPath, snapshotTime)) {
+        loadSessionsFromDB();
+        return;
     }
+    
+    Logger::getInstance().log("⚡ Сессии загружены из снимка: " + std::to_string(sessionStore.size()));
+    reconcileThread = std::thread(&ApiService::reconcileSessions, this, snapshotTime);
 }
 
-std::string ApiService::getSessionInfo(const std::string& token) {
-    std::lock_guard<std::mutex> lock(sessionsMutex);
-    auto it = sessions.find(token);
-    if (it != sessions.end()) {
-        json sessionJson;
-        sessionJson["userId"] = it->second.userId;
-        sessionJson["email"] = it->second.email;
-        sessionJson["createdAt"] = std::chrono::duration_cast<std::chrono::seconds>(
-            it->second.createdAt.time_since_epoch()).count();
-        sessionJson["lastActivity"] = std::chrono::duration_cast<std::chrono::seconds>(
-            it->second.lastActivity.time_since_epoch()).count();
-        return sessionJson.dump();
+void ApiService::reconcileSessions(std::chrono::system_clock::time_point snapshotTime) {
+    auto startedAt = std::chrono::system_clock::now();
+    
+    // Запас покрывает продления, которые на момент снимка еще ждали отложенной записи в БД
+    auto since = snapshotTime - std::chrono::minutes(5);
+    auto changed = dbService.getSessionsChangedSince(since);
+    sessionStore.merge(changed);
+    
+    // Сессии, удаленные из БД после снимка (выход, отзыв на другом экземпляре), убираем из кэша
+    std::vector<std::string> activeTokens;
+    if (!dbService.getActiveSessionTokens(activeTokens)) {
+        Logger::getInstance().log("⚠️ Сверка сессий с БД не удалась, кэш оставлен как есть", "WARNING");
+        return;
     }
-    return "{}";
+    size_t removed = sessionStore.retainOnly(activeTokens, startedAt);
+    sessionCacheComplete = true;
+    
+    Logger::getInstance().log("🔄 Сверка сессий с БД: обновлено " + std::to_string(changed.size()) +
+                              ", удалено " + std::to_string(removed));
 }
 
-std::string ApiService::handleGetSessions(const std::string& sessionToken) {
-    if (!validateSession(sessionToken)) {
-        json errorResponse;
-        errorResponse["success"] = false;
-        errorResponse["error"] = "Unauthorized";
-        return createJsonResponse(errorResponse.dump(), 401);
+void ApiService::saveSessionSnapshot() {
+    if (apiConfig.sessionSnapshotPath.empty()) {
+        return;
     }
     
-    std::string userId = getUserIdFromSession(sessionToken);
-    auto userSessions = dbService.getSessionsByUserId(userId);
+    if (!sessionStore.saveSnapshot(apiConfig.sessionSnapshotPath)) {
+        Logger::getInstance().log("⚠️ Не удалось сохранить снимок сессий в " + apiConfig.sessionSnapshotPath, "WARNING");
+    }
+}
+
+std::string ApiService::getSessionInfo(const Principal& principal) {
+    const Session& session = principal.session;
+    json sessionJson;
+    sessionJson["userId"] = session.userId;
+    sessionJson["email"] = session.email;
+    sessionJson["createdAt"] = std::chrono::duration_cast<std::chrono::seconds>(
+        session.createdAt.time_since_epoch()).count();
+    sessionJson["lastActivity"] = std::chrono::duration_cast<std::chrono::seconds>(
+        session.lastActivity.time_since_epoch()).count();
+    return sessionJson.dump();
+}
+
+json ApiService::buildSessionListJson(const std::string& userId, const std::string& currentToken) {
+    // Все активные сессии кэш содержит, только если экземпляр API один и начальная загрузка
+    // (или сверка снимка с БД) завершена - тогда список собирается по индексу userId без БД.
+    // Иначе список берется из БД: сессии, созданные другими экземплярами, в кэше могут
+    // отсутствовать. Кэшированные записи свежее БД (продления пишутся отложенно) и заменяют строки БД
+    auto userSessions = sessionStore.findByUser(userId);
+    if (!apiConfig.singleInstance || !sessionCacheComplete) {
+        // Пустой ответ - сбой БД (сессия самого пользователя в ней есть): остается кэш
+        auto stored = dbService.getSessionsByUserId(userId);
+        if (!stored.empty()) {
+            std::unordered_map<std::string, Session> cached;
+            for (auto& session : userSessions) {
+                std::string token = session.token;
+                cached.emplace(std::move(token), std::move(session));
+            }
+            for (auto& session : stored) {
+                auto it = cached.find(session.token);
+                if (it != cached.end()) {
+                    // Поколение берем из БД: сохраненную при отзыве сессию другой экземпляр
+                    // перевел в новое поколение только там
+                    int generation = std::max(session.generation, it->second.generation);
+                    session = std::move(it->second);
+                    session.generation = generation;
+                }
+            }
+            userSessions = std::move(stored);
+        }
+    }
+    int generation = sessionGenerations.generation(static_cast<int>(std::strtol(userId.c_str(), nullptr, 10)));
     json sessionsArray = json::array();
     auto now = std::chrono::system_clock::now();
     
     for (const auto& session : userSessions) {
         if (now > session.expiresAt) continue;
+        if (session.generation < generation) continue;
         
         auto age = std::chrono::duration_cast<std::chrono::hours>(now - session.createdAt);
         auto inactive = std::chrono::duration_cast<std::chrono::minutes>(now - session.lastActivity);
@@ -61,14 +119,31 @@ std::string ApiService::handleGetSessions(const std::string& sessionToken) {
             session.lastActivity.time_since_epoch()).count();
         sessionJson["ageHours"] = age.count();
         sessionJson["inactiveMinutes"] = inactive.count();
-        sessionJson["isCurrent"] = (session.token == sessionToken);
+        sessionJson["isCurrent"] = (session.token == currentToken);
         
         sessionsArray.push_back(sessionJson);
     }
+    return sessionsArray;
+}
+
+std::string ApiService::handleGetSessions(const Principal& principal) {
+    json response;
+    response["success"] = true;
+    response["data"] = buildSessionListJson(principal.userId, principal.session.token);
+    return createJsonResponse(response.dump());
+}
+
+std::string ApiService::handleRevokeAllSessions(const Principal& principal) {
+    if (!revokeAllUserSessions(principal.userId, &principal.session)) {
+        json errorResponse;
+        errorResponse["success"] = false;
+        errorResponse["error"] = "Failed to revoke sessions";
+        return createJsonResponse(errorResponse.dump(), 500);
+    }
     
     json response;
     response["success"] = true;
-    response["data"] = sessionsArray;
+    response["message"] = "All other sessions revoked successfully";
     return createJsonResponse(response.dump());
 }
 
@@ -126,10 +201,10 @@ std::string ApiService::handleRevokeSession(const std::string& body, const std::
         bool deleteSuccess = dbService.deleteSession(targetToken);
         
         if (deleteSuccess) {
-            {
-                std::lock_guard<std::mutex> lock(sessionsMutex);
-                sessions.erase(targetToken);
-            }
+            sessionStore.erase(targetToken);
+            sessionActivity.forget(targetToken);
+            rejectedTokens.add(targetToken);
+            revokeSignedToken(targetToken);
             
             json response;
             response["success"] = true;
@@ -155,71 +230,263 @@ std::string ApiService::handleRevokeSession(const std::string& body, const std::
 }
 
 bool ApiService::validateSession(const std::string& token) {
+    Principal principal;
+    return authenticateSession(token, principal);
+}
+
+bool ApiService::authenticateSession(const std::string& token, Principal& principal) {
     if (token.empty()) {
         return false;
     }
     
-    std::lock_guard<std::mutex> lock(sessionsMutex);
-    auto it = sessions.find(token);
-    if (it == sessions.end()) {
-        Session sess = dbService.getSessionByToken(token);
-        if (sess.token.empty()) {
+    SignedTokenClaims claims;
+    if (tokenSigner.verify(token, claims)) {
+        return authenticateSignedToken(token, claims, principal);
+    }
+    
+    auto now = std::chrono::system_clock::now();
+    auto newExpires = now + std::chrono::hours(apiConfig.sessionTimeoutHours);
+    
+    Session session;
+    bool fromDatabase = false;
+    auto touched = sessionStore.touch(token, now, newExpires, session);
+    if (touched == SessionStore::TouchResult::EXPIRED) {
+        sessionActivity.forget(token);
+        rejectedTokens.add(token);
+        dbService.deleteSession(token);
+        return false;
+    }
+    
+    if (touched == SessionStore::TouchResult::MISSING) {
+        if (rejectedTokens.contains(token)) {
+            return false;
+        }
+        
+        // Сессии нет в кэше - запрашиваем БД без удержания блокировок.
+        // Запоминаем отказ, только если БД ответила, что сессии нет: сбой БД или
+        // исчерпанный пул не должны блокировать действующий токен на весь срок кэша
+        bool answered = dbService.getSessionByToken(token, session);
+        if (session.token.empty()) {
+            if (answered) {
+                rejectedTokens.add(token);
+            }
+            return false;
+        }
+        if (now > session.expiresAt) {
+            rejectedTokens.add(token);
+            dbService.deleteSession(token);
+            return false;
+        }
+        session.lastActivity = now;
+        session.expiresAt = newExpires;
+        sessionStore.put(session);
+        fromDatabase = true;
+    }
+    
+    // Отозванные сменой поколения сессии удаляются лениво, при первом предъявлении.
+    // Поколение в кэше может быть устаревшим (сессию сохранил при отзыве другой экземпляр),
+    // поэтому перед удалением сверяемся с БД, если сессия прочитана не только что оттуда
+    if (sessionGenerations.isStale(session)) {
+        Session stored;
+        auto verdict = fromDatabase ? SessionGenerationTable::Verdict::REVOKED
+                                    : recheckSessionGeneration(token, stored);
+        if (verdict == SessionGenerationTable::Verdict::UNKNOWN) {
             return false;
         }
-        auto now = std::chrono::system_clock::now();
-        if (now > sess.expiresAt) {
+        if (verdict == SessionGenerationTable::Verdict::REVOKED) {
+            sessionStore.erase(token);
+            sessionActivity.forget(token);
+            rejectedTokens.add(token);
             dbService.deleteSession(token);
             return false;
         }
-        sessions[token] = sess;
-        it = sessions.find(token);
+        session.generation = stored.generation;
+        sessionStore.setGeneration(token, stored.generation);
     }
     
+    sessionActivity.record(token, now, newExpires);
+    
+    principal.authenticated = true;
+    principal.userId = session.userId;
+    principal.session = session;
+    return true;
+}
+
+bool ApiService::authenticateSignedToken(const std::string& token, const SignedTokenClaims& claims, Principal& principal) {
     auto now = std::chrono::system_clock::now();
-    if (now > it->second.expiresAt) {
-        dbService.deleteSession(token);
-        sessions.erase(it);
+    if (now > claims.expiresAt || isTokenRevoked(token)) {
         return false;
     }
     
-    auto newLast = now;
-    auto newExpires = now + std::chrono::hours(apiConfig.sessionTimeoutHours);
-    it->second.lastActivity = newLast;
-    it->second.expiresAt = newExpires;
+    // Срок подписанного токена зашит в него и не продлевается, поэтому БД не трогаем.
+    // Если сессия выдана этим экземпляром, берем из кэша ее полную запись.
+    Session session;
+    bool cached = sessionStore.find(token, session);
+    if (cached ? sessionGenerations.isStale(session) : sessionGenerations.isStale(claims)) {
+        // Токен, сохраненный при отзыве, выдан раньше отзыва и на других экземплярах (или после
+        // перезапуска) выглядит отозванным; его новое поколение записано только в строке БД
+        if (rejectedTokens.contains(token)) {
+            return false;
+        }
+        Session stored;
+        auto verdict = recheckSessionGeneration(token, stored);
+        if (verdict != SessionGenerationTable::Verdict::CURRENT) {
+            if (verdict == SessionGenerationTable::Verdict::REVOKED) {
+                sessionStore.erase(token);
+                rejectedTokens.add(token);
+            }
+            return false;
+        }
+        if (cached) {
+            session.generation = stored.generation;
+            sessionStore.setGeneration(token, stored.generation);
+        } else {
+            // Запоминаем в кэше, чтобы следующие запросы не перепроверяли токен по БД
+            session = stored;
+            session.lastActivity = now;
+            session.expiresAt = claims.expiresAt;
+            sessionStore.put(session);
+        }
+    } else if (!cached) {
+        session.sessionId = 0;
+        session.token = token;
+        session.userId = std::to_string(claims.userId);
+        session.createdAt = claims.issuedAt;
+        session.lastActivity = now;
+        session.expiresAt = claims.expiresAt;
+    }
     
-    dbService.updateSessionLastActivity(token, newLast, newExpires);
+    principal.authenticated = true;
+    principal.userId = session.userId;
+    principal.session = session;
     return true;
 }
 
+bool ApiService::isTokenRevoked(const std::string& token) {
+    std::shared_lock<std::shared_mutex> lock(revokedTokensMutex);
+    return revokedTokens.count(token) > 0;
+}
+
+void ApiService::revokeSignedToken(const std::string& token) {
+    SignedTokenClaims claims;
+    if (!tokenSigner.verify(token, claims) || std::chrono::system_clock::now() > claims.expiresAt) {
+        return;
+    }
+    
+    {
+        std::unique_lock<std::shared_mutex> lock(revokedTokensMutex);
+        revokedTokens.insert(token);
+    }
+    dbService.addRevokedToken(token, claims.expiresAt);
+}
+
+SessionGenerationTable::Verdict ApiService::recheckSessionGeneration(const std::string& token, Session& stored) {
+    return sessionGenerations.recheck(token, [this](const std::string& key, Session& row) {
+        return dbService.getSessionByToken(key, row);
+    }, stored);
+}
+
+bool ApiService::revokeAllUserSessions(const std::string& userId, const Session* keep) {
+    UserSessionGeneration entry;
+    entry.userId = static_cast<int>(std::strtol(userId.c_str(), nullptr, 10));
+    entry.revokedAt = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+    if (!dbService.bumpSessionGeneration(entry.userId, entry.revokedAt, entry.generation)) {
+        return false;
+    }
+    
+    // Сохраняемую сессию переводим в новое поколение до публикации поколения,
+    // чтобы параллельный запрос с ней не был отклонен
+    if (keep != nullptr) {
+        if (!sessionStore.setGeneration(keep->token, entry.generation)) {
+            Session kept = *keep;
+            kept.generation = entry.generation;
+            sessionStore.put(kept);
+        }
+        dbService.updateSessionGeneration(keep->token, entry.generation);
+    }
+    
+    sessionGenerations.publish(entry);
+    Logger::getInstance().log("🔒 Все сессии пользователя " + userId + " отозваны (поколение " +
+                              std::to_string(entry.generation) + ")");
+    return true;
+}
+
+void ApiService::refreshSessionGenerations() {
+    // При ошибке БД остается прежняя таблица: пустая вернула бы к жизни все отозванные сессии
+    std::vector<UserSessionGeneration> generations;
+    if (!dbService.getSessionGenerations(generations)) {
+        return;
+    }
+    sessionGenerations.replace(generations);
+}
+
+void ApiService::refreshRevokedTokens() {
+    // Читаем из БД вне блокировки, затем подменяем набор целиком. При ошибке БД
+    // остается прежний набор: пустой снова сделал бы действительными все отозванные токены
+    std::vector<std::string> tokens;
+    if (!dbService.getRevokedTokens(tokens)) {
+        return;
+    }
+    std::unordered_set<std::string> fresh(tokens.begin(), tokens.end());
+    
+    std::unique_lock<std::shared_mutex> lock(revokedTokensMutex);
+    revokedTokens.swap(fresh);
+}
+
 bool ApiService::validateTokenInDatabase(const std::string& token) {
-    if (token.empty()) {
+    if (token.empty() || rejectedTokens.contains(token)) {
         return false;
     }
     
-    Session sess = dbService.getSessionByToken(token);
+    SignedTokenClaims claims;
+    if (tokenSigner.verify(token, claims)) {
+        // Те же проверки срока, отзыва и поколения (с перепроверкой по БД), что и при аутентификации
+        Principal principal;
+        return authenticateSignedToken(token, claims, principal);
+    }
+    
+    Session sess;
+    bool answered = dbService.getSessionByToken(token, sess);
     if (sess.token.empty()) {
+        if (answered) {
+            rejectedTokens.add(token);
+        }
         return false;
     }
     
     auto now = std::chrono::system_clock::now();
-    if (now > sess.expiresAt) {
+    // Строка только что прочитана из БД - ее поколение окончательное
+    if (now > sess.expiresAt || sessionGenerations.isStale(sess)) {
+        rejectedTokens.add(token);
         dbService.deleteSession(token);
         return false;
     }
     
-    dbService.updateSessionLastActivity(token, now, now + std::chrono::hours(apiConfig.sessionTimeoutHours));
+    sessionActivity.record(token, now, now + std::chrono::hours(apiConfig.sessionTimeoutHours));
     return true;
 }
 
 void ApiService::cleanupExpiredSessions() {
-    auto now = std::chrono::system_clock::now();
-    std::lock_guard<std::mutex> lock(sessionsMutex);
-    for (auto it = sessions.begin(); it != sessions.end(); ) {
-        if (now > it->second.expiresAt) {
-            dbService.deleteSession(it->first);
-            it = sessions.erase(it);
-        } else {
-            ++it;
-        }
+    auto expired = sessionStore.eraseExpired(std::chrono::system_clock::now());
+    if (expired.empty()) {
+        return;
+    }
+    
+    for (const auto& token : expired) {
+        sessionActivity.forget(token);
+    }
+    dbService.deleteSessions(expired);
+}
+
+void ApiService::flushSessionActivity() {
+    auto batch = sessionActivity.takePending(std::chrono::system_clock::now());
+    if (batch.empty()) {
+        return;
+    }
+    
+    if (!dbService.updateSessionsLastActivity(batch)) {
+        Logger::getInstance().log("⚠️ Не удалось записать продления сессий (" + std::to_string(batch.size()) +
+                                  "), повторим при следующем сбросе", "WARNING");
+        sessionActivity.restore(batch);
     }
 }
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "api/EventLoop.h"
+#include "logger/logger.h"
+#include <vector>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#ifdef _WIN32
+
+EventLoop::EventLoop() : wakeupSocket(INVALID_SOCKET_VAL) {
+    memset(&wakeupAddr, 0, sizeof(wakeupAddr));
+}
+
+EventLoop::~EventLoop() {
+    close();
+}
+
+bool EventLoop::open() {
+    if (isOpen()) return true;
+
+    // На Windows нет eventfd - будим WSAPoll датаграммой самому себе через loopback
+    wakeupSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wakeupSocket == INVALID_SOCKET_VAL) {
+        Logger::getInstance().log("❌ Не удалось создать сокет пробуждения: " + std::to_string(WSAGetLastError()), "ERROR");
+        return false;
+    }
+
+    wakeupAddr.sin_family = AF_INET;
+    wakeupAddr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    wakeupAddr.sin_port = 0;
+
+    int addrLen = sizeof(wakeupAddr);
+    if (bind(wakeupSocket, (sockaddr*)&wakeupAddr, sizeof(wakeupAddr)) != 0 ||
+        getsockname(wakeupSocket, (sockaddr*)&wakeupAddr, &addrLen) != 0) {
+        Logger::getInstance().log("❌ Не удалось настроить сокет пробуждения: " + std::to_string(WSAGetLastError()), "ERROR");
+        CLOSE_SOCKET(wakeupSocket);
+        wakeupSocket = INVALID_SOCKET_VAL;
+        return false;
+    }
+
+    setNonBlocking(wakeupSocket);
+    interests.clear();
+    return true;
+}
+
+void EventLoop::close() {
+    if (wakeupSocket != INVALID_SOCKET_VAL) {
+        CLOSE_SOCKET(wakeupSocket);
+        wakeupSocket = INVALID_SOCKET_VAL;
+    }
+    interests.clear();
+}
+
+bool EventLoop::isOpen() const {
+    return wakeupSocket != INVALID_SOCKET_VAL;
+}
+
+bool EventLoop::add(SOCKET_TYPE socket, uint32_t events) {
+    interests[socket] = events;
+    return true;
+}
+
+bool EventLoop::modify(SOCKET_TYPE socket, uint32_t events) {
+    auto it = interests.find(socket);
+    if (it == interests.end()) return false;
+    it->second = events;
+    return true;
+}
+
+void EventLoop::remove(SOCKET_TYPE socket) {
+    interests.erase(socket);
+}
+
+int EventLoop::poll(int timeoutMs, const Handler& handler) {
+    std::vector<WSAPOLLFD> fds;
+    fds.reserve(interests.size() + 1);
+
+    WSAPOLLFD wakeFd;
+    wakeFd.fd = wakeupSocket;
+    wakeFd.events = POLLRDNORM;
+    wakeFd.revents = 0;
+    fds.push_back(wakeFd);
+
+    for (const auto& entry : interests) {
+        WSAPOLLFD pfd;
+        pfd.fd = entry.first;
+        pfd.events = 0;
+        if (entry.second & EVENT_READ) pfd.events |= POLLRDNORM;
+        if (entry.second & EVENT_WRITE) pfd.events |= POLLWRNORM;
+        pfd.revents = 0;
+        fds.push_back(pfd);
+    }
+
+    int ready = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+    if (ready < 0) {
+        int err = WSAGetLastError();
+        if (err != WSAEINTR) {
+            Logger::getInstance().log("❌ Ошибка WSAPoll: " + std::to_string(err), "ERROR");
+            return -1;
+        }
+        return 0;
+    }
+
+    int handled = 0;
+    for (const auto& pfd : fds) {
+        if (pfd.revents == 0) continue;
+
+        if (pfd.fd == wakeupSocket) {
+            drainWakeup();
+            continue;
+        }
+
+        uint32_t events = 0;
+        if (pfd.revents & (POLLRDNORM | POLLHUP)) events |= EVENT_READ;
+        if (pfd.revents & POLLWRNORM) events |= EVENT_WRITE;
+        if (pfd.revents & (POLLERR | POLLNVAL)) events |= EVENT_ERROR;
+
+        // Обработчик мог закрыть сокет, обработав предыдущее событие
+        if (interests.find(pfd.fd) == interests.end()) continue;
+
+        handler(pfd.fd, events);
+        handled++;
+    }
+
+    return handled;
+}
+
+void EventLoop::wakeup() {
+    if (wakeupSocket == INVALID_SOCKET_VAL) return;
+    char byte = 1;
+    sendto(wakeupSocket, &byte, 1, 0, (sockaddr*)&wakeupAddr, sizeof(wakeupAddr));
+}
+
+void EventLoop::drainWakeup() {
+    char buffer[64];
+    while (recv(wakeupSocket, buffer, sizeof(buffer), 0) > 0) {
+    }
+}
+
+bool EventLoop::setNonBlocking(SOCKET_TYPE socket) {
+    u_long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+}
+
+#else
+
+EventLoop::EventLoop() : epollFd(-1), wakeupFd(-1) {}
+
+EventLoop::~EventLoop() {
+    close();
+}
+
+bool EventLoop::open() {
+    if (isOpen()) return true;
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        Logger::getInstance().log("❌ Не удалось создать epoll: " + std::string(strerror(errno)), "ERROR");
+        return false;
+    }
+
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd == -1) {
+        Logger::getInstance().log("❌ Не удалось создать eventfd: " + std::string(strerror(errno)), "ERROR");
+        ::close(epollFd);
+        epollFd = -1;
+        return false;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeupFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &ev) == -1) {
+        Logger::getInstance().log("❌ Не удалось зарегистрировать eventfd: " + std::string(strerror(errno)), "ERROR");
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void EventLoop::close() {
+    if (wakeupFd != -1) {
+        ::close(wakeupFd);
+        wakeupFd = -1;
+    }
+    if (epollFd != -1) {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+}
+
+bool EventLoop::isOpen() const {
+    return epollFd != -1;
+}
+
+static uint32_t toEpollEvents(uint32_t events) {
+    // Edge-triggered (кроме EVENT_LEVEL): владелец сокета обязан вычитывать/дописывать до EAGAIN
+    uint32_t result = (events & EventLoop::EVENT_LEVEL) ? EPOLLRDHUP : EPOLLET | EPOLLRDHUP;
+    if (events & EventLoop::EVENT_READ) result |= EPOLLIN;
+    if (events & EventLoop::EVENT_WRITE) result |= EPOLLOUT;
+    return result;
+}
+
+bool EventLoop::add(SOCKET_TYPE socket, uint32_t events) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = toEpollEvents(events);
+    ev.data.fd = socket;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &ev) == 0;
+}
+
+bool EventLoop::modify(SOCKET_TYPE socket, uint32_t events) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = toEpollEvents(events);
+    ev.data.fd = socket;
+    return epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &ev) == 0;
+}
+
+void EventLoop::remove(SOCKET_TYPE socket) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+int EventLoop::poll(int timeoutMs, const Handler& handler) {
+    epoll_event events[128];
+    int ready = epoll_wait(epollFd, events, 128, timeoutMs);
+    if (ready < 0) {
+        if (errno != EINTR) {
+            Logger::getInstance().log("❌ Ошибка epoll_wait: " + std::string(strerror(errno)), "ERROR");
+            return -1;
+        }
+        return 0;
+    }
+
+    int handled = 0;
+    for (int i = 0; i < ready; i++) {
+        int fd = events[i].data.fd;
+        if (fd == wakeupFd) {
+            drainWakeup();
+            continue;
+        }
+
+        uint32_t flags = 0;
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) flags |= EVENT_READ;
+        if (events[i].events & EPOLLOUT) flags |= EVENT_WRITE;
+        if (events[i].events & EPOLLERR) flags |= EVENT_ERROR;
+
+        handler(fd, flags);
+        handled++;
+    }
+
+    return handled;
+}
+
+void EventLoop::wakeup() {
+    if (wakeupFd == -1) return;
+    uint64_t one = 1;
+    ssize_t written = write(wakeupFd, &one, sizeof(one));
+    (void)written;
+}
+
+void EventLoop::drainWakeup() {
+    uint64_t value;
+    while (read(wakeupFd, &value, sizeof(value)) > 0) {
+    }
+}
+
+bool EventLoop::setNonBlocking(SOCKET_TYPE socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    if (flags == -1) return false;
+    return fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+#endif
@@ -0,0 +1,214 @@
+#include "api/HttpParser.h"
+#include <cctype>
+
+namespace {
+
+char lowerChar(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+bool containsIgnoreCase(std::string_view haystack, std::string_view needle) {
+    if (needle.size() > haystack.size()) return false;
+    for (size_t i = 0; i + needle.size() <= haystack.size(); i++) {
+        if (HttpParser::equalsIgnoreCase(haystack.substr(i, needle.size()), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+}
+
+HttpParser::HttpParser() {
+    reset();
+}
+
+void HttpParser::reset() {
+    data = std::string_view();
+    currentState = State::REQUEST_LINE;
+    lineStart = 0;
+    scanPos = 0;
+    methodSpan = Span();
+    pathSpan = Span();
+    protocolSpan = Span();
+    headers.clear();
+    bodyStart = 0;
+    contentLength = 0;
+    contentLengthSeen = false;
+    transferEncodingSeen = false;
+    connectionClose = false;
+    connectionKeepAlive = false;
+    errorCode = 0;
+    errorText = "";
+}
+
+bool HttpParser::equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (lowerChar(a[i]) != lowerChar(b[i])) return false;
+    }
+    return true;
+}
+
+HttpParser::State HttpParser::fail(int status, const char* message) {
+    currentState = State::ERROR;
+    errorCode = status;
+    errorText = message;
+    return currentState;
+}
+
+HttpParser::State HttpParser::parse(std::string_view buffer) {
+    data = buffer;
+
+    while (currentState == State::REQUEST_LINE || currentState == State::HEADERS) {
+        size_t lineEnd = data.find("\r\n", scanPos);
+
+        if (lineEnd == std::string_view::npos) {
+            if (data.size() > MAX_HEADERS_SIZE) {
+                return fail(400, "Request header too large");
+            }
+            // CR мог прийти последним байтом - следующий поиск начнем с него
+            scanPos = data.size() > lineStart ? data.size() - 1 : lineStart;
+            return currentState;
+        }
+
+        if (lineEnd > MAX_HEADERS_SIZE) {
+            return fail(400, "Request header too large");
+        }
+
+        if (currentState == State::REQUEST_LINE) {
+            // Пустые строки перед запросом допускаются (RFC 7230, 3.5)
+            if (lineEnd != lineStart) {
+                if (!parseRequestLine(lineEnd)) {
+                    return currentState;
+                }
+                currentState = State::HEADERS;
+            }
+        } else if (lineEnd == lineStart) {
+            // Тело chunked не разбирается; пропустив заголовок, мы приняли бы тело за следующий
+            // запрос соединения (request smuggling за прокси)
+            if (transferEncodingSeen) {
+                return contentLengthSeen ? fail(400, "Transfer-Encoding with Content-Length")
+                                         : fail(501, "Transfer-Encoding not supported");
+            }
+            bodyStart = lineEnd + 2;
+            currentState = State::BODY;
+        } else if (!parseHeaderLine(lineEnd)) {
+            return currentState;
+        }
+
+        lineStart = lineEnd + 2;
+        scanPos = lineStart;
+    }
+
+    if (currentState == State::BODY && data.size() - bodyStart >= contentLength) {
+        currentState = State::COMPLETE;
+    }
+
+    return currentState;
+}
+
+bool HttpParser::parseRequestLine(size_t lineEnd) {
+    Span* parts[] = {&methodSpan, &pathSpan, &protocolSpan};
+    size_t pos = lineStart;
+
+    for (Span* part : parts) {
+        while (pos < lineEnd && isBlank(data[pos])) pos++;
+        size_t start = pos;
+        while (pos < lineEnd && !isBlank(data[pos])) pos++;
+        part->offset = start;
+        part->length = pos - start;
+    }
+
+    if (methodSpan.length == 0) {
+        fail(400, "Invalid HTTP request");
+        return false;
+    }
+    return true;
+}
+
+bool HttpParser::parseHeaderLine(size_t lineEnd) {
+    std::string_view line = data.substr(lineStart, lineEnd - lineStart);
+    size_t colonPos = line.find(':');
+    if (colonPos == std::string_view::npos || colonPos == 0) {
+        // Некорректные строки заголовков пропускаем, как и раньше
+        return true;
+    }
+
+    for (size_t i = 0; i < colonPos; i++) {
+        char c = line[i];
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-') {
+            return true;
+        }
+    }
+
+    size_t valueStart = colonPos + 1;
+    size_t valueEnd = line.size();
+    while (valueStart < valueEnd && isBlank(line[valueStart])) valueStart++;
+    while (valueEnd > valueStart && isBlank(line[valueEnd - 1])) valueEnd--;
+
+    HeaderSpan header;
+    header.name = Span{lineStart, colonPos};
+    header.value = Span{lineStart + valueStart, valueEnd - valueStart};
+    headers.push_back(header);
+
+    std::string_view name = line.substr(0, colonPos);
+    std::string_view value = line.substr(valueStart, valueEnd - valueStart);
+
+    if (equalsIgnoreCase(name, "content-length")) {
+        if (value.empty()) {
+            fail(400, "Invalid Content-Length");
+            return false;
+        }
+        size_t length = 0;
+        for (char c : value) {
+            if (c < '0' || c > '9') {
+                fail(400, "Invalid Content-Length");
+                return false;
+            }
+            length = length * 10 + static_cast<size_t>(c - '0');
+            // Слишком большое тело отклоняем, не дожидаясь его получения
+            if (length > MAX_BODY_SIZE) {
+                fail(413, "Request body too large");
+                return false;
+            }
+        }
+        // Повтор с другим значением: прокси перед сервером мог выбрать другую длину,
+        // и граница между конвейерными запросами у нас с ним разойдется
+        if (contentLengthSeen && length != contentLength) {
+            fail(400, "Conflicting Content-Length");
+            return false;
+        }
+        contentLength = length;
+        contentLengthSeen = true;
+    } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+        // Решение - в конце заголовков, когда известно, был ли и Content-Length
+        transferEncodingSeen = true;
+    } else if (equalsIgnoreCase(name, "connection")) {
+        connectionClose = containsIgnoreCase(value, "close");
+        connectionKeepAlive = containsIgnoreCase(value, "keep-alive");
+    }
+
+    return true;
+}
+
+std::string_view HttpParser::header(std::string_view name) const {
+    for (const auto& entry : headers) {
+        if (equalsIgnoreCase(view(entry.name), name)) {
+            return view(entry.value);
+        }
+    }
+    return std::string_view();
+}
+
+bool HttpParser::keepAlive() const {
+    // HTTP/1.1 держит соединение по умолчанию, HTTP/1.0 - только по явной просьбе клиента
+    if (protocol() == "HTTP/1.1") {
+        return !connectionClose;
+    }
+    return connectionKeepAlive;
+}
@@ -0,0 +1,267 @@
+#include "api/IpFilter.h"
+#include <algorithm>
+
+namespace {
+
+// Счетчики плохих ответов ведутся не больше чем для стольких адресов
+const size_t MAX_TRACKED_STRIKES = 10000;
+
+uint32_t prefixMask(uint8_t length) {
+    return length == 0 ? 0 : ~0u << (32 - length);
+}
+
+int bitAt(uint32_t value, uint8_t index) {
+    return static_cast<int>((value >> (31 - index)) & 1u);
+}
+
+uint8_t commonLength(uint32_t a, uint8_t lengthA, uint32_t b, uint8_t lengthB) {
+    uint8_t limit = std::min(lengthA, lengthB);
+    uint32_t diff = a ^ b;
+    uint8_t common = 0;
+    while (common < limit && !(diff & (0x80000000u >> common))) {
+        common++;
+    }
+    return common;
+}
+
+}
+
+IpFilter::IpFilter() : table(std::make_shared<Table>()), activeBans(0) {}
+
+bool IpFilter::parseCidr(const std::string& text, uint32_t& prefix, uint8_t& length) {
+    size_t slash = text.find('/');
+    std::string address = text.substr(0, slash);
+
+    uint32_t value = 0;
+    int octets = 0;
+    int octet = -1;
+    for (char c : address) {
+        if (c >= '0' && c <= '9') {
+            octet = (octet < 0 ? 0 : octet * 10) + (c - '0');
+            if (octet > 255) return false;
+        } else if (c == '.' && octet >= 0 && octets < 3) {
+            value = (value << 8) | static_cast<uint32_t>(octet);
+            octets++;
+            octet = -1;
+        } else {
+            return false;
+        }
+    }
+    if (octets != 3 || octet < 0) return false;
+    value = (value << 8) | static_cast<uint32_t>(octet);
+
+    int bits = 32;
+    if (slash != std::string::npos) {
+        std::string suffix = text.substr(slash + 1);
+        if (suffix.empty() || suffix.size() > 2 ||
+            !std::all_of(suffix.begin(), suffix.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return false;
+        }
+        bits = std::stoi(suffix);
+        if (bits > 32) return false;
+    }
+
+    length = static_cast<uint8_t>(bits);
+    prefix = value & prefixMask(length);
+    return true;
+}
+
+void IpFilter::Table::insert(uint32_t prefix, uint8_t length, Action action) {
+    Node fresh;
+    fresh.prefix = prefix;
+    fresh.length = length;
+    fresh.action = action;
+
+    if (root < 0) {
+        nodes.push_back(fresh);
+        root = 0;
+        rules++;
+        return;
+    }
+
+    // Индексы вместо указателей: push_back может переместить вектор
+    int32_t* link = &root;
+    while (true) {
+        int32_t index = *link;
+        Node current = nodes[index];
+        uint8_t common = commonLength(current.prefix, current.length, prefix, length);
+
+        if (common == current.length && common == length) {
+            if (nodes[index].action == NONE) rules++;
+            nodes[index].action = action;
+            return;
+        }
+
+        if (common == current.length) {
+            // Текущий узел - предок новой записи, спускаемся дальше
+            int bit = bitAt(prefix, current.length);
+            if (nodes[index].children[bit] < 0) {
+                nodes.push_back(fresh);
+                nodes[index].children[bit] = static_cast<int32_t>(nodes.size() - 1);
+                rules++;
+                return;
+            }
+            link = &nodes[index].children[bit];
+            continue;
+        }
+
+        int32_t inserted;
+        if (common == length) {
+            // Новая запись - предок текущего узла
+            fresh.children[bitAt(current.prefix, length)] = index;
+            nodes.push_back(fresh);
+            inserted = static_cast<int32_t>(nodes.size() - 1);
+        } else {
+            // Расходятся внутри префикса - нужен узел-развилка без действия
+            Node branch;
+            branch.prefix = prefix & prefixMask(common);
+            branch.length = common;
+            nodes.push_back(fresh);
+            branch.children[bitAt(prefix, common)] = static_cast<int32_t>(nodes.size() - 1);
+            branch.children[bitAt(current.prefix, common)] = index;
+            nodes.push_back(branch);
+            inserted = static_cast<int32_t>(nodes.size() - 1);
+        }
+
+        // link мог указывать в старый буфер вектора - переходим к нему заново от корня
+        int32_t* relink = &root;
+        while (*relink != index) {
+            const Node& node = nodes[*relink];
+            relink = &nodes[*relink].children[bitAt(current.prefix, node.length)];
+        }
+        *relink = inserted;
+        rules++;
+        return;
+    }
+}
+
+IpFilter::Action IpFilter::Table::lookup(uint32_t address) const {
+    Action best = NONE;
+    int32_t index = root;
+    while (index >= 0) {
+        const Node& node = nodes[index];
+        if ((address ^ node.prefix) & prefixMask(node.length)) {
+            break;
+        }
+        if (node.action != NONE) {
+            best = node.action;
+        }
+        if (node.length == 32) {
+            break;
+        }
+        index = node.children[bitAt(address, node.length)];
+    }
+    return best;
+}
+
+void IpFilter::load(const std::vector<std::string>& blocked, const std::vector<std::string>& allowed,
+                    std::vector<std::string>& invalid) {
+    auto fresh = std::make_shared<Table>();
+    for (const auto& entry : blocked) {
+        uint32_t prefix;
+        uint8_t length;
+        if (parseCidr(entry, prefix, length)) {
+            fresh->insert(prefix, length, BLOCK);
+        } else {
+            invalid.push_back(entry);
+        }
+    }
+    // Разрешения вставляются вторыми: при одинаковом префиксе выигрывает разрешение
+    for (const auto& entry : allowed) {
+        uint32_t prefix;
+        uint8_t length;
+        if (parseCidr(entry, prefix, length)) {
+            fresh->insert(prefix, length, ALLOW);
+        } else {
+            invalid.push_back(entry);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    table = std::move(fresh);
+}
+
+void IpFilter::configureBans(int threshold, std::chrono::seconds window, std::chrono::seconds duration) {
+    std::lock_guard<std::mutex> lock(banMutex);
+    banThreshold = std::max(threshold, 0);
+    banWindow = window;
+    banDuration = duration;
+}
+
+bool IpFilter::isBlocked(uint32_t address) {
+    Action action;
+    {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        action = table->lookup(address);
+    }
+    if (action != NONE) {
+        return action == BLOCK;
+    }
+
+    if (activeBans.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(banMutex);
+    auto it = bans.find(address);
+    if (it == bans.end()) {
+        return false;
+    }
+    if (Clock::now() >= it->second) {
+        bans.erase(it);
+        activeBans.store(bans.size(), std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool IpFilter::recordStrike(uint32_t address) {
+    {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        if (table->lookup(address) == ALLOW) {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(banMutex);
+    if (banThreshold == 0 || bans.count(address) > 0) {
+        return false;
+    }
+
+    auto now = Clock::now();
+    auto it = strikes.find(address);
+    if (it == strikes.end()) {
+        if (strikes.size() >= MAX_TRACKED_STRIKES) {
+            return false;
+        }
+        it = strikes.emplace(address, Strike{0, now}).first;
+    } else if (now - it->second.windowStart > banWindow) {
+        it->second = Strike{0, now};
+    }
+
+    if (++it->second.count < banThreshold) {
+        return false;
+    }
+
+    strikes.erase(it);
+    bans[address] = now + banDuration;
+    activeBans.store(bans.size(), std::memory_order_relaxed);
+    return true;
+}
+
+void IpFilter::purgeExpired() {
+    std::lock_guard<std::mutex> lock(banMutex);
+    auto now = Clock::now();
+    for (auto it = bans.begin(); it != bans.end(); ) {
+        it = now >= it->second ? bans.erase(it) : std::next(it);
+    }
+    for (auto it = strikes.begin(); it != strikes.end(); ) {
+        it = now - it->second.windowStart > banWindow ? strikes.erase(it) : std::next(it);
+    }
+    activeBans.store(bans.size(), std::memory_order_relaxed);
+}
+
+size_t IpFilter::ruleCount() const {
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    return table->rules;
+}
@@ -0,0 +1,135 @@
+#include "api/RateLimiter.h"
+#include <algorithm>
+
+namespace {
+
+const size_t SHARD_COUNT = 64;
+// Сколько соседних слотов просматривается при поиске ключа; дальше ключ не ищется
+const size_t PROBE_LIMIT = 8;
+
+int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        RateLimiter::Clock::now().time_since_epoch()).count();
+}
+
+}
+
+RateLimiter::RateLimiter(size_t maxKeys) {
+    configure(maxKeys);
+}
+
+void RateLimiter::configure(size_t maxKeys) {
+    size_t total = SHARD_COUNT;
+    while (total < maxKeys) {
+        total <<= 1;
+    }
+
+    std::vector<std::unique_ptr<Shard>> fresh;
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        fresh.push_back(std::make_unique<Shard>());
+        fresh.back()->slots.resize(total / SHARD_COUNT);
+    }
+    shards.swap(fresh);
+    slotsPerShard = total / SHARD_COUNT;
+}
+
+uint64_t RateLimiter::hashKey(const std::string& key) {
+    // FNV-1a с перемешиванием в конце: младшие биты выбирают слот, старшие - сегмент
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash == 0 ? 1 : hash;
+}
+
+bool RateLimiter::isAllowed(const std::string& key, uint32_t limit, std::chrono::seconds window, uint32_t cost) {
+    if (limit == 0) {
+        return false;
+    }
+    int64_t windowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(window).count();
+    if (windowNs <= 0) {
+        return true;
+    }
+    int64_t interval = windowNs / limit;
+
+    uint64_t hash = hashKey(key);
+    Shard& shard = *shards[(hash >> 58) & (SHARD_COUNT - 1)];
+    size_t mask = slotsPerShard - 1;
+    size_t probes = std::min(PROBE_LIMIT, slotsPerShard);
+    int64_t now = nowNanoseconds();
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Slot* target = findSlot(shard, hash, mask, probes);
+    if (!target) {
+        Slot* reusable = nullptr;
+        Slot* victim = nullptr;
+        for (size_t i = 0; i < probes; i++) {
+            Slot& slot = shard.slots[(hash + i) & mask];
+            if (!reusable && (slot.key == 0 || slot.tat <= now)) {
+                reusable = &slot;
+            }
+            if (!victim || slot.tat < victim->tat) {
+                victim = &slot;
+            }
+        }
+        target = reusable ? reusable : victim;
+        target->key = hash;
+        target->tat = now;
+        target->pending = 0;
+    }
+
+    int64_t tat = std::max(target->tat, now) + interval * static_cast<int64_t>(cost);
+    if (tat - now > windowNs) {
+        return false;
+    }
+    target->tat = tat;
+    target->pending += interval * static_cast<int64_t>(cost);
+    return true;
+}
+
+RateLimiter::Slot* RateLimiter::findSlot(Shard& shard, uint64_t hash, size_t mask, size_t probes) {
+    for (size_t i = 0; i < probes; i++) {
+        Slot& slot = shard.slots[(hash + i) & mask];
+        if (slot.key == hash) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<RateLimitUsage> RateLimiter::takeUsage() {
+    std::vector<RateLimitUsage> usage;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto& slot : shard->slots) {
+            if (slot.key != 0 && slot.pending > 0) {
+                usage.push_back({static_cast<int64_t>(slot.key), slot.pending});
+                slot.pending = 0;
+            }
+        }
+    }
+    return usage;
+}
+
+void RateLimiter::mergeShared(const std::vector<RateLimitUsage>& shared) {
+    // Общие TAT в Unix-времени, локальные - в steady_clock; сдвиг между часами считаем один раз
+    int64_t offset = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - nowNanoseconds();
+    size_t mask = slotsPerShard - 1;
+    size_t probes = std::min(PROBE_LIMIT, slotsPerShard);
+
+    for (const auto& entry : shared) {
+        uint64_t hash = static_cast<uint64_t>(entry.key);
+        Shard& shard = *shards[(hash >> 58) & (SHARD_COUNT - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // Вытесненный за это время ключ не восстанавливаем: он был ближе всех к простою
+        Slot* slot = findSlot(shard, hash, mask, probes);
+        if (slot) {
+            slot->tat = std::max(slot->tat, entry.value - offset);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "api/RejectedTokenCache.h"
+
+namespace {
+
+// Настоящие токены - 64 шестнадцатеричных символа; длинный мусор не кэшируем,
+// чтобы размер кэша в байтах тоже оставался ограниченным
+const size_t MAX_CACHED_TOKEN_LENGTH = 128;
+
+}
+
+RejectedTokenCache::RejectedTokenCache(size_t capacity, std::chrono::seconds ttl)
+    : capacity(capacity), ttl(ttl) {}
+
+bool RejectedTokenCache::contains(const std::string& token) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(token);
+    if (it == index.end()) {
+        return false;
+    }
+
+    if (Clock::now() > it->second->expiresAt) {
+        order.erase(it->second);
+        index.erase(it);
+        return false;
+    }
+
+    order.splice(order.begin(), order, it->second);
+    return true;
+}
+
+void RejectedTokenCache::add(const std::string& token) {
+    if (token.empty() || token.size() > MAX_CACHED_TOKEN_LENGTH || capacity == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto expiresAt = Clock::now() + ttl;
+    auto it = index.find(token);
+    if (it != index.end()) {
+        it->second->expiresAt = expiresAt;
+        order.splice(order.begin(), order, it->second);
+        return;
+    }
+
+    if (order.size() >= capacity) {
+        index.erase(order.back().token);
+        order.pop_back();
+    }
+
+    order.push_front({token, expiresAt});
+    index[token] = order.begin();
+}
+
+void RejectedTokenCache::remove(const std::string& token) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(token);
+    if (it == index.end()) {
+        return;
+    }
+
+    order.erase(it->second);
+    index.erase(it);
+}
@@ -0,0 +1,228 @@
+#include "api/Router.h"
+#include <stdexcept>
+#include <climits>
+
+namespace {
+
+bool isDigits(std::string_view segment, int& value) {
+    if (segment.empty()) return false;
+    long long result = 0;
+    for (char c : segment) {
+        if (c < '0' || c > '9') return false;
+        result = result * 10 + (c - '0');
+        if (result > INT_MAX) return false;
+    }
+    value = static_cast<int>(result);
+    return true;
+}
+
+bool isHex(std::string_view segment) {
+    if (segment.empty()) return false;
+    for (char c : segment) {
+        bool hex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        if (!hex) return false;
+    }
+    return true;
+}
+
+}
+
+Router::Router() : root(std::make_unique<Node>()) {}
+
+Router::~Router() = default;
+
+unsigned Router::methodBit(std::string_view method) {
+    if (method == "GET") return METHOD_GET;
+    if (method == "POST") return METHOD_POST;
+    if (method == "PUT") return METHOD_PUT;
+    if (method == "DELETE") return METHOD_DELETE;
+    if (method == "OPTIONS") return METHOD_OPTIONS;
+    return 0;
+}
+
+size_t Router::methodIndex(unsigned bit) {
+    size_t index = 0;
+    while (bit > 1) {
+        bit >>= 1;
+        index++;
+    }
+    return index;
+}
+
+std::string Router::allowHeader(unsigned methods) {
+    static const char* const names[METHOD_COUNT] = {"GET", "POST", "PUT", "DELETE", "OPTIONS"};
+    std::string result;
+    for (size_t i = 0; i < METHOD_COUNT; i++) {
+        if (methods & (1u << i)) {
+            if (!result.empty()) result += ", ";
+            result += names[i];
+        }
+    }
+    return result;
+}
+
+Router::Node* Router::patternNode(std::string_view pattern, bool create) {
+    Node* node = root.get();
+    size_t pos = 0;
+    while (pos < pattern.size()) {
+        size_t segStart = pos + 1;
+        size_t segEnd = pattern.find('/', segStart);
+        if (segEnd == std::string_view::npos) segEnd = pattern.size();
+        std::string_view segment = pattern.substr(segStart, segEnd - segStart);
+
+        std::unique_ptr<Node>* next = nullptr;
+        if (segment == "{id}") {
+            next = &node->idChild;
+        } else if (segment == "{hex}") {
+            next = &node->hexChild;
+        } else if (segment == "{str}") {
+            next = &node->strChild;
+        } else if (segment == "{tail}") {
+            if (segEnd != pattern.size()) {
+                throw std::invalid_argument("{tail} must be the last segment: " + std::string(pattern));
+            }
+            next = &node->tailChild;
+        } else {
+            for (auto& child : node->staticChildren) {
+                if (child.first == segment) {
+                    next = &child.second;
+                    break;
+                }
+            }
+            if (!next) {
+                if (!create) return nullptr;
+                node->staticChildren.emplace_back(std::string(segment), nullptr);
+                next = &node->staticChildren.back().second;
+            }
+        }
+
+        if (!*next) {
+            if (!create) return nullptr;
+            *next = std::make_unique<Node>();
+        }
+        node = next->get();
+        pos = segEnd;
+    }
+    return node;
+}
+
+void Router::add(std::string_view method, std::string_view pattern, Handler handler, bool requiresAuth) {
+    unsigned bit = methodBit(method);
+    if (bit == 0 || pattern.empty() || pattern[0] != '/') {
+        throw std::invalid_argument("Invalid route: " + std::string(method) + " " + std::string(pattern));
+    }
+
+    Node* node = patternNode(pattern, true);
+    Route& route = node->routes[methodIndex(bit)];
+    route.handler = std::move(handler);
+    route.requiresAuth = requiresAuth;
+    node->methods |= bit;
+    if (!requiresAuth) {
+        node->publicMethods |= bit;
+    }
+}
+
+bool Router::setCost(std::string_view method, std::string_view pattern, uint32_t cost) {
+    unsigned bit = methodBit(method);
+    if (bit == 0 || pattern.empty() || pattern[0] != '/') {
+        return false;
+    }
+
+    Node* node = patternNode(pattern, false);
+    if (!node || !(node->methods & bit)) {
+        return false;
+    }
+    node->routes[methodIndex(bit)].cost = cost;
+    return true;
+}
+
+bool Router::setAsyncHandler(std::string_view method, std::string_view pattern, AsyncHandler handler) {
+    unsigned bit = methodBit(method);
+    if (bit == 0 || pattern.empty() || pattern[0] != '/') {
+        return false;
+    }
+
+    Node* node = patternNode(pattern, false);
+    if (!node || !(node->methods & bit)) {
+        return false;
+    }
+    node->routes[methodIndex(bit)].asyncHandler = std::move(handler);
+    return true;
+}
+
+Router::Match Router::match(std::string_view method, std::string_view path) const {
+    Match result;
+    unsigned bit = methodBit(method);
+    if (!path.empty() && path[0] == '/' && matchNode(*root, path, 0, bit, result)) {
+        result.result = Result::FOUND;
+    } else if (result.allowedMethods != 0) {
+        result.result = Result::METHOD_NOT_ALLOWED;
+    }
+    return result;
+}
+
+bool Router::matchLeaf(const Node& node, unsigned method, Match& match) const {
+    if (node.methods == 0) return false;
+
+    // Путь совпал - запоминаем методы для 405, даже если нужного метода здесь нет
+    match.allowedMethods |= node.methods;
+    match.publicMethods |= node.publicMethods;
+    if (!(node.methods & method)) return false;
+
+    match.route = &node.routes[methodIndex(method)];
+    return true;
+}
+
+bool Router::matchNode(const Node& node, std::string_view path, size_t pos, unsigned method, Match& match) const {
+    if (pos == path.size()) {
+        return matchLeaf(node, method, match);
+    }
+
+    size_t segStart = pos + 1;
+    size_t segEnd = path.find('/', segStart);
+    if (segEnd == std::string_view::npos) segEnd = path.size();
+    std::string_view segment = path.substr(segStart, segEnd - segStart);
+
+    for (const auto& child : node.staticChildren) {
+        if (child.first == segment && matchNode(*child.second, path, segEnd, method, match)) {
+            return true;
+        }
+    }
+
+    if (match.params.count >= RouteParams::MAX_PARAMS) {
+        return false;
+    }
+    size_t slot = match.params.count;
+
+    int id = 0;
+    if (node.idChild && isDigits(segment, id)) {
+        match.params.values[slot] = segment;
+        match.params.ids[slot] = id;
+        match.params.count = slot + 1;
+        if (matchNode(*node.idChild, path, segEnd, method, match)) return true;
+        match.params.count = slot;
+    }
+
+    if (node.hexChild && isHex(segment)) {
+        match.params.values[slot] = segment;
+        match.params.count = slot + 1;
+        if (matchNode(*node.hexChild, path, segEnd, method, match)) return true;
+        match.params.count = slot;
+    }
+
+    if (node.strChild && !segment.empty()) {
+        match.params.values[slot] = segment;
+        match.params.count = slot + 1;
+        if (matchNode(*node.strChild, path, segEnd, method, match)) return true;
+        match.params.count = slot;
+    }
+
+    if (node.tailChild && segStart < path.size()) {
+        match.params.values[slot] = path.substr(segStart);
+        match.params.count = slot + 1;
+        if (matchLeaf(*node.tailChild, method, match)) return true;
+        match.params.count = slot;
+    }
+
+    return false;
+}
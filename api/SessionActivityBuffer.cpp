@@ -0,0 +1,102 @@
+#include "api/SessionActivityBuffer.h"
+
+SessionActivityBuffer::SessionActivityBuffer()
+    : dirtyCount(0),
+      urgent(false),
+      lastFlush(Clock::now()),
+      flushInterval(5),
+      maxExpiryDrift(60) {}
+
+void SessionActivityBuffer::configure(std::chrono::seconds interval, std::chrono::seconds drift) {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushInterval = interval;
+    maxExpiryDrift = drift;
+}
+
+void SessionActivityBuffer::record(const std::string& token, Clock::time_point lastActivity, Clock::time_point expiresAt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto inserted = entries.try_emplace(token);
+    Entry& entry = inserted.first->second;
+    if (inserted.second) {
+        entry.persistedExpiresAt = expiresAt;
+    }
+
+    entry.lastActivity = lastActivity;
+    entry.expiresAt = expiresAt;
+    if (!entry.dirty) {
+        entry.dirty = true;
+        dirtyCount++;
+    }
+
+    if (expiresAt - entry.persistedExpiresAt > maxExpiryDrift) {
+        urgent = true;
+    }
+}
+
+void SessionActivityBuffer::forget(const std::string& token) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(token);
+    if (it == entries.end()) return;
+
+    if (it->second.dirty) {
+        dirtyCount--;
+    }
+    entries.erase(it);
+}
+
+bool SessionActivityBuffer::flushDue(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dirtyCount == 0) return false;
+    return urgent || now - lastFlush >= flushInterval;
+}
+
+std::vector<SessionActivity> SessionActivityBuffer::takePending(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<SessionActivity> batch;
+    batch.reserve(dirtyCount);
+
+    for (auto it = entries.begin(); it != entries.end(); ) {
+        Entry& entry = it->second;
+        if (entry.dirty) {
+            batch.push_back({it->first, entry.lastActivity, entry.expiresAt});
+            entry.previousPersistedExpiresAt = entry.persistedExpiresAt;
+            entry.persistedExpiresAt = entry.expiresAt;
+            entry.dirty = false;
+        } else if (now > entry.expiresAt) {
+            // Истекшие сессии больше не продлеваются - не держим их в памяти
+            it = entries.erase(it);
+            continue;
+        }
+        ++it;
+    }
+
+    dirtyCount = 0;
+    urgent = false;
+    lastFlush = now;
+    return batch;
+}
+
+void SessionActivityBuffer::restore(const std::vector<SessionActivity>& batch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& activity : batch) {
+        auto inserted = entries.try_emplace(activity.token);
+        Entry& entry = inserted.first->second;
+        if (inserted.second) {
+            entry.lastActivity = activity.lastActivity;
+            entry.expiresAt = activity.expiresAt;
+            entry.persistedExpiresAt = activity.expiresAt;
+        } else {
+            // В БД по-прежнему старый срок: расхождение считаем от него, иначе срочный
+            // сброс не сработает, пока БД недоступна
+            entry.persistedExpiresAt = entry.previousPersistedExpiresAt;
+            if (entry.expiresAt - entry.persistedExpiresAt > maxExpiryDrift) {
+                urgent = true;
+            }
+        }
+        // Более свежее продление, пришедшее после takePending, не перетираем
+        if (!entry.dirty) {
+            entry.dirty = true;
+            dirtyCount++;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#include "api/SessionGenerationTable.h"
+#include <cstdlib>
+#include <mutex>
+
+void SessionGenerationTable::replace(const std::vector<UserSessionGeneration>& entries) {
+    std::unordered_map<int, UserSessionGeneration> fresh;
+    fresh.reserve(entries.size());
+    for (const auto& entry : entries) {
+        fresh[entry.userId] = entry;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    generations.swap(fresh);
+}
+
+void SessionGenerationTable::publish(const UserSessionGeneration& entry) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    generations[entry.userId] = entry;
+}
+
+int SessionGenerationTable::generation(int userId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = generations.find(userId);
+    return it != generations.end() ? it->second.generation : 0;
+}
+
+bool SessionGenerationTable::isStale(const Session& session) const {
+    int userId = static_cast<int>(std::strtol(session.userId.c_str(), nullptr, 10));
+    return session.generation < generation(userId);
+}
+
+bool SessionGenerationTable::isStale(const SignedTokenClaims& claims) const {
+    // Время выдачи хранится с точностью до секунды, поэтому токен, выданный в ту же секунду,
+    // что и отзыв, тоже считается отозванным
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = generations.find(claims.userId);
+    return it != generations.end() && claims.issuedAt <= it->second.revokedAt;
+}
+
+SessionGenerationTable::Verdict SessionGenerationTable::recheck(const std::string& token, const Lookup& lookup,
+                                                                Session& stored) const {
+    stored = Session();
+    if (!lookup(token, stored)) {
+        return Verdict::UNKNOWN;
+    }
+    if (stored.token.empty() || isStale(stored)) {
+        return Verdict::REVOKED;
+    }
+    return Verdict::CURRENT;
+}
@@ -0,0 +1,486 @@
+#include "api/SessionStore.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Только строчные цифры: токен из кэша должен совпадать со строкой в БД один в один
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+uint32_t toUnixSeconds(std::chrono::system_clock::time_point tp) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch()).count();
+    return seconds < 0 ? 0 : static_cast<uint32_t>(seconds);
+}
+
+std::chrono::system_clock::time_point fromUnixSeconds(uint32_t seconds) {
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
+
+// Сервер слушает только IPv4, поэтому адрес клиента всегда помещается в 4 байта; 0 - неизвестен
+uint32_t packIpv4(const std::string& address) {
+    uint32_t packed = 0;
+    int octets = 0;
+    int value = -1;
+    for (char c : address) {
+        if (c >= '0' && c <= '9') {
+            value = (value < 0 ? 0 : value * 10) + (c - '0');
+            if (value > 255) return 0;
+        } else if (c == '.' && value >= 0 && octets < 3) {
+            packed = (packed << 8) | static_cast<uint32_t>(value);
+            octets++;
+            value = -1;
+        } else {
+            return 0;
+        }
+    }
+    if (octets != 3 || value < 0) return 0;
+    return (packed << 8) | static_cast<uint32_t>(value);
+}
+
+std::string formatIpv4(uint32_t packed) {
+    if (packed == 0) return "unknown";
+    return std::to_string(packed >> 24) + "." + std::to_string((packed >> 16) & 0xFF) + "." +
+           std::to_string((packed >> 8) & 0xFF) + "." + std::to_string(packed & 0xFF);
+}
+
+}
+
+size_t SessionStore::TokenKeyHash::operator()(const TokenKey& key) const {
+    uint64_t value;
+    std::memcpy(&value, key.data() + 24, sizeof(value));
+    return static_cast<size_t>(value);
+}
+
+SessionStore::StringPool::StringPool() {
+    // Нулевой номер - пустая строка
+    strings.emplace_back();
+    ids.emplace(strings.back(), 0);
+}
+
+uint32_t SessionStore::StringPool::intern(const std::string& value) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(value);
+        if (it != ids.end()) return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(value);
+    if (it != ids.end()) return it->second;
+
+    // deque не перемещает элементы при добавлении, поэтому string_view в ids остаются валидными
+    strings.push_back(value);
+    uint32_t id = static_cast<uint32_t>(strings.size() - 1);
+    ids.emplace(strings.back(), id);
+    return id;
+}
+
+std::string SessionStore::StringPool::get(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return id < strings.size() ? strings[id] : std::string();
+}
+
+std::vector<std::string> SessionStore::StringPool::copy() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return std::vector<std::string>(strings.begin(), strings.end());
+}
+
+void SessionStore::StringPool::reset(std::vector<std::string> values) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    ids.clear();
+    strings.clear();
+    if (values.empty()) {
+        values.emplace_back();
+    }
+    for (auto& value : values) {
+        strings.push_back(std::move(value));
+        ids.emplace(strings.back(), static_cast<uint32_t>(strings.size() - 1));
+    }
+}
+
+SessionStore::SessionStore(size_t shardCount) {
+    size_t count = 1;
+    while (count < shardCount) {
+        count <<= 1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+    shardMask = count - 1;
+}
+
+bool SessionStore::parseToken(const std::string& token, TokenKey& key) {
+    if (token.size() != key.size() * 2) {
+        return false;
+    }
+
+    for (size_t i = 0; i < key.size(); i++) {
+        int high = hexValue(token[i * 2]);
+        int low = hexValue(token[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        key[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+std::string SessionStore::formatToken(const TokenKey& key) {
+    std::string token;
+    token.reserve(key.size() * 2);
+    for (uint8_t byte : key) {
+        token.push_back(HEX_DIGITS[byte >> 4]);
+        token.push_back(HEX_DIGITS[byte & 0x0F]);
+    }
+    return token;
+}
+
+void SessionStore::indexUser(UserIndex& index, int32_t userId, const TokenKey& key) {
+    index[userId].push_back(key);
+}
+
+void SessionStore::unindexUser(UserIndex& index, int32_t userId, const TokenKey& key) {
+    auto it = index.find(userId);
+    if (it == index.end()) {
+        return;
+    }
+
+    auto& tokens = it->second;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (tokens[i] == key) {
+            tokens[i] = tokens.back();
+            tokens.pop_back();
+            break;
+        }
+    }
+    if (tokens.empty()) {
+        index.erase(it);
+    }
+}
+
+SessionStore::UserIndex SessionStore::buildUserIndex(const SessionMap& sessions) {
+    UserIndex index;
+    for (const auto& entry : sessions) {
+        indexUser(index, entry.second.userId, entry.first);
+    }
+    return index;
+}
+
+SessionStore::SessionMap::iterator SessionStore::eraseRecord(Shard& shard, SessionMap::iterator it) {
+    unindexUser(shard.byUser, it->second.userId, it->first);
+    return shard.sessions.erase(it);
+}
+
+size_t SessionStore::shardIndex(const TokenKey& key) const {
+    uint64_t value;
+    std::memcpy(&value, key.data() + 16, sizeof(value));
+    return static_cast<size_t>(value) & shardMask;
+}
+
+SessionStore::Shard& SessionStore::shardFor(const TokenKey& key) const {
+    return *shards[shardIndex(key)];
+}
+
+SessionStore::SessionRecord SessionStore::pack(const Session& session) {
+    static_assert(sizeof(SessionRecord) == 36, "SessionRecord должен оставаться 36-байтной записью без выравнивания");
+
+    SessionRecord record;
+    record.sessionId = session.sessionId;
+    record.userId = static_cast<int32_t>(std::strtol(session.userId.c_str(), nullptr, 10));
+    record.generation = session.generation;
+    record.ipv4 = packIpv4(session.ipAddress);
+    record.emailId = strings.intern(session.email);
+    record.userOSId = strings.intern(session.userOS);
+    record.createdAt = toUnixSeconds(session.createdAt);
+    record.lastActivity = toUnixSeconds(session.lastActivity);
+    record.expiresAt = toUnixSeconds(session.expiresAt);
+    return record;
+}
+
+Session SessionStore::unpack(const TokenKey& key, const SessionRecord& record) const {
+    Session session;
+    session.sessionId = record.sessionId;
+    session.token = formatToken(key);
+    session.userId = std::to_string(record.userId);
+    session.generation = record.generation;
+    session.email = strings.get(record.emailId);
+    session.createdAt = fromUnixSeconds(record.createdAt);
+    session.lastActivity = fromUnixSeconds(record.lastActivity);
+    session.expiresAt = fromUnixSeconds(record.expiresAt);
+    session.ipAddress = formatIpv4(record.ipv4);
+    session.userOS = strings.get(record.userOSId);
+    return session;
+}
+
+bool SessionStore::find(const std::string& token, Session& session) const {
+    TokenKey key;
+    if (!parseToken(token, key)) {
+        return false;
+    }
+
+    SessionRecord record;
+    {
+        Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(key);
+        if (it == shard.sessions.end()) {
+            return false;
+        }
+        record = it->second;
+    }
+    session = unpack(key, record);
+    return true;
+}
+
+std::vector<Session> SessionStore::findByUser(const std::string& userId) const {
+    char* end = nullptr;
+    long parsed = std::strtol(userId.c_str(), &end, 10);
+    if (userId.empty() || *end != '\0') {
+        return {};
+    }
+    int32_t id = static_cast<int32_t>(parsed);
+
+    std::vector<std::pair<TokenKey, SessionRecord>> found;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        auto indexed = shard->byUser.find(id);
+        if (indexed == shard->byUser.end()) {
+            continue;
+        }
+        for (const auto& key : indexed->second) {
+            auto it = shard->sessions.find(key);
+            if (it != shard->sessions.end()) {
+                found.emplace_back(key, it->second);
+            }
+        }
+    }
+
+    std::vector<Session> result;
+    result.reserve(found.size());
+    for (const auto& entry : found) {
+        result.push_back(unpack(entry.first, entry.second));
+    }
+    std::sort(result.begin(), result.end(), [](const Session& a, const Session& b) {
+        return a.createdAt < b.createdAt;
+    });
+    return result;
+}
+
+void SessionStore::put(const Session& session) {
+    TokenKey key;
+    if (!parseToken(session.token, key)) {
+        return;
+    }
+
+    SessionRecord record = pack(session);
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto inserted = shard.sessions.try_emplace(key, record);
+    if (inserted.second) {
+        indexUser(shard.byUser, record.userId, key);
+    } else {
+        if (inserted.first->second.userId != record.userId) {
+            unindexUser(shard.byUser, inserted.first->second.userId, key);
+            indexUser(shard.byUser, record.userId, key);
+        }
+        inserted.first->second = record;
+    }
+    shard.expiry.push({record.expiresAt, key});
+}
+
+bool SessionStore::erase(const std::string& token) {
+    TokenKey key;
+    if (!parseToken(token, key)) {
+        return false;
+    }
+
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(key);
+    if (it == shard.sessions.end()) {
+        return false;
+    }
+    eraseRecord(shard, it);
+    return true;
+}
+
+SessionStore::TouchResult SessionStore::touch(const std::string& token, Clock::time_point now,
+                                              Clock::time_point newExpires, Session& session) {
+    TokenKey key;
+    if (!parseToken(token, key)) {
+        return TouchResult::MISSING;
+    }
+
+    SessionRecord record;
+    {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(key);
+        if (it == shard.sessions.end()) {
+            return TouchResult::MISSING;
+        }
+
+        uint32_t nowSeconds = toUnixSeconds(now);
+        if (nowSeconds > it->second.expiresAt) {
+            eraseRecord(shard, it);
+            return TouchResult::EXPIRED;
+        }
+
+        it->second.lastActivity = nowSeconds;
+        it->second.expiresAt = toUnixSeconds(newExpires);
+        record = it->second;
+    }
+    session = unpack(key, record);
+    return TouchResult::UPDATED;
+}
+
+bool SessionStore::setGeneration(const std::string& token, int generation) {
+    TokenKey key;
+    if (!parseToken(token, key)) {
+        return false;
+    }
+
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(key);
+    if (it == shard.sessions.end()) {
+        return false;
+    }
+    it->second.generation = generation;
+    return true;
+}
+
+void SessionStore::replaceAll(const std::vector<Session>& sessions) {
+    std::vector<SessionMap> fresh(shards.size());
+    std::vector<std::vector<ExpiryEntry>> freshExpiry(shards.size());
+    for (const auto& session : sessions) {
+        TokenKey key;
+        if (!parseToken(session.token, key)) {
+            continue;
+        }
+        size_t index = shardIndex(key);
+        SessionRecord record = pack(session);
+        fresh[index][key] = record;
+        freshExpiry[index].push_back({record.expiresAt, key});
+    }
+
+    for (size_t i = 0; i < shards.size(); i++) {
+        // Куча строится за O(n) из готового вектора
+        decltype(Shard::expiry) expiry(std::greater<ExpiryEntry>(), std::move(freshExpiry[i]));
+        UserIndex byUser = buildUserIndex(fresh[i]);
+        std::unique_lock<std::shared_mutex> lock(shards[i]->mutex);
+        shards[i]->sessions.swap(fresh[i]);
+        shards[i]->byUser.swap(byUser);
+        std::swap(shards[i]->expiry, expiry);
+    }
+}
+
+std::vector<std::string> SessionStore::eraseIf(const std::function<bool(const Session&)>& predicate) {
+    std::vector<std::string> erased;
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        for (auto it = shard->sessions.begin(); it != shard->sessions.end(); ) {
+            if (predicate(unpack(it->first, it->second))) {
+                erased.push_back(formatToken(it->first));
+                it = eraseRecord(*shard, it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    return erased;
+}
+
+std::vector<std::string> SessionStore::eraseExpired(Clock::time_point now) {
+    uint32_t nowSeconds = toUnixSeconds(now);
+    std::vector<std::string> expired;
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        while (!shard->expiry.empty() && shard->expiry.top().expiresAt < nowSeconds) {
+            ExpiryEntry entry = shard->expiry.top();
+            shard->expiry.pop();
+
+            auto it = shard->sessions.find(entry.token);
+            if (it == shard->sessions.end()) {
+                continue;
+            }
+            if (nowSeconds > it->second.expiresAt) {
+                expired.push_back(formatToken(entry.token));
+                eraseRecord(*shard, it);
+            } else if (it->second.expiresAt != entry.expiresAt) {
+                // Сессию продлили - переставляем на актуальный срок
+                shard->expiry.push({it->second.expiresAt, entry.token});
+            }
+        }
+    }
+    return expired;
+}
+
+void SessionStore::merge(const std::vector<Session>& sessions) {
+    for (const auto& session : sessions) {
+        TokenKey key;
+        if (!parseToken(session.token, key)) {
+            continue;
+        }
+
+        SessionRecord record = pack(session);
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto inserted = shard.sessions.try_emplace(key, record);
+        if (inserted.second) {
+            indexUser(shard.byUser, record.userId, key);
+        } else {
+            SessionRecord& existing = inserted.first->second;
+            if (record.lastActivity > existing.lastActivity) existing.lastActivity = record.lastActivity;
+            if (record.generation > existing.generation) existing.generation = record.generation;
+            if (record.expiresAt <= existing.expiresAt) continue;
+            existing.expiresAt = record.expiresAt;
+        }
+        shard.expiry.push({inserted.first->second.expiresAt, key});
+    }
+}
+
+size_t SessionStore::retainOnly(const std::vector<std::string>& activeTokens, Clock::time_point createdSince) {
+    std::unordered_set<TokenKey, TokenKeyHash> active;
+    active.reserve(activeTokens.size());
+    for (const auto& token : activeTokens) {
+        TokenKey key;
+        if (parseToken(token, key)) {
+            active.insert(key);
+        }
+    }
+
+    uint32_t createdLimit = toUnixSeconds(createdSince);
+    size_t removed = 0;
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        for (auto it = shard->sessions.begin(); it != shard->sessions.end(); ) {
+            if (it->second.createdAt < createdLimit && active.count(it->first) == 0) {
+                it = eraseRecord(*shard, it);
+                removed++;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return removed;
+}
+
+size_t SessionStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        total += shard->sessions.size();
+    }
+    return total;
+}
@@ -0,0 +1,268 @@
+#include "api/SessionStore.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t SNAPSHOT_MAGIC = 0x53534645; // "EFSS" в little-endian
+// Версия 2: в записи сессии появилось поколение
+const uint32_t SNAPSHOT_VERSION = 2;
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t stringCount;
+    uint64_t recordCount;
+    uint64_t savedAt;
+    uint64_t payloadSize;
+    uint64_t checksum;
+};
+
+// FNV-1a: от снимка нужна защита от обрыва записи и порчи, а не от подделки
+class Fnv1a {
+public:
+    void update(const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+    uint64_t value() const { return hash; }
+
+private:
+    uint64_t hash = 14695981039346656037ULL;
+};
+
+// Отображение файла снимка в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                bytes = static_cast<const uint8_t*>(mapped);
+                length = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+#else
+        // На Windows снимок просто читается целиком
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return;
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        bytes = reinterpret_cast<const uint8_t*>(buffer.data());
+        length = buffer.size();
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (bytes) {
+            munmap(const_cast<uint8_t*>(bytes), length);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    std::string buffer;
+#endif
+};
+
+#ifndef _WIN32
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Переименование попадает на диск только вместе с каталогом
+void syncDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+}
+#endif
+
+}
+
+bool SessionStore::saveSnapshot(const std::string& path) const {
+    // Сначала записи, потом пул: пул только растет, поэтому все номера строк в записях в нем есть
+    std::vector<std::pair<TokenKey, SessionRecord>> records;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        records.insert(records.end(), shard->sessions.begin(), shard->sessions.end());
+    }
+    std::vector<std::string> pool = strings.copy();
+
+    std::string payload;
+    payload.reserve(records.size() * (sizeof(TokenKey) + sizeof(SessionRecord)));
+    for (const auto& entry : records) {
+        payload.append(reinterpret_cast<const char*>(entry.first.data()), entry.first.size());
+        payload.append(reinterpret_cast<const char*>(&entry.second), sizeof(SessionRecord));
+    }
+    for (const auto& value : pool) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        payload.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        payload.append(value);
+    }
+
+    Fnv1a checksum;
+    checksum.update(payload.data(), payload.size());
+
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.recordSize = sizeof(TokenKey) + sizeof(SessionRecord);
+    header.stringCount = static_cast<uint32_t>(pool.size());
+    header.recordCount = records.size();
+    header.savedAt = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        Clock::now().time_since_epoch()).count());
+    header.payloadSize = payload.size();
+    header.checksum = checksum.value();
+
+    std::string tempPath = path + ".tmp";
+#ifndef _WIN32
+    // В снимке токены сессий: файл доступен только владельцу процесса. Данные сбрасываются
+    // на диск до переименования, иначе после сбоя питания на месте снимка окажется пустой файл
+    // Права задаются только при создании: остаток прошлой неудачной записи удаляем
+    ::unlink(tempPath.c_str());
+    int fd = ::open(tempPath.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                   writeAll(fd, payload.data(), payload.size()) &&
+                   fsync(fd) == 0;
+    if (::close(fd) != 0 || !written) {
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    syncDirectory(path);
+    return true;
+#else
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+bool SessionStore::loadSnapshot(const std::string& path, Clock::time_point& savedAt) {
+    MappedFile file(path);
+    if (!file.data() || file.size() < sizeof(SnapshotHeader)) {
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+        header.recordSize != sizeof(TokenKey) + sizeof(SessionRecord) ||
+        header.payloadSize != file.size() - sizeof(SnapshotHeader) ||
+        header.recordCount > header.payloadSize / header.recordSize) {
+        return false;
+    }
+
+    const uint8_t* payload = file.data() + sizeof(SnapshotHeader);
+    Fnv1a checksum;
+    checksum.update(payload, header.payloadSize);
+    if (checksum.value() != header.checksum) {
+        return false;
+    }
+
+    // Пул строк лежит после записей
+    size_t offset = header.recordCount * header.recordSize;
+    std::vector<std::string> pool;
+    pool.reserve(header.stringCount);
+    for (uint32_t i = 0; i < header.stringCount; i++) {
+        uint32_t length;
+        if (offset + sizeof(length) > header.payloadSize) return false;
+        std::memcpy(&length, payload + offset, sizeof(length));
+        offset += sizeof(length);
+        if (offset + length > header.payloadSize) return false;
+        pool.emplace_back(reinterpret_cast<const char*>(payload + offset), length);
+        offset += length;
+    }
+
+    uint32_t nowSeconds = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        Clock::now().time_since_epoch()).count());
+    std::vector<SessionMap> fresh(shards.size());
+    std::vector<std::vector<ExpiryEntry>> freshExpiry(shards.size());
+    for (uint64_t i = 0; i < header.recordCount; i++) {
+        const uint8_t* entry = payload + i * header.recordSize;
+        TokenKey key;
+        SessionRecord record;
+        std::memcpy(key.data(), entry, key.size());
+        std::memcpy(&record, entry + key.size(), sizeof(record));
+        if (record.expiresAt < nowSeconds || record.emailId >= pool.size() || record.userOSId >= pool.size()) {
+            continue;
+        }
+
+        size_t index = shardIndex(key);
+        fresh[index].emplace(key, record);
+        freshExpiry[index].push_back({record.expiresAt, key});
+    }
+
+    strings.reset(std::move(pool));
+    for (size_t i = 0; i < shards.size(); i++) {
+        decltype(Shard::expiry) expiry(std::greater<ExpiryEntry>(), std::move(freshExpiry[i]));
+        UserIndex byUser = buildUserIndex(fresh[i]);
+        std::unique_lock<std::shared_mutex> lock(shards[i]->mutex);
+        shards[i]->sessions.swap(fresh[i]);
+        shards[i]->byUser.swap(byUser);
+        std::swap(shards[i]->expiry, expiry);
+    }
+
+    savedAt = Clock::time_point(std::chrono::seconds(header.savedAt));
+    return true;
+}
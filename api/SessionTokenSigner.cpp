@@ -0,0 +1,136 @@
+#include "api/SessionTokenSigner.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+namespace {
+
+const uint8_t TOKEN_VERSION = 0x01;
+const size_t TOKEN_BYTES = 32;
+const size_t PAYLOAD_BYTES = 16;
+const size_t MAC_BYTES = TOKEN_BYTES - PAYLOAD_BYTES;
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Только строчные цифры: кэш сессий и список отзыва сравнивают токен как строку,
+// и тот же токен в верхнем регистре прошел бы подпись, но не нашелся бы в них
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+void writeUint32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+uint32_t readUint32(const uint8_t* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+uint32_t toUnixSeconds(std::chrono::system_clock::time_point tp) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch()).count());
+}
+
+std::chrono::system_clock::time_point fromUnixSeconds(uint32_t seconds) {
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
+
+}
+
+SessionTokenSigner::SessionTokenSigner() {}
+
+void SessionTokenSigner::setKey(const std::string& secret) {
+    key.assign(secret.begin(), secret.end());
+}
+
+bool SessionTokenSigner::sign(const uint8_t* payload, size_t length, uint8_t* mac) const {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    if (!HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()), payload, length, digest, &digestLength) ||
+        digestLength < MAC_BYTES) {
+        return false;
+    }
+
+    for (size_t i = 0; i < MAC_BYTES; i++) {
+        mac[i] = digest[i];
+    }
+    return true;
+}
+
+std::string SessionTokenSigner::issue(int userId, std::chrono::system_clock::time_point issuedAt,
+                                      std::chrono::system_clock::time_point expiresAt) const {
+    if (!enabled()) {
+        return "";
+    }
+
+    uint8_t raw[TOKEN_BYTES];
+    raw[0] = TOKEN_VERSION;
+    writeUint32(raw + 1, static_cast<uint32_t>(userId));
+    writeUint32(raw + 5, toUnixSeconds(issuedAt));
+    writeUint32(raw + 9, toUnixSeconds(expiresAt));
+    if (RAND_bytes(raw + 13, 3) != 1) {
+        return "";
+    }
+    if (!sign(raw, PAYLOAD_BYTES, raw + PAYLOAD_BYTES)) {
+        return "";
+    }
+
+    std::string token;
+    token.reserve(TOKEN_BYTES * 2);
+    for (uint8_t byte : raw) {
+        token.push_back(HEX_DIGITS[byte >> 4]);
+        token.push_back(HEX_DIGITS[byte & 0x0F]);
+    }
+    return token;
+}
+
+bool SessionTokenSigner::verify(const std::string& token, SignedTokenClaims& claims) const {
+    if (!enabled() || token.size() != TOKEN_BYTES * 2) {
+        return false;
+    }
+
+    uint8_t raw[TOKEN_BYTES];
+    for (size_t i = 0; i < TOKEN_BYTES; i++) {
+        int high = hexValue(token[i * 2]);
+        int low = hexValue(token[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        raw[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+
+    // Случайные токены старого формата почти всегда отсекаются здесь, без HMAC
+    if (raw[0] != TOKEN_VERSION) {
+        return false;
+    }
+
+    uint8_t mac[MAC_BYTES];
+    if (!sign(raw, PAYLOAD_BYTES, mac) || CRYPTO_memcmp(mac, raw + PAYLOAD_BYTES, MAC_BYTES) != 0) {
+        return false;
+    }
+
+    claims.userId = static_cast<int>(readUint32(raw + 1));
+    claims.issuedAt = fromUnixSeconds(readUint32(raw + 5));
+    claims.expiresAt = fromUnixSeconds(readUint32(raw + 9));
+    return true;
+}
+
+std::string SessionTokenSigner::generateKey() {
+    uint8_t raw[32];
+    if (RAND_bytes(raw, sizeof(raw)) != 1) {
+        return "";
+    }
+
+    std::string generated;
+    for (uint8_t byte : raw) {
+        generated.push_back(HEX_DIGITS[byte >> 4]);
+        generated.push_back(HEX_DIGITS[byte & 0x0F]);
+    }
+    return generated;
+}
@@ -0,0 +1,98 @@
+#include "api/TlsContext.h"
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+namespace {
+
+const unsigned char SESSION_ID_CONTEXT[] = "StudentManagementSystem";
+
+std::string lastError() {
+    unsigned long code = ERR_get_error();
+    if (code == 0) {
+        return "неизвестная ошибка OpenSSL";
+    }
+    char buffer[256];
+    ERR_error_string_n(code, buffer, sizeof(buffer));
+    ERR_clear_error();
+    return buffer;
+}
+
+}
+
+void TlsSessionDeleter::operator()(SSL* ssl) const {
+    SSL_free(ssl);
+}
+
+TlsContext::TlsContext() : ctx(nullptr) {}
+
+TlsContext::~TlsContext() {
+    if (ctx) {
+        SSL_CTX_free(ctx);
+    }
+}
+
+bool TlsContext::load(const std::string& certPath, const std::string& keyPath,
+                      int sessionCacheSize, int sessionTimeoutSeconds, std::string& error) {
+    SSL_CTX* fresh = SSL_CTX_new(TLS_server_method());
+    if (!fresh) {
+        error = lastError();
+        return false;
+    }
+
+    SSL_CTX_set_min_proto_version(fresh, TLS1_2_VERSION);
+    if (SSL_CTX_use_certificate_chain_file(fresh, certPath.c_str()) != 1 ||
+        SSL_CTX_use_PrivateKey_file(fresh, keyPath.c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(fresh) != 1) {
+        error = lastError();
+        SSL_CTX_free(fresh);
+        return false;
+    }
+
+    // Ответ пишется кусками по мере готовности сокета, а outBuffer между попытками может дорасти
+    SSL_CTX_set_mode(fresh, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+#ifdef SSL_OP_NO_RENEGOTIATION
+    SSL_CTX_set_options(fresh, SSL_OP_NO_RENEGOTIATION);
+#endif
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+    // Клиенты часто рвут соединение без close_notify - это обычное закрытие, а не ошибка
+    SSL_CTX_set_options(fresh, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+
+    // Возобновление: серверный кэш по session ID и билеты (они не отключены SSL_OP_NO_TICKET)
+    SSL_CTX_set_session_id_context(fresh, SESSION_ID_CONTEXT, sizeof(SESSION_ID_CONTEXT) - 1);
+    SSL_CTX_set_session_cache_mode(fresh, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(fresh, sessionCacheSize > 0 ? sessionCacheSize : 1);
+    SSL_CTX_set_timeout(fresh, sessionTimeoutSeconds > 0 ? sessionTimeoutSeconds : 1);
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    // Клиенту, переиспользующему соединения, хватит одного билета вместо двух по умолчанию
+    SSL_CTX_set_num_tickets(fresh, 1);
+#endif
+
+    if (ctx) {
+        SSL_CTX_free(ctx);
+    }
+    ctx = fresh;
+    return true;
+}
+
+TlsSession TlsContext::createSession(SOCKET_TYPE socket) const {
+    if (!ctx) {
+        return TlsSession();
+    }
+    TlsSession session(SSL_new(ctx));
+    if (!session || SSL_set_fd(session.get(), static_cast<int>(socket)) != 1) {
+        ERR_clear_error();
+        return TlsSession();
+    }
+    SSL_set_accept_state(session.get());
+    return session;
+}
+
+bool TlsContext::looksLikeClientHello(const unsigned char* data, size_t length) {
+    // Запись: тип 0x16, версия 0x03 0x0X. Для решения хватает первого байта,
+    // второй проверяем, если он уже пришел
+    if (length == 0 || data[0] != 0x16) {
+        return false;
+    }
+    return length < 2 || data[1] == 0x03;
+}
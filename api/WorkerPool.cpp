@@ -0,0 +1,115 @@
+#include "api/WorkerPool.h"
+#include "logger/logger.h"
+
+WorkerPool::WorkerPool() : running(false), nextQueue(0), pendingTasks(0) {}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+void WorkerPool::start(size_t threadCount) {
+    if (running) return;
+
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 2;
+    }
+
+    queues.clear();
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    running = true;
+    for (size_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+
+    Logger::getInstance().log("🧵 Запущено рабочих потоков: " + std::to_string(threadCount));
+}
+
+void WorkerPool::stop() {
+    if (!running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    sleepCondition.notify_all();
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads.clear();
+    queues.clear();
+}
+
+void WorkerPool::submit(Task task) {
+    if (queues.empty()) {
+        // Пул не запущен - выполняем в вызывающем потоке
+        task();
+        return;
+    }
+
+    // Счетчик увеличиваем до публикации задачи, чтобы он не уходил в минус
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingTasks++;
+    }
+
+    size_t index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    sleepCondition.notify_one();
+}
+
+bool WorkerPool::popLocal(size_t index, Task& task) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkerPool::steal(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkerQueue& victim = *queues[(thief + offset) % queues.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) continue;
+
+        task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void WorkerPool::workerLoop(size_t index) {
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            pendingTasks--;
+            try {
+                task();
+            } catch (const std::exception& e) {
+                Logger::getInstance().log("💥 EXCEPTION в рабочем потоке: " + std::string(e.what()), "ERROR");
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (!running && pendingTasks == 0) {
+            return;
+        }
+        // Задача могла оказаться в очереди, которую не удалось захватить try_lock - проверяем периодически
+        sleepCondition.wait_for(lock, std::chrono::milliseconds(50), [this] {
+            return pendingTasks > 0 || !running;
+        });
+    }
+}
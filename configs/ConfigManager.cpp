@@ -26,6 +26,10 @@ bool ConfigManager::loadConfig(DatabaseConfig& config) {
         config.database = j.value("database", "student_db");
         config.username = j.value("username", "postgres");
         config.password = j.value("password", "password");
+        config.poolMinConnections = j.value("poolMinConnections", 2);
+        config.poolMaxConnections = j.value("poolMaxConnections", 16);
+        config.poolAcquireTimeoutMs = j.value("poolAcquireTimeoutMs", 5000);
+        config.asyncConnections = j.value("asyncConnections", 2);
         
         currentDbConfig = config;
         //std::cout << "Database config loaded successfully from " << dbConfigFile << std::endl;
@@ -46,6 +50,10 @@ bool ConfigManager::saveConfig(const DatabaseConfig& config) {
         j["database"] = config.database;
         j["username"] = config.username;
         j["password"] = config.password;
+        j["poolMinConnections"] = config.poolMinConnections;
+        j["poolMaxConnections"] = config.poolMaxConnections;
+        j["poolAcquireTimeoutMs"] = config.poolAcquireTimeoutMs;
+        j["asyncConnections"] = config.asyncConnections;
         
         std::ofstream file(dbConfigFile);
         file << j.dump(4);
@@ -89,8 +97,31 @@ bool ConfigManager::loadApiConfig(ApiConfig& config) {
         config.enableSSL = j.value("enableSSL", false);
         config.sslCertPath = j.value("sslCertPath", "");
         config.sslKeyPath = j.value("sslKeyPath", "");
-        config.rateLimitRequests = j.value("rateLimitRequests", 100);
-        config.rateLimitWindow = j.value("rateLimitWindow", 60);
+        config.sslSessionCacheSize = j.value("sslSessionCacheSize", 20480);
+        config.sslSessionTimeoutSeconds = j.value("sslSessionTimeoutSeconds", 7200);
+        config.rateLimitMaxKeys = j.value("rateLimitMaxKeys", 65536);
+        config.rateLimitAnonymousRequests = j.value("rateLimitAnonymousRequests", 60);
+        config.rateLimitAnonymousWindow = j.value("rateLimitAnonymousWindow", 60);
+        config.rateLimitUserRequests = j.value("rateLimitUserRequests", 600);
+        config.rateLimitUserWindow = j.value("rateLimitUserWindow", 60);
+        config.rateLimitRouteCosts = j.value("rateLimitRouteCosts", getDefaultApiConfig().rateLimitRouteCosts);
+        config.rateLimitMode = j.value("rateLimitMode", "local");
+        config.rateLimitSyncIntervalSeconds = j.value("rateLimitSyncIntervalSeconds", 1);
+        config.ipBlocklist = j.value("ipBlocklist", std::vector<std::string>{});
+        config.ipAllowlist = j.value("ipAllowlist", std::vector<std::string>{});
+        config.ipAutoBanThreshold = j.value("ipAutoBanThreshold", 20);
+        config.ipAutoBanWindowSeconds = j.value("ipAutoBanWindowSeconds", 60);
+        config.ipAutoBanDurationSeconds = j.value("ipAutoBanDurationSeconds", 900);
+        config.workerThreads = j.value("workerThreads", 0);
+        config.keepAliveTimeoutSeconds = j.value("keepAliveTimeoutSeconds", 5);
+        config.maxKeepAliveRequests = j.value("maxKeepAliveRequests", 100);
+        config.sessionFlushIntervalSeconds = j.value("sessionFlushIntervalSeconds", 5);
+        config.sessionMaxExpiryDriftSeconds = j.value("sessionMaxExpiryDriftSeconds", 60);
+        config.sessionTokenFormat = j.value("sessionTokenFormat", "random");
+        config.sessionSigningKey = j.value("sessionSigningKey", "");
+        config.sessionSnapshotPath = j.value("sessionSnapshotPath", "sessions.snapshot");
+        config.sessionSnapshotIntervalSeconds = j.value("sessionSnapshotIntervalSeconds", 60);
+        config.singleInstance = j.value("singleInstance", true);
         
         currentApiConfig = config;
         //std::cout << "API config loaded successfully from " << apiConfigFile << std::endl;
@@ -115,8 +146,31 @@ bool ConfigManager::saveApiConfig(const ApiConfig& config) {
         j["enableSSL"] = config.enableSSL;
         j["sslCertPath"] = config.sslCertPath;
         j["sslKeyPath"] = config.sslKeyPath;
-        j["rateLimitRequests"] = config.rateLimitRequests;
-        j["rateLimitWindow"] = config.rateLimitWindow;
+        j["sslSessionCacheSize"] = config.sslSessionCacheSize;
+        j["sslSessionTimeoutSeconds"] = config.sslSessionTimeoutSeconds;
+        j["rateLimitMaxKeys"] = config.rateLimitMaxKeys;
+        j["rateLimitAnonymousRequests"] = config.rateLimitAnonymousRequests;
+        j["rateLimitAnonymousWindow"] = config.rateLimitAnonymousWindow;
+        j["rateLimitUserRequests"] = config.rateLimitUserRequests;
+        j["rateLimitUserWindow"] = config.rateLimitUserWindow;
+        j["rateLimitRouteCosts"] = config.rateLimitRouteCosts;
+        j["rateLimitMode"] = config.rateLimitMode;
+        j["rateLimitSyncIntervalSeconds"] = config.rateLimitSyncIntervalSeconds;
+        j["ipBlocklist"] = config.ipBlocklist;
+        j["ipAllowlist"] = config.ipAllowlist;
+        j["ipAutoBanThreshold"] = config.ipAutoBanThreshold;
+        j["ipAutoBanWindowSeconds"] = config.ipAutoBanWindowSeconds;
+        j["ipAutoBanDurationSeconds"] = config.ipAutoBanDurationSeconds;
+        j["workerThreads"] = config.workerThreads;
+        j["keepAliveTimeoutSeconds"] = config.keepAliveTimeoutSeconds;
+        j["maxKeepAliveRequests"] = config.maxKeepAliveRequests;
+        j["sessionFlushIntervalSeconds"] = config.sessionFlushIntervalSeconds;
+        j["sessionMaxExpiryDriftSeconds"] = config.sessionMaxExpiryDriftSeconds;
+        j["sessionTokenFormat"] = config.sessionTokenFormat;
+        j["sessionSigningKey"] = config.sessionSigningKey;
+        j["sessionSnapshotPath"] = config.sessionSnapshotPath;
+        j["sessionSnapshotIntervalSeconds"] = config.sessionSnapshotIntervalSeconds;
+        j["singleInstance"] = config.singleInstance;
         
         std::ofstream file(apiConfigFile);
         file << j.dump(4);
@@ -143,6 +197,10 @@ DatabaseConfig ConfigManager::getDefaultDbConfig() {
     config.database = "student_db";
     config.username = "postgres";
     config.password = "password";
+    config.poolMinConnections = 2;
+    config.poolMaxConnections = 16;
+    config.poolAcquireTimeoutMs = 5000;
+    config.asyncConnections = 2;
     return config;
 }
 
@@ -158,7 +216,41 @@ ApiConfig ConfigManager::getDefaultApiConfig() {
     config.enableSSL = false;
     config.sslCertPath = "";
     config.sslKeyPath = "";
-    config.rateLimitRequests = 100;
-    config.rateLimitWindow = 60;
+    config.sslSessionCacheSize = 20480;
+    config.sslSessionTimeoutSeconds = 7200;
+    config.rateLimitMaxKeys = 65536;
+    config.rateLimitAnonymousRequests = 60;
+    config.rateLimitAnonymousWindow = 60;
+    config.rateLimitUserRequests = 600;
+    config.rateLimitUserWindow = 60;
+    // Вход и регистрация считают хэш пароля, списки отдают таблицы целиком
+    config.rateLimitRouteCosts = {
+        {"POST /login", 10},
+        {"POST /register", 10},
+        {"POST /change-password", 10},
+        {"GET /students", 5},
+        {"GET /teachers", 5},
+        {"GET /groups", 3},
+        {"GET /portfolio", 5},
+        {"GET /events", 3},
+        {"GET /dashboard", 3}
+    };
+    config.rateLimitMode = "local";
+    config.rateLimitSyncIntervalSeconds = 1;
+    config.ipBlocklist = {};
+    config.ipAllowlist = {};
+    config.ipAutoBanThreshold = 20;
+    config.ipAutoBanWindowSeconds = 60;
+    config.ipAutoBanDurationSeconds = 900;
+    config.workerThreads = 0;
+    config.keepAliveTimeoutSeconds = 5;
+    config.maxKeepAliveRequests = 100;
+    config.sessionFlushIntervalSeconds = 5;
+    config.sessionMaxExpiryDriftSeconds = 60;
+    config.sessionTokenFormat = "random";
+    config.sessionSigningKey = "";
+    config.sessionSnapshotPath = "sessions.snapshot";
+    config.sessionSnapshotIntervalSeconds = 60;
+    config.singleInstance = true;
     return config;
 }
\ No newline at end of file
@@ -0,0 +1,492 @@
+#include "database/AsyncDatabase.h"
+#include "logger/logger.h"
+#include <cstring>
+
+namespace {
+
+// Больше запросов на соединение не отправляем: остальные ждут в очереди сервиса,
+// чтобы буферы сокета и память под ответы не росли без предела
+const size_t MAX_QUERIES_PER_CONNECTION = 128;
+const std::chrono::seconds RECONNECT_DELAY(5);
+// Дольше ответа не ждем: соединение сбрасывается, запросы на нем завершаются ошибкой.
+// Без этого зависший запрос (блокировка, потерянный сервер) держит клиента бесконечно
+const std::chrono::seconds QUERY_TIMEOUT(30);
+
+// SQLSTATE: такой подготовленный запрос уже есть / такого запроса нет
+const char* DUPLICATE_PREPARED_STATEMENT = "42P05";
+const char* INVALID_SQL_STATEMENT_NAME = "26000";
+
+bool hasState(const PGresult* res, const char* state) {
+    const char* code = res ? PQresultErrorField(res, PG_DIAG_SQLSTATE) : nullptr;
+    return code && std::strcmp(code, state) == 0;
+}
+
+bool succeeded(const PGresult* res) {
+    ExecStatusType status = PQresultStatus(res);
+    return status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK;
+}
+
+}
+
+AsyncDatabase::AsyncDatabase()
+    : accepting(false), connectionCount(0), connectedCount(0), inFlightCount(0),
+      completedCount(0), failedCount(0) {}
+
+AsyncDatabase::~AsyncDatabase() {
+    close();
+}
+
+bool AsyncDatabase::open(const std::string& connectionInfo, size_t size, Reactor newReactor) {
+    close();
+#ifdef LIBPQ_HAS_PIPELINING
+    if (size == 0) {
+        return false;
+    }
+    reactor = std::move(newReactor);
+    connections.resize(size);
+    connectionCount = size;
+
+    size_t connected = 0;
+    for (auto& conn : connections) {
+        conn.connection = PQconnectdb(connectionInfo.c_str());
+        if (PQstatus(conn.connection) == CONNECTION_OK && enterAsyncMode(conn)) {
+            watch(conn);
+            connected++;
+        } else {
+            // Переподключится из process() так же, как после обрыва
+            conn.state = State::BROKEN;
+            conn.retryAt = std::chrono::steady_clock::now() + RECONNECT_DELAY;
+        }
+    }
+    connectedCount = connected;
+    if (connected == 0) {
+        Logger::getInstance().log("⚠️ Асинхронные соединения с БД не открылись: " +
+                                  std::string(PQerrorMessage(connections.front().connection)), "WARNING");
+    }
+
+    std::lock_guard<std::mutex> lock(incomingMutex);
+    accepting = true;
+    return connected > 0;
+#else
+    (void)connectionInfo;
+    (void)size;
+    (void)newReactor;
+    Logger::getInstance().log("⚠️ libpq собрана без режима конвейера - асинхронные запросы к БД отключены", "WARNING");
+    return false;
+#endif
+}
+
+void AsyncDatabase::close() {
+    std::vector<Request> pending;
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        accepting = false;
+        pending.swap(incoming);
+    }
+    for (auto& request : pending) {
+        backlog.push_back(std::move(request));
+    }
+
+    const std::string error = "асинхронные запросы к БД остановлены";
+    while (!backlog.empty()) {
+        Request request = std::move(backlog.front());
+        backlog.pop_front();
+        complete(request.callback, nullptr, error);
+    }
+    for (auto& conn : connections) {
+        for (auto& expected : conn.expected) {
+            if (expected.kind == Expected::Kind::QUERY) {
+                complete(expected.callback, nullptr, error);
+            }
+            PQclear(expected.result);
+        }
+        conn.expected.clear();
+        unwatch(conn);
+        PQfinish(conn.connection);
+    }
+
+    connections.clear();
+    sockets.clear();
+    reactor = Reactor();
+    connectionCount = 0;
+    connectedCount = 0;
+    inFlightCount = 0;
+}
+
+bool AsyncDatabase::isOpen() const {
+    std::lock_guard<std::mutex> lock(incomingMutex);
+    return accepting;
+}
+
+bool AsyncDatabase::submit(const PreparedStatement& statement, std::vector<std::string> params, Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        // Пока все соединения переподключаются, вызывающему быстрее выполнить запрос самому
+        if (!accepting || connectedCount.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+        incoming.push_back(Request{&statement, std::move(params), std::move(callback)});
+    }
+    reactor.notify();
+    return true;
+}
+
+bool AsyncDatabase::owns(int socket) const {
+    return sockets.count(socket) > 0;
+}
+
+void AsyncDatabase::handleEvent(int socket, bool readable, bool writable) {
+    auto it = sockets.find(socket);
+    if (it == sockets.end()) {
+        return;
+    }
+    Connection& conn = connections[it->second];
+
+    if (conn.state == State::RESETTING) {
+        continueReset(conn);
+        return;
+    }
+    if (conn.state != State::CONNECTED) {
+        return;
+    }
+    if (writable) {
+        flush(conn);
+    }
+    if (readable && conn.state == State::CONNECTED) {
+        readResults(conn);
+    }
+}
+
+void AsyncDatabase::process() {
+    std::vector<Request> fresh;
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        fresh.swap(incoming);
+    }
+    for (auto& request : fresh) {
+        backlog.push_back(std::move(request));
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    expireQueries(now);
+    for (auto& conn : connections) {
+        if (conn.state == State::BROKEN && now >= conn.retryAt) {
+            startReset(conn);
+        }
+    }
+
+    dispatchBacklog();
+}
+
+void AsyncDatabase::expireQueries(std::chrono::steady_clock::time_point now) {
+    for (auto& conn : connections) {
+        if (conn.state != State::CONNECTED) {
+            continue;
+        }
+        // Ответы приходят по порядку, поэтому дольше всех ждет первый запрос в очереди.
+        // Отменить один запрос в конвейере нельзя - сбрасываем соединение целиком
+        for (const auto& expected : conn.expected) {
+            if (expected.kind != Expected::Kind::QUERY) {
+                continue;
+            }
+            if (now - expected.sentAt >= QUERY_TIMEOUT) {
+                fail(conn, "таймаут запроса к БД (" + std::to_string(QUERY_TIMEOUT.count()) + " сек)");
+            }
+            break;
+        }
+    }
+}
+
+AsyncDatabase::Stats AsyncDatabase::stats() const {
+    Stats result;
+    result.connections = connectionCount.load(std::memory_order_relaxed);
+    result.connected = connectedCount.load(std::memory_order_relaxed);
+    result.inFlight = inFlightCount.load(std::memory_order_relaxed);
+    result.completed = completedCount.load(std::memory_order_relaxed);
+    result.failed = failedCount.load(std::memory_order_relaxed);
+    return result;
+}
+
+bool AsyncDatabase::enterAsyncMode(Connection& conn) {
+#ifdef LIBPQ_HAS_PIPELINING
+    if (PQsetnonblocking(conn.connection, 1) != 0) {
+        return false;
+    }
+    if (PQpipelineStatus(conn.connection) == PQ_PIPELINE_OFF && PQenterPipelineMode(conn.connection) != 1) {
+        return false;
+    }
+    conn.socket = PQsocket(conn.connection);
+    conn.state = State::CONNECTED;
+    // Новая серверная сессия: подготовленных запросов на ней еще нет
+    conn.prepared.clear();
+    return true;
+#else
+    (void)conn;
+    return false;
+#endif
+}
+
+void AsyncDatabase::watch(Connection& conn) {
+    if (conn.socket < 0) {
+        return;
+    }
+    sockets[conn.socket] = static_cast<size_t>(&conn - connections.data());
+    conn.writable = false;
+    reactor.add(conn.socket);
+}
+
+void AsyncDatabase::unwatch(Connection& conn) {
+    if (conn.socket < 0) {
+        return;
+    }
+    if (reactor.remove) {
+        reactor.remove(conn.socket);
+    }
+    sockets.erase(conn.socket);
+    conn.socket = -1;
+    conn.writable = false;
+}
+
+void AsyncDatabase::setWritable(Connection& conn, bool writable) {
+    if (conn.writable != writable && conn.socket >= 0) {
+        conn.writable = writable;
+        reactor.setWritable(conn.socket, writable);
+    }
+}
+
+bool AsyncDatabase::send(Connection& conn, Request& request) {
+#ifdef LIBPQ_HAS_PIPELINING
+    const PreparedStatement& statement = *request.statement;
+
+    // Подготовка идет отдельным отрезком конвейера: если запрос уже есть на сервере (42P05),
+    // это не прервет сам запрос
+    if (conn.prepared.count(&statement) == 0) {
+        if (PQsendPrepare(conn.connection, statement.name(), statement.sql(), 0, NULL) != 1 ||
+            PQpipelineSync(conn.connection) != 1) {
+            complete(request.callback, nullptr, PQerrorMessage(conn.connection));
+            return false;
+        }
+        conn.expected.push_back(Expected{Expected::Kind::PREPARE, &statement, nullptr, nullptr, {}});
+        conn.expected.push_back(Expected{Expected::Kind::SYNC, nullptr, nullptr, nullptr, {}});
+        conn.prepared.insert(&statement);
+    }
+
+    std::vector<const char*> params;
+    params.reserve(request.params.size());
+    for (const auto& param : request.params) {
+        params.push_back(param.c_str());
+    }
+    if (!StatementRegistry::instance().send(conn.connection, statement, static_cast<int>(params.size()),
+                                            params.data(), true)) {
+        complete(request.callback, nullptr, PQerrorMessage(conn.connection));
+        return false;
+    }
+    conn.expected.push_back(Expected{Expected::Kind::QUERY, &statement, std::move(request.callback), nullptr,
+                                     std::chrono::steady_clock::now()});
+    conn.queries++;
+    inFlightCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (PQpipelineSync(conn.connection) != 1) {
+        return false;
+    }
+    conn.expected.push_back(Expected{Expected::Kind::SYNC, nullptr, nullptr, nullptr, {}});
+    return true;
+#else
+    complete(request.callback, nullptr, "режим конвейера недоступен");
+    (void)conn;
+    return false;
+#endif
+}
+
+void AsyncDatabase::flush(Connection& conn) {
+    int result = PQflush(conn.connection);
+    if (result < 0) {
+        fail(conn, PQerrorMessage(conn.connection));
+        return;
+    }
+    // 1 - буфер сокета заполнен: допишем, когда сокет станет доступен для записи
+    setWritable(conn, result == 1);
+}
+
+void AsyncDatabase::readResults(Connection& conn) {
+#ifdef LIBPQ_HAS_PIPELINING
+    if (PQconsumeInput(conn.connection) != 1) {
+        fail(conn, PQerrorMessage(conn.connection));
+        return;
+    }
+
+    // PQgetResult блокирует, пока ответ не пришел целиком, поэтому сначала PQisBusy
+    while (!conn.expected.empty() && !PQisBusy(conn.connection)) {
+        PGresult* res = PQgetResult(conn.connection);
+        Expected& front = conn.expected.front();
+
+        if (front.kind == Expected::Kind::SYNC) {
+            bool synced = res && PQresultStatus(res) == PGRES_PIPELINE_SYNC;
+            PQclear(res);
+            if (!synced) {
+                fail(conn, "нарушен порядок ответов конвейера");
+                return;
+            }
+            conn.expected.pop_front();
+            continue;
+        }
+
+        if (res) {
+            // Результат запроса из одной команды один; остальное (если будет) не нужно
+            if (front.result) {
+                PQclear(res);
+            } else {
+                front.result = res;
+            }
+            continue;
+        }
+
+        // NULL - ответ на текущий запрос закончился
+        Expected done = std::move(front);
+        conn.expected.pop_front();
+
+        if (done.kind == Expected::Kind::PREPARE) {
+            if (done.result && !succeeded(done.result) && !hasState(done.result, DUPLICATE_PREPARED_STATEMENT)) {
+                conn.prepared.erase(done.statement);
+                // Запрос за ним получит "запрос не найден"; обработчику полезнее причина -
+                // ошибка подготовки (нет таблицы, ошибка в SQL)
+                for (auto& next : conn.expected) {
+                    if (next.kind == Expected::Kind::QUERY) {
+                        if (!next.result) {
+                            next.result = done.result;
+                            done.result = nullptr;
+                        }
+                        break;
+                    }
+                }
+            }
+            PQclear(done.result);
+            continue;
+        }
+
+        // Запрос пропал на сервере (DEALLOCATE, пулер перед БД) - в следующий раз готовим заново
+        if (hasState(done.result, INVALID_SQL_STATEMENT_NAME)) {
+            conn.prepared.erase(done.statement);
+        }
+        conn.queries--;
+        inFlightCount.fetch_sub(1, std::memory_order_relaxed);
+        complete(done.callback, done.result, done.result ? "" : PQerrorMessage(conn.connection));
+        PQclear(done.result);
+    }
+#else
+    (void)conn;
+#endif
+}
+
+void AsyncDatabase::complete(const Callback& callback, const PGresult* result, const std::string& error) {
+    bool ok = result && succeeded(result);
+    (ok ? completedCount : failedCount).fetch_add(1, std::memory_order_relaxed);
+    if (!callback) {
+        return;
+    }
+    try {
+        callback(result, result && !ok ? std::string(PQresultErrorMessage(result)) : error);
+    } catch (const std::exception& e) {
+        Logger::getInstance().log("💥 Исключение в обработчике асинхронного запроса: " + std::string(e.what()), "ERROR");
+    }
+}
+
+void AsyncDatabase::fail(Connection& conn, const std::string& error) {
+    if (conn.state == State::CONNECTED) {
+        connectedCount.fetch_sub(1, std::memory_order_relaxed);
+        Logger::getInstance().log("⚠️ Асинхронное соединение с БД потеряно: " + error, "WARNING");
+    }
+    conn.state = State::BROKEN;
+
+    // Обработчики могут сразу отправить новые запросы - к этому моменту очередь уже пуста
+    std::deque<Expected> pending;
+    pending.swap(conn.expected);
+    inFlightCount.fetch_sub(conn.queries, std::memory_order_relaxed);
+    conn.queries = 0;
+    unwatch(conn);
+
+    for (auto& expected : pending) {
+        if (expected.kind == Expected::Kind::QUERY) {
+            complete(expected.callback, nullptr, error);
+        }
+        PQclear(expected.result);
+    }
+    startReset(conn);
+}
+
+void AsyncDatabase::startReset(Connection& conn) {
+    unwatch(conn);
+    if (PQresetStart(conn.connection) != 1) {
+        conn.state = State::BROKEN;
+        conn.retryAt = std::chrono::steady_clock::now() + RECONNECT_DELAY;
+        return;
+    }
+    // Переподключение тоже неблокирующее: PQresetPoll вызывается по событиям сокета
+    conn.state = State::RESETTING;
+    conn.socket = PQsocket(conn.connection);
+    watch(conn);
+    setWritable(conn, true);
+}
+
+void AsyncDatabase::continueReset(Connection& conn) {
+    PostgresPollingStatusType status = PQresetPoll(conn.connection);
+
+    // При переборе адресов libpq может сменить сокет (и даже получить тот же номер,
+    // сняв старый с epoll при закрытии), поэтому сокет регистрируется заново на каждом шаге
+    unwatch(conn);
+    if (status == PGRES_POLLING_READING || status == PGRES_POLLING_WRITING) {
+        conn.socket = PQsocket(conn.connection);
+        watch(conn);
+        setWritable(conn, status == PGRES_POLLING_WRITING);
+        return;
+    }
+
+    if (status == PGRES_POLLING_OK && enterAsyncMode(conn)) {
+        watch(conn);
+        connectedCount.fetch_add(1, std::memory_order_relaxed);
+        Logger::getInstance().log("🔄 Асинхронное соединение с БД восстановлено");
+        return;
+    }
+    conn.state = State::BROKEN;
+    conn.retryAt = std::chrono::steady_clock::now() + RECONNECT_DELAY;
+}
+
+AsyncDatabase::Connection* AsyncDatabase::leastLoaded() {
+    Connection* best = nullptr;
+    for (auto& conn : connections) {
+        if (conn.state == State::CONNECTED && conn.queries < MAX_QUERIES_PER_CONNECTION &&
+            (!best || conn.queries < best->queries)) {
+            best = &conn;
+        }
+    }
+    return best;
+}
+
+void AsyncDatabase::dispatchBacklog() {
+    while (!backlog.empty()) {
+        Connection* conn = leastLoaded();
+        if (!conn) {
+            if (connectedCount.load(std::memory_order_relaxed) > 0) {
+                // Все соединения заняты - остальное уйдет по мере ответов
+                break;
+            }
+            Request request = std::move(backlog.front());
+            backlog.pop_front();
+            complete(request.callback, nullptr, "нет соединения с БД");
+            continue;
+        }
+
+        Request request = std::move(backlog.front());
+        backlog.pop_front();
+        if (!send(*conn, request)) {
+            fail(*conn, PQerrorMessage(conn->connection));
+        }
+    }
+
+    // Все отправленное уходит одним PQflush на соединение
+    for (auto& conn : connections) {
+        if (conn.state == State::CONNECTED) {
+            flush(conn);
+        }
+    }
+}
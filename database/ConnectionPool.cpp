@@ -0,0 +1,330 @@
+#include "database/ConnectionPool.h"
+#include <algorithm>
+
+namespace {
+
+// Соединение, простоявшее в пуле дольше, перед выдачей проверяется запросом к серверу:
+// PQstatus не знает о разрыве, пока по соединению ничего не отправлено
+const std::chrono::seconds IDLE_CHECK_AFTER(30);
+
+// Соединение, выданное текущему потоку; повторный acquire() в этом потоке вернет его же
+struct ThreadCheckout {
+    ConnectionPool* pool = nullptr;
+    PGconn* connection = nullptr;
+    uint64_t generation = 0;
+    int depth = 0;
+};
+
+thread_local ThreadCheckout currentCheckout;
+
+}
+
+PooledConnection::PooledConnection(ConnectionPool* pool, PGconn* connection, uint64_t generation)
+    : pool(pool), connection(connection), generation(generation) {}
+
+PooledConnection::PooledConnection(PooledConnection&& other) noexcept
+    : pool(other.pool), connection(other.connection), generation(other.generation) {
+    other.pool = nullptr;
+    other.connection = nullptr;
+}
+
+PooledConnection& PooledConnection::operator=(PooledConnection&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        connection = other.connection;
+        generation = other.generation;
+        other.pool = nullptr;
+        other.connection = nullptr;
+    }
+    return *this;
+}
+
+PooledConnection::~PooledConnection() {
+    release();
+}
+
+void PooledConnection::release() {
+    if (pool && connection) {
+        pool->release(connection, generation);
+    }
+    pool = nullptr;
+    connection = nullptr;
+}
+
+ConnectionPool::ConnectionPool()
+    : maxSize(1),
+      acquireTimeout(std::chrono::milliseconds(5000)),
+      openCount(0),
+      generation(0),
+      isConfigured(false) {}
+
+ConnectionPool::~ConnectionPool() {
+    close();
+}
+
+bool ConnectionPool::configure(const std::string& info, size_t minSize, size_t newMaxSize,
+                               std::chrono::milliseconds timeout) {
+    newMaxSize = std::max<size_t>(newMaxSize, 1);
+    minSize = std::min(minSize, newMaxSize);
+
+    std::vector<IdleConnection> stale;
+    uint64_t currentGeneration;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        stale.swap(idle);
+        openCount -= stale.size();
+        connectionInfo = info;
+        maxSize = newMaxSize;
+        acquireTimeout = timeout;
+        isConfigured = true;
+        currentGeneration = generation;
+    }
+    for (const auto& entry : stale) {
+        finish(entry.connection);
+    }
+    available.notify_all();
+
+    // Хотя бы одно соединение открываем и при minSize = 0: так configure() проверяет параметры
+    size_t warm = std::max<size_t>(minSize, 1);
+    size_t opened = 0;
+    for (size_t i = 0; i < warm; i++) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (generation != currentGeneration || openCount >= maxSize) {
+                break;
+            }
+            openCount++;
+        }
+        PGconn* connection = openConnection(info);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!connection) {
+            openCount--;
+            counters.connectFailures++;
+            break;
+        }
+        if (generation != currentGeneration) {
+            openCount--;
+            finish(connection);
+            break;
+        }
+        idle.push_back(IdleConnection{connection, std::chrono::steady_clock::now()});
+        opened++;
+        available.notify_one();
+    }
+    return opened > 0;
+}
+
+void ConnectionPool::setConnectionHooks(std::function<void(PGconn*)> onOpen,
+                                        std::function<void(PGconn*)> onClose) {
+    openHook = std::move(onOpen);
+    closeHook = std::move(onClose);
+}
+
+bool ConnectionPool::configured() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return isConfigured;
+}
+
+void ConnectionPool::resize(size_t newMaxSize, std::chrono::milliseconds timeout) {
+    std::vector<IdleConnection> surplus;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxSize = std::max<size_t>(newMaxSize, 1);
+        acquireTimeout = timeout;
+        while (openCount > maxSize && !idle.empty()) {
+            surplus.push_back(idle.front());
+            idle.erase(idle.begin());
+            openCount--;
+        }
+    }
+    for (const auto& entry : surplus) {
+        finish(entry.connection);
+    }
+    // При увеличении предела ожидающие потоки могут открыть новые соединения
+    available.notify_all();
+}
+
+void ConnectionPool::close() {
+    std::vector<IdleConnection> stale;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        isConfigured = false;
+        stale.swap(idle);
+        openCount -= stale.size();
+    }
+    for (const auto& entry : stale) {
+        finish(entry.connection);
+    }
+    available.notify_all();
+}
+
+PooledConnection ConnectionPool::acquire() {
+    if (currentCheckout.pool == this && currentCheckout.connection) {
+        currentCheckout.depth++;
+        return PooledConnection(this, currentCheckout.connection, currentCheckout.generation);
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!isConfigured) {
+        return PooledConnection();
+    }
+    auto deadline = started + acquireTimeout;
+    bool waited = false;
+
+    PGconn* connection = nullptr;
+    uint64_t connectionGeneration = generation;
+    while (!connection) {
+        if (!idle.empty()) {
+            IdleConnection entry = idle.back();
+            idle.pop_back();
+            connectionGeneration = generation;
+            lock.unlock();
+
+            if (!checkHealth(entry.connection, entry.returnedAt)) {
+                // Переподключиться не удалось - сервер, скорее всего, недоступен целиком
+                discard(entry.connection);
+                return PooledConnection();
+            }
+            connection = entry.connection;
+            break;
+        }
+
+        if (openCount < maxSize) {
+            openCount++;
+            std::string info = connectionInfo;
+            connectionGeneration = generation;
+            lock.unlock();
+
+            connection = openConnection(info);
+            if (!connection) {
+                lock.lock();
+                openCount--;
+                counters.connectFailures++;
+                lock.unlock();
+                available.notify_one();
+                return PooledConnection();
+            }
+            break;
+        }
+
+        waited = true;
+        if (available.wait_until(lock, deadline) == std::cv_status::timeout &&
+            idle.empty() && openCount >= maxSize) {
+            counters.timeouts++;
+            return PooledConnection();
+        }
+        if (!isConfigured) {
+            return PooledConnection();
+        }
+    }
+
+    recordWait(std::chrono::steady_clock::now() - started, waited);
+    currentCheckout = ThreadCheckout{this, connection, connectionGeneration, 1};
+    return PooledConnection(this, connection, connectionGeneration);
+}
+
+PGconn* ConnectionPool::openConnection(const std::string& info) {
+    PGconn* connection = PQconnectdb(info.c_str());
+    if (PQstatus(connection) != CONNECTION_OK) {
+        PQfinish(connection);
+        return nullptr;
+    }
+    if (openHook) {
+        openHook(connection);
+    }
+    return connection;
+}
+
+bool ConnectionPool::checkHealth(PGconn* connection, std::chrono::steady_clock::time_point returnedAt) {
+    if (PQstatus(connection) == CONNECTION_OK) {
+        if (std::chrono::steady_clock::now() - returnedAt < IDLE_CHECK_AFTER) {
+            return true;
+        }
+        // Пустой запрос - один обмен с сервером без разбора SQL
+        PGresult* res = PQexec(connection, "");
+        bool alive = PQresultStatus(res) == PGRES_EMPTY_QUERY;
+        PQclear(res);
+        if (alive) {
+            return true;
+        }
+    }
+
+    PQreset(connection);
+    if (PQstatus(connection) != CONNECTION_OK) {
+        return false;
+    }
+    // Новая серверная сессия - подготовленные на старой запросы потеряны
+    if (openHook) {
+        openHook(connection);
+    }
+    return true;
+}
+
+void ConnectionPool::discard(PGconn* connection) {
+    finish(connection);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        openCount--;
+        counters.connectFailures++;
+    }
+    available.notify_one();
+}
+
+void ConnectionPool::finish(PGconn* connection) {
+    if (closeHook) {
+        closeHook(connection);
+    }
+    PQfinish(connection);
+}
+
+void ConnectionPool::release(PGconn* connection, uint64_t connectionGeneration) {
+    if (currentCheckout.pool == this && currentCheckout.connection == connection) {
+        if (--currentCheckout.depth > 0) {
+            return;
+        }
+        currentCheckout = ThreadCheckout();
+    }
+
+    // Незавершенная транзакция или разрыв - такое соединение следующему потоку не отдаем
+    bool reusable = PQstatus(connection) == CONNECTION_OK &&
+                    PQtransactionStatus(connection) == PQTRANS_IDLE;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (reusable && isConfigured && connectionGeneration == generation) {
+            idle.push_back(IdleConnection{connection, std::chrono::steady_clock::now()});
+            connection = nullptr;
+        } else {
+            openCount--;
+        }
+    }
+    if (connection) {
+        finish(connection);
+    }
+    available.notify_one();
+}
+
+void ConnectionPool::recordWait(std::chrono::steady_clock::duration waitedFor, bool waitedForRelease) {
+    uint64_t micros = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(waitedFor).count());
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.checkouts++;
+    if (waitedForRelease) {
+        counters.waits++;
+    }
+    counters.totalWaitMicros += micros;
+    counters.maxWaitMicros = std::max(counters.maxWaitMicros, micros);
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = counters;
+    result.open = openCount;
+    result.idle = idle.size();
+    result.maxSize = maxSize;
+    return result;
+}
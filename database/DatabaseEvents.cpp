@@ -1,21 +1,57 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement GET_CATEGORY_NAME_BY_ID("get_category_name_by_id",
+    "SELECT category FROM event_categories WHERE event_code = $1");
+const PreparedStatement GET_EVENTS("get_events",
+    "SELECT e.id, e.event_id, e.event_decode, e.event_type, "
+    "e.start_date, e.end_date, e.location, e.lore, ec.category "
+    "FROM event e "
+    "LEFT JOIN event_categories ec ON e.event_decode = ec.event_code");
+const PreparedStatement ADD_EVENT("add_event",
+    "INSERT INTO event (event_id, event_type, start_date, end_date, location, lore) "
+    "VALUES ($1, $2, $3, $4, $5, $6) RETURNING id, event_decode");
+const PreparedStatement ADD_EVENT_CATEGORY("add_event_category",
+    "INSERT INTO event_categories (event_code, category) VALUES ($1, $2)");
+const PreparedStatement UPDATE_EVENT("update_event",
+    "UPDATE event SET event_type = $1, start_date = $2, end_date = $3, location = $4, lore = $5, event_id = $6 "
+    "WHERE id = $7");
+const PreparedStatement GET_EVENT_DECODE("get_event_decode", "SELECT event_decode FROM event WHERE id = $1");
+const PreparedStatement EVENT_CATEGORY_EXISTS("event_category_exists", "SELECT 1 FROM event_categories WHERE event_code = $1");
+const PreparedStatement UPDATE_EVENT_CATEGORY("update_event_category",
+    "UPDATE event_categories SET category = $1 WHERE event_code = $2");
+const PreparedStatement DELETE_EVENT_CATEGORY("delete_event_category", "DELETE FROM event_categories WHERE event_code = $1");
+const PreparedStatement DELETE_EVENT("delete_event", "DELETE FROM event WHERE id = $1");
+const PreparedStatement GET_EVENT_BY_ID("get_event_by_id", R"(
+    SELECT e.id, e.event_id, e.event_decode, e.event_type, 
+        e.start_date, e.end_date, e.location, e.lore,
+        ec.category
+    FROM event e
+    LEFT JOIN event_categories ec ON e.event_decode = ec.event_code
+    WHERE e.id = $1
+)");
+const PreparedStatement GET_EVENT_CATEGORIES("get_event_categories", "SELECT event_code, category FROM event_categories");
+const PreparedStatement GET_EVENT_CATEGORY_BY_CODE("get_event_category_by_code",
+    "SELECT event_code, category FROM event_categories WHERE event_code = $1");
+
+}
+
 // Event management
 std::string DatabaseService::getCategoryNameById(int categoryId) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return "";
     }
     
-    std::string sql = "SELECT category FROM event_categories WHERE event_code = $1";
     const char* params[1] = { std::to_string(categoryId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_CATEGORY_NAME_BY_ID.execute(connection, 1, params);
     
     std::string categoryName = "";
     
@@ -25,18 +61,13 @@ std::string DatabaseService::getCategoryNameById(int categoryId) {
 
 std::vector<Event> DatabaseService::getEvents() {
     std::vector<Event> events;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return events;
     }
     
-    std::string sql = "SELECT e.id, e.event_id, e.event_decode, e.event_type, "
-                      "e.start_date, e.end_date, e.location, e.lore, ec.category "
-                      "FROM event e "
-                      "LEFT JOIN event_categories ec ON e.event_decode = ec.event_code";
-    
-    PGresult* res = PQexec(connection, sql.c_str());
+    PGresult* res = GET_EVENTS.execute(connection);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
@@ -63,15 +94,12 @@ std::vector<Event> DatabaseService::getEvents() {
 }
 
 bool DatabaseService::addEvent(const Event& event) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
     // Правильные параметры для вставки
-    std::string sql = "INSERT INTO event (event_id, event_type, start_date, end_date, location, lore) "
-                      "VALUES ($1, $2, $3, $4, $5, $6) RETURNING id, event_decode";
     const char* params[6] = {
         std::to_string(event.measureCode).c_str(),
         event.eventType.c_str(),
@@ -81,7 +109,7 @@ bool DatabaseService::addEvent(const Event& event) {
         event.lore.c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 6, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_EVENT.execute(connection, 6, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Ошибка добавления события: " + std::string(PQerrorMessage(connection)), "ERROR");
@@ -94,13 +122,12 @@ bool DatabaseService::addEvent(const Event& event) {
     
     // Вставляем категорию, если указана (связываем с event_decode)
     if (!event.category.empty()) {
-        std::string categorySql = "INSERT INTO event_categories (event_code, category) VALUES ($1, $2)";
         const char* categoryParams[2] = {
             std::to_string(newEventDecode).c_str(),
             event.category.c_str()
         };
         
-        PGresult* categoryRes = PQexecParams(connection, categorySql.c_str(), 2, NULL, categoryParams, NULL, NULL, 0);
+        PGresult* categoryRes = ADD_EVENT_CATEGORY.execute(connection, 2, categoryParams);
         PQclear(categoryRes);
     }
     
@@ -108,14 +135,11 @@ bool DatabaseService::addEvent(const Event& event) {
 }
 
 bool DatabaseService::updateEvent(const Event& event) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "UPDATE event SET event_type = $1, start_date = $2, end_date = $3, location = $4, lore = $5, event_id = $6 "
-                      "WHERE id = $7";
     const char* params[7] = {
         event.eventType.c_str(),
         event.startDate.c_str(),
@@ -126,7 +150,7 @@ bool DatabaseService::updateEvent(const Event& event) {
         std::to_string(event.eventId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 7, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_EVENT.execute(connection, 7, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -135,9 +159,8 @@ bool DatabaseService::updateEvent(const Event& event) {
         return false;
     }
     
-    std::string decodeSql = "SELECT event_decode FROM event WHERE id = $1";
     const char* decodeParams[1] = { std::to_string(event.eventId).c_str() };
-    PGresult* decodeRes = PQexecParams(connection, decodeSql.c_str(), 1, NULL, decodeParams, NULL, NULL, 0);
+    PGresult* decodeRes = GET_EVENT_DECODE.execute(connection, 1, decodeParams);
     int eventDecode = 0;
     if (PQresultStatus(decodeRes) == PGRES_TUPLES_OK && PQntuples(decodeRes) > 0) {
         eventDecode = std::stoi(PQgetvalue(decodeRes, 0, 0));
@@ -150,38 +173,34 @@ bool DatabaseService::updateEvent(const Event& event) {
     }
     
     // Проверяем существование категории для данного event_decode
-    std::string checkSql = "SELECT 1 FROM event_categories WHERE event_code = $1";
     const char* checkParams[1] = { std::to_string(eventDecode).c_str() };
-    PGresult* checkRes = PQexecParams(connection, checkSql.c_str(), 1, NULL, checkParams, NULL, NULL, 0);
+    PGresult* checkRes = EVENT_CATEGORY_EXISTS.execute(connection, 1, checkParams);
     bool categoryExists = (PQresultStatus(checkRes) == PGRES_TUPLES_OK && PQntuples(checkRes) > 0);
     PQclear(checkRes);
     
     if (categoryExists) {
         // Категория существует - ОБНОВЛЯЕМ
         if (!event.category.empty()) {
-            std::string updateSql = "UPDATE event_categories SET category = $1 WHERE event_code = $2";
             const char* updateParams[2] = {
                 event.category.c_str(),
                 std::to_string(eventDecode).c_str()
             };
             
-            PGresult* updateRes = PQexecParams(connection, updateSql.c_str(), 2, NULL, updateParams, NULL, NULL, 0);
+            PGresult* updateRes = UPDATE_EVENT_CATEGORY.execute(connection, 2, updateParams);
             PQclear(updateRes);
         } else {
-            std::string deleteSql = "DELETE FROM event_categories WHERE event_code = $1";
             const char* deleteParams[1] = { std::to_string(eventDecode).c_str() };
-            PGresult* deleteRes = PQexecParams(connection, deleteSql.c_str(), 1, NULL, deleteParams, NULL, NULL, 0);
+            PGresult* deleteRes = DELETE_EVENT_CATEGORY.execute(connection, 1, deleteParams);
             PQclear(deleteRes);
         }
     } else {
         if (!event.category.empty()) {
-            std::string insertSql = "INSERT INTO event_categories (event_code, category) VALUES ($1, $2)";
             const char* insertParams[2] = {
                 std::to_string(eventDecode).c_str(),
                 event.category.c_str()
             };
             
-            PGresult* insertRes = PQexecParams(connection, insertSql.c_str(), 2, NULL, insertParams, NULL, NULL, 0);
+            PGresult* insertRes = ADD_EVENT_CATEGORY.execute(connection, 2, insertParams);
             PQclear(insertRes);
         }
     }
@@ -190,16 +209,14 @@ bool DatabaseService::updateEvent(const Event& event) {
 }
 
 bool DatabaseService::deleteEvent(int eventId) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "DELETE FROM event WHERE id = $1";
     const char* params[1] = { std::to_string(eventId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = DELETE_EVENT.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     PQclear(res);
@@ -208,24 +225,15 @@ bool DatabaseService::deleteEvent(int eventId) {
 
 Event DatabaseService::getEventById(int eventId) {
     Event event;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return event;
     }
     
-    std::string sql = R"(
-        SELECT e.id, e.event_id, e.event_decode, e.event_type, 
-            e.start_date, e.end_date, e.location, e.lore,
-            ec.category
-        FROM event e
-        LEFT JOIN event_categories ec ON e.event_decode = ec.event_code
-        WHERE e.id = $1
-    )";
-    
     const char* params[1] = { std::to_string(eventId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_EVENT_BY_ID.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return event;
@@ -248,14 +256,13 @@ Event DatabaseService::getEventById(int eventId) {
 // Event Category management
 std::vector<EventCategory> DatabaseService::getEventCategories() {
     std::vector<EventCategory> categories;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return categories;
     }
     
-    std::string sql = "SELECT event_code, category FROM event_categories";
-    PGresult* res = PQexec(connection, sql.c_str());
+    PGresult* res = GET_EVENT_CATEGORIES.execute(connection);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
@@ -293,19 +300,17 @@ std::vector<EventCategory> DatabaseService::getEventCategories() {
 }
 
 bool DatabaseService::addEventCategory(const EventCategory& category) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "INSERT INTO event_categories (event_code, category) VALUES ($1, $2)";
     const char* params[2] = {
         std::to_string(category.eventCode).c_str(),
         category.category.c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 2, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_EVENT_CATEGORY.execute(connection, 2, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     PQclear(res);
@@ -314,16 +319,15 @@ bool DatabaseService::addEventCategory(const EventCategory& category) {
 
 EventCategory DatabaseService::getEventCategoryByCode(int eventCode) {
     EventCategory category;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return category;
     }
     
-    std::string sql = "SELECT event_code, category FROM event_categories WHERE event_code = $1";
     const char* params[1] = { std::to_string(eventCode).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_EVENT_CATEGORY_BY_CODE.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return category;
@@ -337,19 +341,17 @@ EventCategory DatabaseService::getEventCategoryByCode(int eventCode) {
 }
 
 bool DatabaseService::updateEventCategory(const EventCategory& category) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "UPDATE event_categories SET category = $1 WHERE event_code = $2";
     const char* params[2] = {
         category.category.c_str(),
         std::to_string(category.eventCode).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 2, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_EVENT_CATEGORY.execute(connection, 2, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     if (!success) {
@@ -361,16 +363,14 @@ bool DatabaseService::updateEventCategory(const EventCategory& category) {
 }
 
 bool DatabaseService::deleteEventCategory(int eventCode) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "DELETE FROM event_categories WHERE event_code = $1";
     const char* params[1] = { std::to_string(eventCode).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = DELETE_EVENT_CATEGORY.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     if (!success) {
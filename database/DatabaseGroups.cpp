@@ -1,25 +1,45 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement UPDATE_GROUP_STUDENT_COUNT("update_group_student_count",
+    "UPDATE student_groups SET student_count = student_count + $1 WHERE group_id = $2");
+const PreparedStatement RESET_GROUP_STUDENT_COUNTS("reset_group_student_counts",
+    "UPDATE student_groups SET student_count = 0");
+const PreparedStatement RECALCULATE_GROUP_STUDENT_COUNTS("recalculate_group_student_counts",
+    "UPDATE student_groups g SET student_count = ("
+    "    SELECT COUNT(*) FROM students s WHERE s.group_id = g.group_id"
+    ")");
+const PreparedStatement GET_GROUPS("get_groups", "SELECT * FROM student_groups");
+const PreparedStatement ADD_GROUP("add_group",
+    "INSERT INTO student_groups (name, student_count, teacher_id) VALUES ($1, $2, $3)");
+const PreparedStatement UPDATE_GROUP("update_group",
+    "UPDATE student_groups SET name = $1, student_count = $2, teacher_id = $3 WHERE group_id = $4");
+const PreparedStatement DELETE_GROUP("delete_group", "DELETE FROM student_groups WHERE group_id = $1");
+const PreparedStatement GET_GROUP_BY_ID("get_group_by_id",
+    "SELECT group_id, name, student_count, teacher_id FROM student_groups WHERE group_id = $1");
+
+}
+
 // Group management
 bool DatabaseService::updateGroupStudentCount(int groupId, int change) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
     // ИСПРАВЛЕНО: заменили "groups" на "student_groups"
-    std::string sql = "UPDATE student_groups SET student_count = student_count + $1 WHERE group_id = $2";
     const char* params[2] = {
         std::to_string(change).c_str(),
         std::to_string(groupId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 2, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_GROUP_STUDENT_COUNT.execute(connection, 2, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     PQclear(res);
@@ -27,15 +47,13 @@ bool DatabaseService::updateGroupStudentCount(int groupId, int change) {
 }
 
 bool DatabaseService::recalculateAllGroupCounts() {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
     // ИСПРАВЛЕНО: заменили "groups" на "student_groups"
-    std::string resetSql = "UPDATE student_groups SET student_count = 0";
-    PGresult* resetRes = PQexec(connection, resetSql.c_str());
+    PGresult* resetRes = RESET_GROUP_STUDENT_COUNTS.execute(connection);
     bool resetSuccess = (PQresultStatus(resetRes) == PGRES_COMMAND_OK);
     PQclear(resetRes);
     
@@ -45,12 +63,8 @@ bool DatabaseService::recalculateAllGroupCounts() {
     }
     
     // ИСПРАВЛЕНО: заменили "groups" на "student_groups"
-    std::string updateSql = 
-        "UPDATE student_groups g SET student_count = ("
-        "    SELECT COUNT(*) FROM students s WHERE s.group_id = g.group_id"
-        ")";
     
-    PGresult* updateRes = PQexec(connection, updateSql.c_str());
+    PGresult* updateRes = RECALCULATE_GROUP_STUDENT_COUNTS.execute(connection);
     bool updateSuccess = (PQresultStatus(updateRes) == PGRES_COMMAND_OK);
     
     PQclear(updateRes);
@@ -60,11 +74,10 @@ bool DatabaseService::recalculateAllGroupCounts() {
 std::vector<StudentGroup> DatabaseService::getGroups() {
     std::vector<StudentGroup> groups;
     
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) return groups;
+    PooledConnection connection = acquireConnection();
+    if (!connection) return groups;
     
-    PGresult* res = PQexec(connection, "SELECT * FROM student_groups");
+    PGresult* res = GET_GROUPS.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
         return groups;
@@ -86,20 +99,18 @@ std::vector<StudentGroup> DatabaseService::getGroups() {
 }
 
 bool DatabaseService::addGroup(const StudentGroup& group) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "INSERT INTO student_groups (name, student_count, teacher_id) VALUES ($1, $2, $3)";
     const char* params[3] = {
         group.name.c_str(),
         std::to_string(group.studentCount).c_str(),
         std::to_string(group.teacherId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 3, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_GROUP.execute(connection, 3, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -107,13 +118,11 @@ bool DatabaseService::addGroup(const StudentGroup& group) {
 }
 
 bool DatabaseService::updateGroup(const StudentGroup& group) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "UPDATE student_groups SET name = $1, student_count = $2, teacher_id = $3 WHERE group_id = $4";
     const char* params[4] = {
         group.name.c_str(),
         std::to_string(group.studentCount).c_str(),
@@ -121,7 +130,7 @@ bool DatabaseService::updateGroup(const StudentGroup& group) {
         std::to_string(group.groupId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 4, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_GROUP.execute(connection, 4, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -129,16 +138,14 @@ bool DatabaseService::updateGroup(const StudentGroup& group) {
 }
 
 bool DatabaseService::deleteGroup(int groupId) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "DELETE FROM student_groups WHERE group_id = $1";
     const char* params[1] = { std::to_string(groupId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = DELETE_GROUP.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -147,16 +154,15 @@ bool DatabaseService::deleteGroup(int groupId) {
 
 StudentGroup DatabaseService::getGroupById(int groupId) {
     StudentGroup group;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return group;
     }
     
-    std::string sql = "SELECT group_id, name, student_count, teacher_id FROM student_groups WHERE group_id = $1";
     const char* params[1] = { std::to_string(groupId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_GROUP_BY_ID.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return group;
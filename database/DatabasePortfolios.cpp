@@ -1,28 +1,50 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement GET_PORTFOLIOS("get_portfolios", R"(
+    SELECT sp.portfolio_id, sp.student_code, sp.measure_code, sp.date, sp.decree,
+        s.last_name, s.first_name, s.middle_name
+    FROM student_portfolio sp
+    LEFT JOIN students s ON sp.student_code = s.student_code
+    ORDER BY sp.date DESC
+)");
+const PreparedStatement ADD_PORTFOLIO("add_portfolio", R"(
+    INSERT INTO student_portfolio 
+    (student_code, date, decree) 
+    VALUES ($1, $2, $3)
+)");
+const PreparedStatement UPDATE_PORTFOLIO("update_portfolio", R"(
+    UPDATE student_portfolio 
+    SET student_code = $1, date = $2, decree = $3
+    WHERE portfolio_id = $4
+)");
+const PreparedStatement DELETE_PORTFOLIO("delete_portfolio", "DELETE FROM student_portfolio WHERE portfolio_id = $1");
+const PreparedStatement GET_PORTFOLIO_BY_ID("get_portfolio_by_id", R"(
+    SELECT sp.portfolio_id, sp.student_code, sp.measure_code, sp.date, sp.decree,
+        s.last_name, s.first_name, s.middle_name
+    FROM student_portfolio sp
+    LEFT JOIN students s ON sp.student_code = s.student_code
+    WHERE sp.portfolio_id = $1
+)");
+
+}
+
 // Portfolio management
 std::vector<StudentPortfolio> DatabaseService::getPortfolios() {
     std::vector<StudentPortfolio> portfolios;
     
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return portfolios;
     }
     
-    std::string sql = R"(
-        SELECT sp.portfolio_id, sp.student_code, sp.measure_code, sp.date, sp.decree,
-            s.last_name, s.first_name, s.middle_name
-        FROM student_portfolio sp
-        LEFT JOIN students s ON sp.student_code = s.student_code
-        ORDER BY sp.date DESC
-    )";
-    
-    PGresult* res = PQexec(connection, sql.c_str());
+    PGresult* res = GET_PORTFOLIOS.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Ошибка выполнения запроса портфолио: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
@@ -52,26 +74,19 @@ std::vector<StudentPortfolio> DatabaseService::getPortfolios() {
 }
 
 bool DatabaseService::addPortfolio(const StudentPortfolio& portfolio) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
     
-    std::string sql = R"(
-        INSERT INTO student_portfolio 
-        (student_code, date, decree) 
-        VALUES ($1, $2, $3)
-    )";
-    
     const char* params[3] = {
         std::to_string(portfolio.studentCode).c_str(),
         portfolio.date.c_str(),
         std::to_string(portfolio.decree).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 3, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_PORTFOLIO.execute(connection, 3, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     if (!success) {
@@ -83,18 +98,11 @@ bool DatabaseService::addPortfolio(const StudentPortfolio& portfolio) {
 }
 
 bool DatabaseService::updatePortfolio(const StudentPortfolio& portfolio) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = R"(
-        UPDATE student_portfolio 
-        SET student_code = $1, date = $2, decree = $3
-        WHERE portfolio_id = $4
-    )";
-    
     const char* params[4] = {
         std::to_string(portfolio.studentCode).c_str(),
         portfolio.date.c_str(),
@@ -102,7 +110,7 @@ bool DatabaseService::updatePortfolio(const StudentPortfolio& portfolio) {
         std::to_string(portfolio.portfolioId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 4, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_PORTFOLIO.execute(connection, 4, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     if (!success) {
@@ -114,16 +122,14 @@ bool DatabaseService::updatePortfolio(const StudentPortfolio& portfolio) {
 }
 
 bool DatabaseService::deletePortfolio(int portfolioId) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "DELETE FROM student_portfolio WHERE portfolio_id = $1";
     const char* params[1] = { std::to_string(portfolioId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = DELETE_PORTFOLIO.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     if (!success) {
@@ -136,23 +142,15 @@ bool DatabaseService::deletePortfolio(int portfolioId) {
 
 StudentPortfolio DatabaseService::getPortfolioById(int portfolioId) {
     StudentPortfolio portfolio;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return portfolio;
     }
     
-    std::string sql = R"(
-        SELECT sp.portfolio_id, sp.student_code, sp.measure_code, sp.date, sp.decree,
-            s.last_name, s.first_name, s.middle_name
-        FROM student_portfolio sp
-        LEFT JOIN students s ON sp.student_code = s.student_code
-        WHERE sp.portfolio_id = $1
-    )";
-    
     const char* params[1] = { std::to_string(portfolioId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_PORTFOLIO_BY_ID.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return portfolio;
@@ -0,0 +1,88 @@
+#include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
+#include <libpq-fe.h>
+#include <chrono>
+#include "logger/logger.h"
+
+namespace {
+
+const PreparedStatement SYNC_RATE_LIMITS("sync_rate_limits",
+    "INSERT INTO rate_limits (key, tat) "
+    "SELECT u.key, $1::bigint + u.delta FROM unnest($2::bigint[], $3::bigint[]) AS u(key, delta) "
+    "ON CONFLICT (key) DO UPDATE SET tat = GREATEST(rate_limits.tat, $1::bigint) + (EXCLUDED.tat - $1::bigint) "
+    "RETURNING key, tat");
+const PreparedStatement DELETE_IDLE_RATE_LIMITS("delete_idle_rate_limits", "DELETE FROM rate_limits WHERE tat < $1::bigint");
+
+}
+
+namespace {
+
+int64_t unixNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
+
+// Rate limits shared between instances
+bool DatabaseService::syncRateLimits(const std::vector<RateLimitUsage>& usage, std::vector<RateLimitUsage>& shared) {
+    shared.clear();
+    if (usage.empty()) {
+        return true;
+    }
+
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    // Ключи и сдвиги передаются двумя параметрами-массивами, строки складываются одним запросом:
+    // общий TAT = max(TAT, сейчас) + сдвиг, как при локальной проверке
+    std::string keys = "{";
+    std::string deltas = "{";
+    for (size_t i = 0; i < usage.size(); i++) {
+        if (i > 0) {
+            keys += ",";
+            deltas += ",";
+        }
+        keys += std::to_string(usage[i].key);
+        deltas += std::to_string(usage[i].value);
+    }
+    keys += "}";
+    deltas += "}";
+
+    std::string now = std::to_string(unixNanoseconds());
+    const char* params[3] = { now.c_str(), keys.c_str(), deltas.c_str() };
+    PGresult* res = SYNC_RATE_LIMITS.execute(connection, 3, params);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        Logger::getInstance().log("❌ SQL error in syncRateLimits: " + std::string(PQerrorMessage(connection)), "ERROR");
+        PQclear(res);
+        return false;
+    }
+
+    int rows = PQntuples(res);
+    shared.reserve(rows);
+    for (int i = 0; i < rows; i++) {
+        RateLimitUsage entry;
+        entry.key = std::stoll(PQgetvalue(res, i, 0));
+        entry.value = std::stoll(PQgetvalue(res, i, 1));
+        shared.push_back(entry);
+    }
+    PQclear(res);
+    return true;
+}
+
+bool DatabaseService::deleteIdleRateLimits() {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    // Ключ с TAT в прошлом ничем не отличается от отсутствующего
+    std::string now = std::to_string(unixNanoseconds());
+    const char* params[1] = { now.c_str() };
+    PGresult* res = DELETE_IDLE_RATE_LIMITS.execute(connection, 1, params);
+    bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
+    PQclear(res);
+    return success;
+}
@@ -1,11 +1,60 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <algorithm>
 #include "logger/logger.h"
 
+namespace {
+
+// Поколение берется из users в том же запросе: кэш поколений на этом экземпляре может отставать
+const PreparedStatement ADD_SESSION("add_session",
+    "INSERT INTO sessions (token, user_id, created_at, last_activity, expires_at, ip_address, user_agent, generation) "
+    "VALUES ($1, $2, $3, $4, $5, $6, $7, "
+    "COALESCE((SELECT session_generation FROM users WHERE user_id = $2::integer), 0)) "
+    "RETURNING session_id, generation");
+const PreparedStatement GET_SESSION_BY_TOKEN("get_session_by_token",
+    "SELECT session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent, generation "
+    "FROM sessions WHERE token = $1");
+const PreparedStatement UPDATE_SESSION_LAST_ACTIVITY("update_session_last_activity",
+    "UPDATE sessions SET last_activity = $1, expires_at = $2 WHERE token = $3");
+const PreparedStatement DELETE_SESSION("delete_session", "DELETE FROM sessions WHERE token = $1");
+const PreparedStatement DELETE_SESSIONS("delete_sessions", "DELETE FROM sessions WHERE token = ANY($1::varchar[])");
+const PreparedStatement GET_SESSIONS_BY_USER_ID("get_sessions_by_user_id",
+    "SELECT session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent, generation "
+    "FROM sessions WHERE user_id = $1");
+const PreparedStatement GET_ALL_ACTIVE_SESSIONS("get_all_active_sessions",
+    "SELECT session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent, generation "
+    "FROM sessions WHERE expires_at > CURRENT_TIMESTAMP");
+const PreparedStatement GET_SESSIONS_CHANGED_SINCE("get_sessions_changed_since",
+    "SELECT session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent, generation "
+    "FROM sessions WHERE expires_at > CURRENT_TIMESTAMP AND (created_at >= $1 OR last_activity >= $1)");
+const PreparedStatement GET_ACTIVE_SESSION_TOKENS("get_active_session_tokens",
+    "SELECT token FROM sessions WHERE expires_at > CURRENT_TIMESTAMP");
+const PreparedStatement DELETE_EXPIRED_SESSIONS("delete_expired_sessions",
+    "DELETE FROM sessions WHERE expires_at < CURRENT_TIMESTAMP");
+const PreparedStatement ADD_REVOKED_TOKEN("add_revoked_token",
+    "INSERT INTO revoked_tokens (token, expires_at) VALUES ($1, $2) ON CONFLICT (token) DO NOTHING");
+const PreparedStatement GET_REVOKED_TOKENS("get_revoked_tokens",
+    "SELECT token FROM revoked_tokens WHERE expires_at > CURRENT_TIMESTAMP");
+const PreparedStatement DELETE_EXPIRED_REVOKED_TOKENS("delete_expired_revoked_tokens",
+    "DELETE FROM revoked_tokens WHERE expires_at < CURRENT_TIMESTAMP");
+const PreparedStatement BUMP_SESSION_GENERATION("bump_session_generation",
+    "UPDATE users SET session_generation = session_generation + 1, sessions_revoked_at = $2 "
+    "WHERE user_id = $1 RETURNING session_generation");
+const PreparedStatement UPDATE_SESSION_GENERATION("update_session_generation",
+    "UPDATE sessions SET generation = $1 WHERE token = $2");
+const PreparedStatement GET_SESSION_GENERATIONS("get_session_generations",
+    "SELECT user_id, session_generation, sessions_revoked_at FROM users WHERE session_generation > 0");
+const PreparedStatement DELETE_STALE_GENERATION_SESSIONS("delete_stale_generation_sessions",
+    "DELETE FROM sessions s USING users u "
+    "WHERE s.user_id = u.user_id AND s.generation < u.session_generation");
+
+}
+
 // Sessions management
 std::chrono::system_clock::time_point stringToTimestamp(const std::string& str) {
     std::tm tm = {};
@@ -22,14 +71,27 @@ std::string timestampToString(const std::chrono::system_clock::time_point& tp) {
     return ss.str();
 }
 
-bool DatabaseService::addSession(const Session& session) {
-    configManager.loadConfig(currentConfig);
-    if (!connection && !connect(currentConfig)) {
+// Строка выборки "session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent, generation"
+static Session readSessionRow(PGresult* res, int row) {
+    Session session;
+    session.sessionId = std::stoi(PQgetvalue(res, row, 0));
+    session.token = PQgetvalue(res, row, 1);
+    session.userId = PQgetvalue(res, row, 2);
+    session.createdAt = stringToTimestamp(PQgetvalue(res, row, 3));
+    session.lastActivity = stringToTimestamp(PQgetvalue(res, row, 4));
+    session.expiresAt = stringToTimestamp(PQgetvalue(res, row, 5));
+    session.ipAddress = PQgetvalue(res, row, 6);
+    session.userOS = PQgetvalue(res, row, 7);
+    session.generation = std::stoi(PQgetvalue(res, row, 8));
+    return session;
+}
+
+bool DatabaseService::addSession(Session& session) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
 
-    std::string sql = "INSERT INTO sessions (token, user_id, created_at, last_activity, expires_at, ip_address, user_agent) "
-    "VALUES ($1, $2, $3, $4, $5, $6, $7)";
     std::string created = timestampToString(session.createdAt);
     std::string last = timestampToString(session.lastActivity);
     std::string expires = timestampToString(session.expiresAt);
@@ -43,58 +105,57 @@ bool DatabaseService::addSession(const Session& session) {
     session.userOS.c_str()
     };
 
-    PGresult* res = PQexecParams(connection, sql.c_str(), 7, NULL, params, NULL, NULL, 0);
-    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+    PGresult* res = ADD_SESSION.execute(connection, 7, params);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         Logger::getInstance().log("❌ SQL error in addSession: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
         return false;
     }
+    session.sessionId = std::stoi(PQgetvalue(res, 0, 0));
+    session.generation = std::stoi(PQgetvalue(res, 0, 1));
     PQclear(res);
     return true;
     }
 
 Session DatabaseService::getSessionByToken(const std::string& token) {
     Session session;
-    configManager.loadConfig(currentConfig);
+    getSessionByToken(token, session);
+    return session;
+}
+
+bool DatabaseService::getSessionByToken(const std::string& token, Session& session) {
+    session = Session();
     
-    if (!connection && !connect(currentConfig)) {
-        return session;
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
     }
 
-    std::string sql = "SELECT session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent "
-    "FROM sessions WHERE token = $1";
     const char* params[1] = { token.c_str() };
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_SESSION_BY_TOKEN.execute(connection, 1, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        Logger::getInstance().log("❌ SQL error in getSessionByToken: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
-        return session;
+        return false;
     }
 
     if (PQntuples(res) == 0) {
         PQclear(res);
-        return session;
+        return true;
     }
     
-    session.sessionId = std::stoi(PQgetvalue(res, 0, 0));
-    session.token = PQgetvalue(res, 0, 1);
-    session.userId = PQgetvalue(res, 0, 2);
-    session.createdAt = stringToTimestamp(PQgetvalue(res, 0, 3));
-    session.lastActivity = stringToTimestamp(PQgetvalue(res, 0, 4));
-    session.expiresAt = stringToTimestamp(PQgetvalue(res, 0, 5));
-    session.ipAddress = PQgetvalue(res, 0, 6);
-    session.userOS = PQgetvalue(res, 0, 7);
+    session = readSessionRow(res, 0);
     
     PQclear(res);
-    return session;
+    return true;
 }
 
 bool DatabaseService::updateSessionLastActivity(const std::string& token, const std::chrono::system_clock::time_point& newLastActivity, const std::chrono::system_clock::time_point& newExpiresAt) {
-    configManager.loadConfig(currentConfig);
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
     return false;
     }
-    std::string sql = "UPDATE sessions SET last_activity = $1, expires_at = $2 WHERE token = $3";
     std::string last = timestampToString(newLastActivity);
     std::string expires = timestampToString(newExpiresAt);
     const char* params[3] = {
@@ -102,51 +163,114 @@ bool DatabaseService::updateSessionLastActivity(const std::string& token, const
     expires.c_str(),
     token.c_str()
     };
-    PGresult* res = PQexecParams(connection, sql.c_str(), 3, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_SESSION_LAST_ACTIVITY.execute(connection, 3, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     return success;
     }
 
+bool DatabaseService::updateSessionsLastActivity(const std::vector<SessionActivity>& activities) {
+    if (activities.empty()) {
+        return true;
+    }
+
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    // Ограничиваем размер одного запроса, чтобы не упереться в лимит параметров
+    const size_t maxRowsPerStatement = 500;
+    bool success = true;
+    for (size_t start = 0; start < activities.size(); start += maxRowsPerStatement) {
+        size_t end = std::min(activities.size(), start + maxRowsPerStatement);
+
+        std::string sql = "UPDATE sessions AS s SET last_activity = v.last_activity::timestamp, "
+        "expires_at = v.expires_at::timestamp FROM (VALUES ";
+        std::vector<std::string> values;
+        values.reserve((end - start) * 3);
+        for (size_t i = start; i < end; i++) {
+            size_t param = (i - start) * 3;
+            if (i != start) sql += ", ";
+            sql += "($" + std::to_string(param + 1) + ", $" + std::to_string(param + 2) +
+                   ", $" + std::to_string(param + 3) + ")";
+            values.push_back(activities[i].token);
+            values.push_back(timestampToString(activities[i].lastActivity));
+            values.push_back(timestampToString(activities[i].expiresAt));
+        }
+        sql += ") AS v(token, last_activity, expires_at) WHERE s.token = v.token";
+
+        std::vector<const char*> params;
+        params.reserve(values.size());
+        for (const auto& value : values) {
+            params.push_back(value.c_str());
+        }
+
+        PGresult* res = PQexecParams(connection, sql.c_str(), static_cast<int>(params.size()), NULL, params.data(), NULL, NULL, 0);
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            Logger::getInstance().log("❌ SQL error in updateSessionsLastActivity: " + std::string(PQerrorMessage(connection)), "ERROR");
+            success = false;
+        }
+        PQclear(res);
+    }
+    return success;
+}
+
 bool DatabaseService::deleteSession(const std::string& token) {
-    configManager.loadConfig(currentConfig);
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
-    std::string sql = "DELETE FROM sessions WHERE token = $1";
     const char* params[1] = { token.c_str() };
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = DELETE_SESSION.execute(connection, 1, params);
+    bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
+    PQclear(res);
+    return success;
+}
+
+bool DatabaseService::deleteSessions(const std::vector<std::string>& tokens) {
+    if (tokens.empty()) {
+        return true;
+    }
+
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    // Токены передаются одним параметром-массивом; они шестнадцатеричные, экранирование не нужно
+    std::string tokenArray = "{";
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (i > 0) tokenArray += ",";
+        tokenArray += tokens[i];
+    }
+    tokenArray += "}";
+
+    const char* params[1] = { tokenArray.c_str() };
+    PGresult* res = DELETE_SESSIONS.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
+    if (!success) {
+        Logger::getInstance().log("❌ SQL error in deleteSessions: " + std::string(PQerrorMessage(connection)), "ERROR");
+    }
     PQclear(res);
     return success;
 }
 
 std::vector<Session> DatabaseService::getSessionsByUserId(const std::string& userId) {
     std::vector<Session> sessionsList;
-    configManager.loadConfig(currentConfig);
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return sessionsList;
     }
-    std::string sql = "SELECT session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent "
-    "FROM sessions WHERE user_id = $1";
     const char* params[1] = { userId.c_str() };
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_SESSIONS_BY_USER_ID.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
         return sessionsList;
     }
     int rows = PQntuples(res);
     for (int i = 0; i < rows; i++) {
-        Session session;
-        session.sessionId = std::stoi(PQgetvalue(res, i, 0));
-        session.token = PQgetvalue(res, i, 1);
-        session.userId = PQgetvalue(res, i, 2);
-        session.createdAt = stringToTimestamp(PQgetvalue(res, i, 3));
-        session.lastActivity = stringToTimestamp(PQgetvalue(res, i, 4));
-        session.expiresAt = stringToTimestamp(PQgetvalue(res, i, 5));
-        session.ipAddress = PQgetvalue(res, i, 6);
-        session.userOS = PQgetvalue(res, i, 7);
-        sessionsList.push_back(session);
+        sessionsList.push_back(readSessionRow(res, i));
     }
     PQclear(res);
     return sessionsList;
@@ -154,14 +278,35 @@ std::vector<Session> DatabaseService::getSessionsByUserId(const std::string& use
     std::vector<Session> DatabaseService::getAllActiveSessions() {
     std::vector<Session> sessionsList;
 
-    configManager.loadConfig(currentConfig);
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return sessionsList;
+    }
+
+    PGresult* res = GET_ALL_ACTIVE_SESSIONS.execute(connection);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        PQclear(res);
+        return sessionsList;
+    }
+
+    int rows = PQntuples(res);
+    for (int i = 0; i < rows; i++) {
+        sessionsList.push_back(readSessionRow(res, i));
+    }
+    PQclear(res);
+    return sessionsList;
+}
+std::vector<Session> DatabaseService::getSessionsChangedSince(const std::chrono::system_clock::time_point& since) {
+    std::vector<Session> sessionsList;
+
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return sessionsList;
     }
 
-    std::string sql = "SELECT session_id, token, user_id, created_at, last_activity, expires_at, ip_address, user_agent "
-    "FROM sessions WHERE expires_at > CURRENT_TIMESTAMP";
-    PGresult* res = PQexec(connection, sql.c_str());
+    std::string sinceText = timestampToString(since);
+    const char* params[1] = { sinceText.c_str() };
+    PGresult* res = GET_SESSIONS_CHANGED_SINCE.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
         return sessionsList;
@@ -169,28 +314,174 @@ std::vector<Session> DatabaseService::getSessionsByUserId(const std::string& use
 
     int rows = PQntuples(res);
     for (int i = 0; i < rows; i++) {
-        Session session;
-        session.sessionId = std::stoi(PQgetvalue(res, i, 0));
-        session.token = PQgetvalue(res, i, 1);
-        session.userId = PQgetvalue(res, i, 2);
-        session.createdAt = stringToTimestamp(PQgetvalue(res, i, 3));
-        session.lastActivity = stringToTimestamp(PQgetvalue(res, i, 4));
-        session.expiresAt = stringToTimestamp(PQgetvalue(res, i, 5));
-        session.ipAddress = PQgetvalue(res, i, 6);
-        session.userOS = PQgetvalue(res, i, 7);
-        sessionsList.push_back(session);
+        sessionsList.push_back(readSessionRow(res, i));
     }
     PQclear(res);
     return sessionsList;
 }
+
+bool DatabaseService::getActiveSessionTokens(std::vector<std::string>& tokens) {
+    tokens.clear();
+
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    PGresult* res = GET_ACTIVE_SESSION_TOKENS.execute(connection);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        PQclear(res);
+        return false;
+    }
+
+    int rows = PQntuples(res);
+    tokens.reserve(rows);
+    for (int i = 0; i < rows; i++) {
+        tokens.push_back(PQgetvalue(res, i, 0));
+    }
+    PQclear(res);
+    return true;
+}
+
 bool DatabaseService::deleteExpiredSessions() {
-    configManager.loadConfig(currentConfig);
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    PGresult* res = DELETE_EXPIRED_SESSIONS.execute(connection);
+    bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
+    PQclear(res);
+    return success;
+}
+
+bool DatabaseService::addRevokedToken(const std::string& token, const std::chrono::system_clock::time_point& expiresAt) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    std::string expires = timestampToString(expiresAt);
+    const char* params[2] = { token.c_str(), expires.c_str() };
+    PGresult* res = ADD_REVOKED_TOKEN.execute(connection, 2, params);
+    bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
+    if (!success) {
+        Logger::getInstance().log("❌ SQL error in addRevokedToken: " + std::string(PQerrorMessage(connection)), "ERROR");
+    }
+    PQclear(res);
+    return success;
+}
+
+bool DatabaseService::getRevokedTokens(std::vector<std::string>& tokens) {
+    tokens.clear();
+
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    PGresult* res = GET_REVOKED_TOKENS.execute(connection);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        Logger::getInstance().log("❌ SQL error in getRevokedTokens: " + std::string(PQerrorMessage(connection)), "ERROR");
+        PQclear(res);
+        return false;
+    }
+
+    int rows = PQntuples(res);
+    tokens.reserve(rows);
+    for (int i = 0; i < rows; i++) {
+        tokens.push_back(PQgetvalue(res, i, 0));
+    }
+    PQclear(res);
+    return true;
+}
+
+bool DatabaseService::deleteExpiredRevokedTokens() {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    PGresult* res = DELETE_EXPIRED_REVOKED_TOKENS.execute(connection);
+    bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
+    PQclear(res);
+    return success;
+}
+
+bool DatabaseService::bumpSessionGeneration(int userId, const std::chrono::system_clock::time_point& revokedAt,
+                                            int& generation) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    std::string id = std::to_string(userId);
+    std::string revoked = timestampToString(revokedAt);
+    const char* params[2] = { id.c_str(), revoked.c_str() };
+    PGresult* res = BUMP_SESSION_GENERATION.execute(connection, 2, params);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
+        Logger::getInstance().log("❌ SQL error in bumpSessionGeneration: " + std::string(PQerrorMessage(connection)), "ERROR");
+        PQclear(res);
+        return false;
+    }
+
+    generation = std::stoi(PQgetvalue(res, 0, 0));
+    PQclear(res);
+    return true;
+}
+
+bool DatabaseService::updateSessionGeneration(const std::string& token, int generation) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    std::string value = std::to_string(generation);
+    const char* params[2] = { value.c_str(), token.c_str() };
+    PGresult* res = UPDATE_SESSION_GENERATION.execute(connection, 2, params);
+    bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
+    PQclear(res);
+    return success;
+}
+
+bool DatabaseService::getSessionGenerations(std::vector<UserSessionGeneration>& generations) {
+    generations.clear();
+
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
+        return false;
+    }
+
+    // Пользователи, ни разу не отзывавшие сессии, имеют поколение 0 и в таблицу не попадают
+    PGresult* res = GET_SESSION_GENERATIONS.execute(connection);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        Logger::getInstance().log("❌ SQL error in getSessionGenerations: " + std::string(PQerrorMessage(connection)), "ERROR");
+        PQclear(res);
+        return false;
+    }
+
+    int rows = PQntuples(res);
+    generations.reserve(rows);
+    for (int i = 0; i < rows; i++) {
+        UserSessionGeneration entry;
+        entry.userId = std::stoi(PQgetvalue(res, i, 0));
+        entry.generation = std::stoi(PQgetvalue(res, i, 1));
+        if (!PQgetisnull(res, i, 2)) {
+            entry.revokedAt = stringToTimestamp(PQgetvalue(res, i, 2));
+        }
+        generations.push_back(entry);
+    }
+    PQclear(res);
+    return true;
+}
+
+bool DatabaseService::deleteStaleGenerationSessions() {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
 
-    std::string sql = "DELETE FROM sessions WHERE expires_at < CURRENT_TIMESTAMP";
-    PGresult* res = PQexec(connection, sql.c_str());
+    PGresult* res = DELETE_STALE_GENERATION_SESSIONS.execute(connection);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     return success;
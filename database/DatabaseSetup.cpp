@@ -1,11 +1,40 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include "logger/logger.h"
+
+namespace {
+
+std::string connectionString(const DatabaseConfig& config) {
+    return "host=" + config.host +
+           " port=" + std::to_string(config.port) +
+           " dbname=" + config.database +
+           " user=" + config.username +
+           " password=" + config.password;
+}
+
+}
 
 // Database Setup
-DatabaseService::DatabaseService() : connection(nullptr) {
-    configManager.loadConfig(currentConfig);
+DatabaseService::DatabaseService() {
+    DatabaseConfig config;
+    configManager.loadConfig(config);
+    currentConfig = std::make_shared<const DatabaseConfig>(config);
+    configFileTime = configModificationTime();
+
+    // Каждое соединение пула сразу готовит все запросы реестра
+    pool.setConnectionHooks(
+        [](PGconn* connection) {
+            size_t failed = StatementRegistry::instance().prepareAll(connection);
+            if (failed > 0) {
+                Logger::getInstance().log("⚠️ Не удалось заранее подготовить запросов: " + std::to_string(failed) +
+                                          " - они будут подготовлены при первом вызове", "WARNING");
+            }
+        },
+        [](PGconn* connection) { StatementRegistry::instance().forget(connection); });
 }
 
 DatabaseService::~DatabaseService() {
@@ -13,48 +42,114 @@ DatabaseService::~DatabaseService() {
 }
 
 bool DatabaseService::connect(const DatabaseConfig& config) {
-    if (connection) {
-        disconnect();
-    }
-    
-    currentConfig = config;
-    std::string connStr = "host=" + config.host + 
-                         " port=" + std::to_string(config.port) + 
-                         " dbname=" + config.database + 
-                         " user=" + config.username + 
-                         " password=" + config.password;
-    
-    connection = PQconnectdb(connStr.c_str());
-    
-    if (PQstatus(connection) != CONNECTION_OK) {
-        PQfinish(connection);
-        connection = nullptr;
+    publishConfig(config);
+    return pool.configure(connectionString(config), static_cast<size_t>(std::max(config.poolMinConnections, 0)),
+                          static_cast<size_t>(std::max(config.poolMaxConnections, 1)),
+                          std::chrono::milliseconds(std::max(config.poolAcquireTimeoutMs, 0)));
+}
+
+void DatabaseService::disconnect() {
+    pool.close();
+}
+
+bool DatabaseService::testConnection() {
+    PooledConnection connection = acquireConnection();
+    return connection && PQstatus(connection) == CONNECTION_OK;
+}
+
+bool DatabaseService::executeBatch(QueryBatch& batch) {
+    PooledConnection connection = acquireConnection();
+    return batch.run(connection);
+}
+
+bool DatabaseService::openAsync(AsyncDatabase::Reactor reactor) {
+    std::shared_ptr<const DatabaseConfig> config = configSnapshot();
+    if (config->asyncConnections <= 0) {
         return false;
     }
-    
-    return true;
+    return asyncDatabase.open(connectionString(*config), static_cast<size_t>(config->asyncConnections),
+                              std::move(reactor));
 }
 
-void DatabaseService::disconnect() {
-    if (connection) {
-        PQfinish(connection);
-        connection = nullptr;
+DatabaseConfig DatabaseService::getCurrentConfig() const {
+    return *configSnapshot();
+}
+
+std::shared_ptr<const DatabaseConfig> DatabaseService::configSnapshot() const {
+    std::lock_guard<std::mutex> lock(configMutex);
+    return currentConfig;
+}
+
+void DatabaseService::publishConfig(const DatabaseConfig& config) {
+    auto snapshot = std::make_shared<const DatabaseConfig>(config);
+    std::lock_guard<std::mutex> lock(configMutex);
+    currentConfig = std::move(snapshot);
+}
+
+PooledConnection DatabaseService::acquireConnection() {
+    if (!pool.configured()) {
+        // Первые запросы рабочих потоков приходят одновременно - пул настраивает один из них
+        std::lock_guard<std::mutex> lock(poolSetupMutex);
+        if (!pool.configured() && !connect(*configSnapshot())) {
+            return PooledConnection();
+        }
     }
+    return pool.acquire();
 }
 
-bool DatabaseService::testConnection() {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+std::filesystem::file_time_type DatabaseService::configModificationTime() const {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(configManager.getDbConfigPath(), error);
+    return error ? std::filesystem::file_time_type() : time;
+}
+
+bool DatabaseService::reloadConfig() {
+    std::lock_guard<std::mutex> lock(poolSetupMutex);
+    return reloadConfigLocked();
+}
+
+bool DatabaseService::reloadConfigIfChanged() {
+    std::lock_guard<std::mutex> lock(poolSetupMutex);
+    if (configModificationTime() == configFileTime) {
+        return false;
+    }
+    return reloadConfigLocked();
+}
+
+bool DatabaseService::reloadConfigLocked() {
+    DatabaseConfig fresh;
+    if (!configManager.loadConfig(fresh)) {
         return false;
     }
-    return PQstatus(connection) == CONNECTION_OK;
+    configFileTime = configModificationTime();
+
+    std::shared_ptr<const DatabaseConfig> previous = configSnapshot();
+    bool connectionChanged = fresh.host != previous->host || fresh.port != previous->port ||
+                             fresh.database != previous->database || fresh.username != previous->username ||
+                             fresh.password != previous->password;
+    bool poolChanged = fresh.poolMinConnections != previous->poolMinConnections ||
+                       fresh.poolMaxConnections != previous->poolMaxConnections ||
+                       fresh.poolAcquireTimeoutMs != previous->poolAcquireTimeoutMs;
+    publishConfig(fresh);
+
+    // Пул еще не создан - подключимся с новыми параметрами при первом запросе
+    if (!pool.configured()) {
+        return true;
+    }
+    if (connectionChanged) {
+        Logger::getInstance().log("🔄 Параметры подключения к БД изменились - пул соединений пересоздается");
+        return connect(fresh);
+    }
+    if (poolChanged) {
+        pool.resize(static_cast<size_t>(std::max(fresh.poolMaxConnections, 1)),
+                    std::chrono::milliseconds(std::max(fresh.poolAcquireTimeoutMs, 0)));
+    }
+    return true;
 }
 
 bool DatabaseService::setupDatabase() {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
@@ -120,7 +215,9 @@ bool DatabaseService::setupDatabase() {
         "password_hash TEXT NOT NULL,"
         "last_name VARCHAR(50) NOT NULL,"
         "first_name VARCHAR(50) NOT NULL,"
-        "middle_name VARCHAR(50))",
+        "middle_name VARCHAR(50),"
+        "session_generation INTEGER NOT NULL DEFAULT 0,"
+        "sessions_revoked_at TIMESTAMP)",
 
         "CREATE TABLE IF NOT EXISTS sessions ("
         "session_id SERIAL PRIMARY KEY,"
@@ -130,7 +227,26 @@ bool DatabaseService::setupDatabase() {
         "last_activity TIMESTAMP NOT NULL,"
         "ip_address VARCHAR(24),"
         "user_agent TEXT,"
-        "expires_at TIMESTAMP NOT NULL);"
+        "expires_at TIMESTAMP NOT NULL,"
+        "generation INTEGER NOT NULL DEFAULT 0);",
+
+        // Поколения сессий для баз, созданных до их появления
+        "ALTER TABLE users ADD COLUMN IF NOT EXISTS session_generation INTEGER NOT NULL DEFAULT 0",
+        "ALTER TABLE users ADD COLUMN IF NOT EXISTS sessions_revoked_at TIMESTAMP",
+        "ALTER TABLE sessions ADD COLUMN IF NOT EXISTS generation INTEGER NOT NULL DEFAULT 0",
+
+        // Периодическая очистка удаляет по expires_at - без индекса это полный проход по таблице
+        "CREATE INDEX IF NOT EXISTS idx_sessions_expires_at ON sessions (expires_at)",
+
+        // Отозванные подписанные токены; строка нужна только до истечения токена
+        "CREATE TABLE IF NOT EXISTS revoked_tokens ("
+        "token VARCHAR(64) PRIMARY KEY,"
+        "expires_at TIMESTAMP NOT NULL)",
+
+        // Общие TAT ограничителя частоты (режим rateLimitMode = "cluster"): хэш ключа и наносекунды Unix-времени
+        "CREATE TABLE IF NOT EXISTS rate_limits ("
+        "key BIGINT PRIMARY KEY,"
+        "tat BIGINT NOT NULL)"
     };
     
     for (const auto& sql : sqlCommands) {
@@ -142,9 +258,8 @@ bool DatabaseService::setupDatabase() {
 }
 
 void DatabaseService::executeSQL(const std::string& sql) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) return;
+    PooledConnection connection = acquireConnection();
+    if (!connection) return;
     
     PGresult* res = PQexec(connection, sql.c_str());
     if (PQresultStatus(res) != PGRES_COMMAND_OK && PQresultStatus(res) != PGRES_TUPLES_OK) {
@@ -1,19 +1,43 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement GET_SPECIALIZATIONS("get_specializations",
+    "SELECT specialization, name FROM specialization_list ORDER BY name");
+const PreparedStatement ADD_SPECIALIZATION("add_specialization",
+    "INSERT INTO specialization_list (specialization, name) VALUES ($1, $2)");
+const PreparedStatement DELETE_SPECIALIZATION("delete_specialization",
+    "DELETE FROM specialization_list WHERE specialization = $1");
+const PreparedStatement ADD_TEACHER_SPECIALIZATION("add_teacher_specialization",
+    "INSERT INTO teacher_specializations (teacher_id, specialization_code) VALUES ($1, $2)");
+const PreparedStatement REMOVE_TEACHER_SPECIALIZATION("remove_teacher_specialization",
+    "DELETE FROM specialization_list WHERE specialization = $1 AND specialization IN (SELECT specialization FROM teachers WHERE teacher_id = $2)");
+const PreparedStatement GET_TEACHER_SPECIALIZATION_CODE("get_teacher_specialization_code",
+    "SELECT specialization FROM teachers WHERE teacher_id = $1");
+const PreparedStatement GET_SPECIALIZATION_BY_CODE("get_specialization_by_code",
+    "SELECT specialization, name FROM specialization_list WHERE specialization = $1");
+const PreparedStatement GET_SPECIALIZATION_CODE_BY_NAME("get_specialization_code_by_name",
+    "SELECT specialization FROM specialization_list WHERE name = $1");
+const PreparedStatement GET_UNIQUE_SPECIALIZATION_NAMES("get_unique_specialization_names",
+    "SELECT DISTINCT name FROM specialization_list ORDER BY name ASC;");
+
+}
+
 // Specializations management
 std::vector<Specialization> DatabaseService::getSpecializations() {
     std::vector<Specialization> specializations;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return specializations;
     }
     
-    PGresult* res = PQexec(connection, "SELECT specialization, name FROM specialization_list ORDER BY name");
+    PGresult* res = GET_SPECIALIZATIONS.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
         return specializations;
@@ -32,19 +56,17 @@ std::vector<Specialization> DatabaseService::getSpecializations() {
 }
 
 bool DatabaseService::addSpecialization(const Specialization& specialization) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "INSERT INTO specialization_list (specialization, name) VALUES ($1, $2)";
     const char* params[2] = {
         std::to_string(specialization.specializationCode).c_str(),
         specialization.name.c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 2, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_SPECIALIZATION.execute(connection, 2, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -52,16 +74,14 @@ bool DatabaseService::addSpecialization(const Specialization& specialization) {
 }
 
 bool DatabaseService::deleteSpecialization(int specializationCode) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "DELETE FROM specialization_list WHERE specialization = $1";
     const char* params[1] = { std::to_string(specializationCode).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = DELETE_SPECIALIZATION.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -70,19 +90,17 @@ bool DatabaseService::deleteSpecialization(int specializationCode) {
 
 // Teacher specializations management
 bool DatabaseService::addTeacherSpecialization(int teacherId, int specializationCode) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "INSERT INTO teacher_specializations (teacher_id, specialization_code) VALUES ($1, $2)";
     const char* params[2] = {
         std::to_string(teacherId).c_str(),
         std::to_string(specializationCode).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 2, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_TEACHER_SPECIALIZATION.execute(connection, 2, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -90,19 +108,17 @@ bool DatabaseService::addTeacherSpecialization(int teacherId, int specialization
 }
 
 bool DatabaseService::removeTeacherSpecialization(int teacherId, int specializationCode) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "DELETE FROM specialization_list WHERE specialization = $1 AND specialization IN (SELECT specialization FROM teachers WHERE teacher_id = $2)";
     const char* params[2] = {
         std::to_string(specializationCode).c_str(),
         std::to_string(teacherId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 2, NULL, params, NULL, NULL, 0);
+    PGresult* res = REMOVE_TEACHER_SPECIALIZATION.execute(connection, 2, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -111,17 +127,16 @@ bool DatabaseService::removeTeacherSpecialization(int teacherId, int specializat
 
 std::vector<Specialization> DatabaseService::getTeacherSpecializations(int teacherId) {
     std::vector<Specialization> specializations;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return specializations;
     }
     
     // Получаем код специализации преподавателя из таблицы teachers
-    std::string teacherSql = "SELECT specialization FROM teachers WHERE teacher_id = $1";
     const char* teacherParams[1] = { std::to_string(teacherId).c_str() };
     
-    PGresult* teacherRes = PQexecParams(connection, teacherSql.c_str(), 1, NULL, teacherParams, NULL, NULL, 0);
+    PGresult* teacherRes = GET_TEACHER_SPECIALIZATION_CODE.execute(connection, 1, teacherParams);
     if (PQresultStatus(teacherRes) != PGRES_TUPLES_OK || PQntuples(teacherRes) == 0) {
         PQclear(teacherRes);
         return specializations;
@@ -135,10 +150,9 @@ std::vector<Specialization> DatabaseService::getTeacherSpecializations(int teach
     }
     
     // Получаем информацию о специализации
-    std::string specSql = "SELECT specialization, name FROM specialization_list WHERE specialization = $1";
     const char* specParams[1] = { std::to_string(specializationCode).c_str() };
     
-    PGresult* specRes = PQexecParams(connection, specSql.c_str(), 1, NULL, specParams, NULL, NULL, 0);
+    PGresult* specRes = GET_SPECIALIZATION_BY_CODE.execute(connection, 1, specParams);
     if (PQresultStatus(specRes) == PGRES_TUPLES_OK) {
         int rows = PQntuples(specRes);
         for (int i = 0; i < rows; i++) {
@@ -154,16 +168,14 @@ std::vector<Specialization> DatabaseService::getTeacherSpecializations(int teach
 }
 
 int DatabaseService::getSpecializationCodeByName(const std::string& name) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return 0;
     }
     
-    std::string sql = "SELECT specialization FROM specialization_list WHERE name = $1";
     const char* params[1] = { name.c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_SPECIALIZATION_CODE_BY_NAME.execute(connection, 1, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
@@ -178,15 +190,13 @@ int DatabaseService::getSpecializationCodeByName(const std::string& name) {
 
 std::vector<std::string> DatabaseService::getUniqueSpecializationNames() {
     std::vector<std::string> names;
-    configManager.loadConfig(currentConfig);
 
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return names;
     }
 
-    std::string sql = "SELECT DISTINCT name FROM specialization_list ORDER BY name ASC;";
-
-    PGresult* res = PQexec(connection, sql.c_str());
+    PGresult* res = GET_UNIQUE_SPECIALIZATION_NAMES.execute(connection);
 
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Ошибка получения уникальных специализаций: " + std::string(PQerrorMessage(connection)), "ERROR");
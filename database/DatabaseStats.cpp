@@ -1,11 +1,26 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement GET_TEACHERS_COUNT("get_teachers_count", "SELECT COUNT(*) FROM teachers;");
+const PreparedStatement GET_STUDENTS_COUNT("get_students_count", "SELECT COUNT(*) FROM students;");
+const PreparedStatement GET_GROUPS_COUNT("get_groups_count", "SELECT COUNT(*) FROM student_groups;");
+const PreparedStatement GET_PORTFOLIOS_COUNT("get_portfolios_count", "SELECT COUNT(*) FROM student_portfolio;");
+const PreparedStatement GET_EVENTS_COUNT("get_events_count", "SELECT COUNT(*) FROM event;");
+
+}
+
 // Statistics methods
 int DatabaseService::getTeachersCount() {
-    PGresult* res = PQexec(this->connection, "SELECT COUNT(*) FROM teachers;");
+    PooledConnection connection = acquireConnection();
+    PGresult* res = GET_TEACHERS_COUNT.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Database error in getTeachersCount: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
@@ -17,7 +32,8 @@ int DatabaseService::getTeachersCount() {
 }
 
 int DatabaseService::getStudentsCount() {
-    PGresult* res = PQexec(this->connection, "SELECT COUNT(*) FROM students;");
+    PooledConnection connection = acquireConnection();
+    PGresult* res = GET_STUDENTS_COUNT.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Database error in getStudentsCount: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
@@ -29,7 +45,8 @@ int DatabaseService::getStudentsCount() {
 }
 
 int DatabaseService::getGroupsCount() {
-    PGresult* res = PQexec(this->connection, "SELECT COUNT(*) FROM student_groups;");
+    PooledConnection connection = acquireConnection();
+    PGresult* res = GET_GROUPS_COUNT.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Database error in getGroupsCount: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
@@ -41,7 +58,8 @@ int DatabaseService::getGroupsCount() {
 }
 
 int DatabaseService::getPortfoliosCount() {
-    PGresult* res = PQexec(this->connection, "SELECT COUNT(*) FROM student_portfolio;");
+    PooledConnection connection = acquireConnection();
+    PGresult* res = GET_PORTFOLIOS_COUNT.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Database error in getPortfoliosCount: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
@@ -53,7 +71,8 @@ int DatabaseService::getPortfoliosCount() {
 }
 
 int DatabaseService::getEventsCount() {
-    PGresult* res = PQexec(this->connection, "SELECT COUNT(*) FROM event;");
+    PooledConnection connection = acquireConnection();
+    PGresult* res = GET_EVENTS_COUNT.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Database error in getEventsCount: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
@@ -62,4 +81,80 @@ int DatabaseService::getEventsCount() {
     int count = std::stoi(PQgetvalue(res, 0, 0));
     PQclear(res);
     return count;
+}
+
+DashboardCounts DatabaseService::getDashboardCounts() {
+    DashboardCounts counts;
+
+    // Пять независимых COUNT(*) уходят на сервер одним пакетом
+    QueryBatch batch;
+    const PreparedStatement* statements[] = {
+        &GET_TEACHERS_COUNT, &GET_STUDENTS_COUNT, &GET_GROUPS_COUNT, &GET_PORTFOLIOS_COUNT, &GET_EVENTS_COUNT
+    };
+    int* targets[] = { &counts.teachers, &counts.students, &counts.groups, &counts.portfolios, &counts.events };
+    for (const PreparedStatement* statement : statements) {
+        batch.add(*statement);
+    }
+    executeBatch(batch);
+
+    for (size_t i = 0; i < batch.size(); i++) {
+        PGresult* res = batch.result(i);
+        if (!res || PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
+            Logger::getInstance().log("❌ Database error in getDashboardCounts (" + std::string(statements[i]->name()) +
+                                      "): " + batch.error(i), "ERROR");
+            continue;
+        }
+        *targets[i] = std::stoi(PQgetvalue(res, 0, 0));
+    }
+    return counts;
+}
+
+bool DatabaseService::getDashboardCountsAsync(std::function<void(const DashboardCounts&)> done) {
+    // Ответы приходят в поток событий по одному; последний передает счетчики в done
+    struct Pending {
+        DashboardCounts counts;
+        std::atomic<size_t> remaining{0};
+        std::function<void(const DashboardCounts&)> done;
+    };
+    const PreparedStatement* statements[] = {
+        &GET_TEACHERS_COUNT, &GET_STUDENTS_COUNT, &GET_GROUPS_COUNT, &GET_PORTFOLIOS_COUNT, &GET_EVENTS_COUNT
+    };
+    int DashboardCounts::* targets[] = {
+        &DashboardCounts::teachers, &DashboardCounts::students, &DashboardCounts::groups,
+        &DashboardCounts::portfolios, &DashboardCounts::events
+    };
+    const size_t total = sizeof(statements) / sizeof(statements[0]);
+
+    auto pending = std::make_shared<Pending>();
+    pending->remaining = total;
+    pending->done = std::move(done);
+
+    for (size_t i = 0; i < total; i++) {
+        const PreparedStatement* statement = statements[i];
+        int DashboardCounts::* target = targets[i];
+        bool submitted = asyncDatabase.submit(*statement, {},
+            [pending, statement, target](const PGresult* res, const std::string& error) {
+                if (res && PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
+                    pending->counts.*target = std::atoi(PQgetvalue(res, 0, 0));
+                } else {
+                    Logger::getInstance().log("❌ Database error in getDashboardCountsAsync (" +
+                                              std::string(statement->name()) + "): " + error, "ERROR");
+                }
+                if (pending->remaining.fetch_sub(1) == 1) {
+                    pending->done(pending->counts);
+                }
+            });
+
+        if (!submitted) {
+            if (i == 0) {
+                return false;
+            }
+            // Асинхронные соединения закрылись посреди отправки: остальные счетчики остаются нулями
+            if (pending->remaining.fetch_sub(total - i) == total - i) {
+                pending->done(pending->counts);
+            }
+            break;
+        }
+    }
+    return true;
 }
\ No newline at end of file
@@ -1,20 +1,44 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement GET_STUDENTS("get_students",
+    "SELECT student_code, last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number FROM students");
+const PreparedStatement ADD_STUDENT("add_student",
+    "INSERT INTO students (last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number) VALUES ($1, $2, $3, $4, $5, $6, $7, $8)");
+const PreparedStatement INCREMENT_GROUP_STUDENT_COUNT("increment_group_student_count",
+    "UPDATE student_groups SET student_count = student_count + 1 WHERE group_id = $1");
+const PreparedStatement UPDATE_STUDENT("update_student",
+    "UPDATE students SET last_name = $1, first_name = $2, middle_name = $3, phone_number = $4, email = $5, group_id = $6, passport_series = $7, passport_number = $8 WHERE student_code = $9");
+const PreparedStatement DECREMENT_GROUP_STUDENT_COUNT("decrement_group_student_count",
+    "UPDATE student_groups SET student_count = student_count - 1 WHERE group_id = $1");
+const PreparedStatement DELETE_STUDENT("delete_student", "DELETE FROM students WHERE student_code = $1");
+const PreparedStatement GET_STUDENT_COUNT_IN_GROUP("get_student_count_in_group",
+    "SELECT COUNT(*) FROM students WHERE group_id = $1");
+const PreparedStatement SYNC_STUDENT_COUNTS("sync_student_counts",
+    "UPDATE student_groups SET student_count = $1 WHERE group_id = $2");
+const PreparedStatement GET_STUDENT_BY_ID("get_student_by_id",
+    "SELECT student_code, last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number FROM students WHERE student_code = $1");
+const PreparedStatement GET_STUDENTS_BY_GROUP("get_students_by_group",
+    "SELECT student_code, last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number FROM students WHERE group_id = $1");
+
+}
+
 // Student management
 std::vector<Student> DatabaseService::getStudents() {
     std::vector<Student> students;
-    configManager.loadConfig(currentConfig);
 
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return students;
     }
 
-    PGresult* res = PQexec(connection, 
-        "SELECT student_code, last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number FROM students");
+    PGresult* res = GET_STUDENTS.execute(connection);
 
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Ошибка выполнения запроса getStudents: " + std::string(PQerrorMessage(connection)), "ERROR");
@@ -70,223 +94,135 @@ std::vector<Student> DatabaseService::getStudents() {
 
 // Student management
 bool DatabaseService::addStudent(const Student& student) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
-        return false;
-    }
-    
-    // Начинаем транзакцию
-    PGresult* beginRes = PQexec(connection, "BEGIN");
-    if (PQresultStatus(beginRes) != PGRES_COMMAND_OK) {
-        PQclear(beginRes);
-        return false;
-    }
-    PQclear(beginRes);
-    
-    bool success = true;
+    // BEGIN, вставка, счетчик группы и COMMIT уходят на сервер одним пакетом
+    QueryBatch batch(QueryBatch::Mode::TRANSACTION);
     
     // 1. Добавляем студента
-    std::string sql = "INSERT INTO students (last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number) VALUES ($1, $2, $3, $4, $5, $6, $7, $8)";
-    const char* params[8] = {
-        student.lastName.c_str(),
-        student.firstName.c_str(),
-        student.middleName.c_str(),
-        student.phoneNumber.c_str(),
-        student.email.c_str(),
-        std::to_string(student.groupId).c_str(),
-        student.passportSeries.c_str(),
-        student.passportNumber.c_str()
-    };
-    
-    PGresult* res = PQexecParams(connection, sql.c_str(), 8, NULL, params, NULL, NULL, 0);
-    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
-        success = false;
-        Logger::getInstance().log("❌ Ошибка добавления студента: " + std::string(PQerrorMessage(connection)), "ERROR");
-    }
-    PQclear(res);
+    batch.add(ADD_STUDENT, {
+        student.lastName,
+        student.firstName,
+        student.middleName,
+        student.phoneNumber,
+        student.email,
+        std::to_string(student.groupId),
+        student.passportSeries,
+        student.passportNumber
+    });
     
     // 2. Обновляем счетчик студентов в группе
-    if (success && student.groupId > 0) {
-        std::string updateSql = "UPDATE student_groups SET student_count = student_count + 1 WHERE group_id = $1";
-        const char* updateParams[1] = { std::to_string(student.groupId).c_str() };
-        
-        PGresult* updateRes = PQexecParams(connection, updateSql.c_str(), 1, NULL, updateParams, NULL, NULL, 0);
-        if (PQresultStatus(updateRes) != PGRES_COMMAND_OK) {
-            success = false;
-            Logger::getInstance().log("❌ Ошибка обновления счетчика группы: " + std::string(PQerrorMessage(connection)), "ERROR");
-        }
-        PQclear(updateRes);
+    size_t counterIndex = QueryBatch::npos;
+    if (student.groupId > 0) {
+        counterIndex = batch.add(INCREMENT_GROUP_STUDENT_COUNT, { std::to_string(student.groupId) });
     }
     
-    // Завершаем транзакцию
-    if (success) {
-        PGresult* commitRes = PQexec(connection, "COMMIT");
-        PQclear(commitRes);
-    } else {
-        PGresult* rollbackRes = PQexec(connection, "ROLLBACK");
-        PQclear(rollbackRes);
+    if (!executeBatch(batch)) {
+        size_t failed = batch.failedIndex();
+        std::string message = "❌ Ошибка добавления студента: ";
+        if (failed != QueryBatch::npos && failed == counterIndex) {
+            message = "❌ Ошибка обновления счетчика группы: ";
+        }
+        Logger::getInstance().log(message + batch.error(failed), "ERROR");
+        return false;
     }
     
-    return success;
+    return true;
 }
 
 bool DatabaseService::updateStudent(const Student& student) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
-        return false;
-    }
-    
     // Получаем текущие данные студента для определения старой группы
     Student oldStudent = getStudentById(student.studentCode);
     if (oldStudent.studentCode == 0) {
         return false;
     }
     
-    // Начинаем транзакцию
-    PGresult* beginRes = PQexec(connection, "BEGIN");
-    if (PQresultStatus(beginRes) != PGRES_COMMAND_OK) {
-        PQclear(beginRes);
-        return false;
-    }
-    PQclear(beginRes);
-    
-    bool success = true;
+    // BEGIN, обновление, счетчики групп и COMMIT уходят на сервер одним пакетом
+    QueryBatch batch(QueryBatch::Mode::TRANSACTION);
     
     // 1. Обновляем данные студента
-    std::string sql = "UPDATE students SET last_name = $1, first_name = $2, middle_name = $3, phone_number = $4, email = $5, group_id = $6, passport_series = $7, passport_number = $8 WHERE student_code = $9";
-    const char* params[9] = {
-        student.lastName.c_str(),
-        student.firstName.c_str(),
-        student.middleName.c_str(),
-        student.phoneNumber.c_str(),
-        student.email.c_str(),
-        std::to_string(student.groupId).c_str(),
-        student.passportSeries.c_str(),
-        student.passportNumber.c_str(),
-        std::to_string(student.studentCode).c_str()
-    };
-    
-    PGresult* res = PQexecParams(connection, sql.c_str(), 9, NULL, params, NULL, NULL, 0);
-    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
-        success = false;
-        Logger::getInstance().log("❌ Ошибка обновления студента: " + std::string(PQerrorMessage(connection)), "ERROR");
-    }
-    PQclear(res);
+    batch.add(UPDATE_STUDENT, {
+        student.lastName,
+        student.firstName,
+        student.middleName,
+        student.phoneNumber,
+        student.email,
+        std::to_string(student.groupId),
+        student.passportSeries,
+        student.passportNumber,
+        std::to_string(student.studentCode)
+    });
     
     // 2. Обновляем счетчики студентов в группах (если группа изменилась)
-    if (success && oldStudent.groupId != student.groupId) {
+    size_t decreaseIndex = QueryBatch::npos;
+    size_t increaseIndex = QueryBatch::npos;
+    if (oldStudent.groupId != student.groupId) {
         // Уменьшаем счетчик в старой группе (если была группа)
         if (oldStudent.groupId > 0) {
-            std::string decreaseSql = "UPDATE student_groups SET student_count = student_count - 1 WHERE group_id = $1";
-            const char* decreaseParams[1] = { std::to_string(oldStudent.groupId).c_str() };
-            
-            PGresult* decreaseRes = PQexecParams(connection, decreaseSql.c_str(), 1, NULL, decreaseParams, NULL, NULL, 0);
-            if (PQresultStatus(decreaseRes) != PGRES_COMMAND_OK) {
-                success = false;
-                Logger::getInstance().log("❌ Ошибка уменьшения счетчика старой группы: " + std::string(PQerrorMessage(connection)), "ERROR");
-            }
-            PQclear(decreaseRes);
+            decreaseIndex = batch.add(DECREMENT_GROUP_STUDENT_COUNT, { std::to_string(oldStudent.groupId) });
         }
         
         // Увеличиваем счетчик в новой группе (если указана новая группа)
-        if (success && student.groupId > 0) {
-            std::string increaseSql = "UPDATE student_groups SET student_count = student_count + 1 WHERE group_id = $1";
-            const char* increaseParams[1] = { std::to_string(student.groupId).c_str() };
-            
-            PGresult* increaseRes = PQexecParams(connection, increaseSql.c_str(), 1, NULL, increaseParams, NULL, NULL, 0);
-            if (PQresultStatus(increaseRes) != PGRES_COMMAND_OK) {
-                success = false;
-                Logger::getInstance().log("❌ Ошибка увеличения счетчика новой группы: " + std::string(PQerrorMessage(connection)), "ERROR");
-            }
-            PQclear(increaseRes);
+        if (student.groupId > 0) {
+            increaseIndex = batch.add(INCREMENT_GROUP_STUDENT_COUNT, { std::to_string(student.groupId) });
         }
     }
     
-    // Завершаем транзакцию
-    if (success) {
-        PGresult* commitRes = PQexec(connection, "COMMIT");
-        PQclear(commitRes);
-    } else {
-        PGresult* rollbackRes = PQexec(connection, "ROLLBACK");
-        PQclear(rollbackRes);
+    if (!executeBatch(batch)) {
+        size_t failed = batch.failedIndex();
+        std::string message = "❌ Ошибка обновления студента: ";
+        if (failed != QueryBatch::npos && failed == decreaseIndex) {
+            message = "❌ Ошибка уменьшения счетчика старой группы: ";
+        } else if (failed != QueryBatch::npos && failed == increaseIndex) {
+            message = "❌ Ошибка увеличения счетчика новой группы: ";
+        }
+        Logger::getInstance().log(message + batch.error(failed), "ERROR");
+        return false;
     }
     
-    return success;
+    return true;
 }
 
 bool DatabaseService::deleteStudent(int studentCode) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
-        return false;
-    }
-    
     // Получаем данные студента для определения группы
     Student student = getStudentById(studentCode);
     if (student.studentCode == 0) {
         return false;
     }
     
-    // Начинаем транзакцию
-    PGresult* beginRes = PQexec(connection, "BEGIN");
-    if (PQresultStatus(beginRes) != PGRES_COMMAND_OK) {
-        PQclear(beginRes);
-        return false;
-    }
-    PQclear(beginRes);
-    
-    bool success = true;
+    // BEGIN, удаление, счетчик группы и COMMIT уходят на сервер одним пакетом
+    QueryBatch batch(QueryBatch::Mode::TRANSACTION);
     
     // 1. Удаляем студента
-    std::string sql = "DELETE FROM students WHERE student_code = $1";
-    const char* params[1] = { std::to_string(studentCode).c_str() };
-    
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
-    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
-        success = false;
-        Logger::getInstance().log("❌ Ошибка удаления студента: " + std::string(PQerrorMessage(connection)), "ERROR");
-    }
-    PQclear(res);
+    batch.add(DELETE_STUDENT, { std::to_string(studentCode) });
     
     // 2. Обновляем счетчик студентов в группе (если студент был в группе)
-    if (success && student.groupId > 0) {
-        std::string updateSql = "UPDATE student_groups SET student_count = student_count - 1 WHERE group_id = $1";
-        const char* updateParams[1] = { std::to_string(student.groupId).c_str() };
-        
-        PGresult* updateRes = PQexecParams(connection, updateSql.c_str(), 1, NULL, updateParams, NULL, NULL, 0);
-        if (PQresultStatus(updateRes) != PGRES_COMMAND_OK) {
-            success = false;
-            Logger::getInstance().log("❌ Ошибка обновления счетчика группы: " + std::string(PQerrorMessage(connection)), "ERROR");
-        }
-        PQclear(updateRes);
+    size_t counterIndex = QueryBatch::npos;
+    if (student.groupId > 0) {
+        counterIndex = batch.add(DECREMENT_GROUP_STUDENT_COUNT, { std::to_string(student.groupId) });
     }
     
-    // Завершаем транзакцию
-    if (success) {
-        PGresult* commitRes = PQexec(connection, "COMMIT");
-        PQclear(commitRes);
-    } else {
-        PGresult* rollbackRes = PQexec(connection, "ROLLBACK");
-        PQclear(rollbackRes);
+    if (!executeBatch(batch)) {
+        size_t failed = batch.failedIndex();
+        std::string message = "❌ Ошибка удаления студента: ";
+        if (failed != QueryBatch::npos && failed == counterIndex) {
+            message = "❌ Ошибка обновления счетчика группы: ";
+        }
+        Logger::getInstance().log(message + batch.error(failed), "ERROR");
+        return false;
     }
     
-    return success;
+    return true;
 }
 
 // Вспомогательный метод для получения количества студентов в группе
 int DatabaseService::getStudentCountInGroup(int groupId) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return 0;
     }
     
-    std::string sql = "SELECT COUNT(*) FROM students WHERE group_id = $1";
     const char* params[1] = { std::to_string(groupId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_STUDENT_COUNT_IN_GROUP.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return 0;
@@ -300,9 +236,8 @@ int DatabaseService::getStudentCountInGroup(int groupId) {
 
 // Метод для синхронизации счетчиков студентов во всех группах
 bool DatabaseService::syncStudentCounts() {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
@@ -324,13 +259,12 @@ bool DatabaseService::syncStudentCounts() {
         int actualCount = getStudentCountInGroup(group.groupId);
         
         // Обновляем счетчик в таблице групп
-        std::string sql = "UPDATE student_groups SET student_count = $1 WHERE group_id = $2";
         const char* params[2] = {
             std::to_string(actualCount).c_str(),
             std::to_string(group.groupId).c_str()
         };
         
-        PGresult* res = PQexecParams(connection, sql.c_str(), 2, NULL, params, NULL, NULL, 0);
+        PGresult* res = SYNC_STUDENT_COUNTS.execute(connection, 2, params);
         if (PQresultStatus(res) != PGRES_COMMAND_OK) {
             success = false;
             Logger::getInstance().log("❌ Ошибка синхронизации счетчика для группы " + std::to_string(group.groupId) 
@@ -353,16 +287,15 @@ bool DatabaseService::syncStudentCounts() {
 
 Student DatabaseService::getStudentById(int studentId) {
     Student student;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return student;
     }
     
-    std::string sql = "SELECT student_code, last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number FROM students WHERE student_code = $1";
     const char* params[1] = { std::to_string(studentId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_STUDENT_BY_ID.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return student;
@@ -384,16 +317,15 @@ Student DatabaseService::getStudentById(int studentId) {
 
 std::vector<Student> DatabaseService::getStudentsByGroup(int groupId) {
     std::vector<Student> students;
-    configManager.loadConfig(currentConfig);
 
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return students;
     }
 
-    std::string sql = "SELECT student_code, last_name, first_name, middle_name, phone_number, email, group_id, passport_series, passport_number FROM students WHERE group_id = $1";
     const char* params[1] = { std::to_string(groupId).c_str() };
 
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_STUDENTS_BY_GROUP.execute(connection, 1, params);
 
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
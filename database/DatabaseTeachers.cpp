@@ -1,25 +1,44 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement GET_TEACHERS("get_teachers",
+    "SELECT t.teacher_id, t.last_name, t.first_name, t.middle_name, t.experience, t.email, t.phone_number, "
+    "STRING_AGG(sl.name, ', ') as specializations "
+    "FROM teachers t "
+    "LEFT JOIN specialization_list sl ON t.specialization = sl.specialization "
+    "GROUP BY t.teacher_id, t.last_name, t.first_name, t.middle_name, t.experience, t.email, t.phone_number");
+const PreparedStatement ADD_TEACHER("add_teacher",
+    "INSERT INTO teachers (last_name, first_name, middle_name, experience, email, phone_number) VALUES ($1, $2, $3, $4, $5, $6) RETURNING teacher_id, specialization");
+const PreparedStatement ADD_TEACHER_SPECIALIZATION_NAME("add_teacher_specialization_name",
+    "INSERT INTO specialization_list (specialization, name) VALUES ($1, $2)");
+const PreparedStatement UPDATE_TEACHER("update_teacher",
+    "UPDATE teachers SET last_name = $1, first_name = $2, middle_name = $3, experience = $4, email = $5, phone_number = $6 WHERE teacher_id = $7");
+const PreparedStatement DELETE_TEACHER_SPECIALIZATIONS("delete_teacher_specializations",
+    "DELETE FROM specialization_list WHERE specialization IN (SELECT specialization FROM teachers WHERE teacher_id = $1)");
+const PreparedStatement DELETE_TEACHER("delete_teacher", "DELETE FROM teachers WHERE teacher_id = $1");
+const PreparedStatement GET_TEACHER_BY_ID("get_teacher_by_id",
+    "SELECT teacher_id, last_name, first_name, middle_name, experience, specialization, email, phone_number FROM teachers WHERE teacher_id = $1");
+const PreparedStatement REMOVE_ALL_TEACHER_SPECIALIZATIONS("remove_all_teacher_specializations",
+    "DELETE FROM specialization_list WHERE specialization = $1");
+
+}
+
 // Teacher management
 std::vector<Teacher> DatabaseService::getTeachers() {
     std::vector<Teacher> teachers;
     
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) return teachers;
+    PooledConnection connection = acquireConnection();
+    if (!connection) return teachers;
     
     // Используем JOIN чтобы получить специализации
-    std::string sql = "SELECT t.teacher_id, t.last_name, t.first_name, t.middle_name, t.experience, t.email, t.phone_number, "
-                    "STRING_AGG(sl.name, ', ') as specializations "
-                    "FROM teachers t "
-                    "LEFT JOIN specialization_list sl ON t.specialization = sl.specialization "
-                    "GROUP BY t.teacher_id, t.last_name, t.first_name, t.middle_name, t.experience, t.email, t.phone_number";
     
-    PGresult* res = PQexec(connection, sql.c_str());
+    PGresult* res = GET_TEACHERS.execute(connection);
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Database error in getTeachers: " + std::string(PQerrorMessage(connection)), "ERROR");
         PQclear(res);
@@ -52,14 +71,12 @@ std::vector<Teacher> DatabaseService::getTeachers() {
 }
 
 bool DatabaseService::addTeacher(const Teacher& teacher) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
     // specialization теперь SERIAL - не передаём его, БД сама сгенерирует
-    std::string sql = "INSERT INTO teachers (last_name, first_name, middle_name, experience, email, phone_number) VALUES ($1, $2, $3, $4, $5, $6) RETURNING teacher_id, specialization";
     const char* params[6] = {
         teacher.lastName.c_str(),
         teacher.firstName.c_str(),
@@ -69,7 +86,7 @@ bool DatabaseService::addTeacher(const Teacher& teacher) {
         teacher.phoneNumber.c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 6, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_TEACHER.execute(connection, 6, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         Logger::getInstance().log("❌ Database error in addTeacher: " + std::string(PQerrorMessage(connection)), "ERROR");
@@ -84,13 +101,12 @@ bool DatabaseService::addTeacher(const Teacher& teacher) {
     // Теперь добавляем специализации в specialization_list
     if (!teacher.specializations.empty()) {
         for (const auto& spec : teacher.specializations) {
-            std::string specSql = "INSERT INTO specialization_list (specialization, name) VALUES ($1, $2)";
             const char* specParams[2] = {
                 std::to_string(specializationCode).c_str(),
                 spec.name.c_str()
             };
             
-            PGresult* specRes = PQexecParams(connection, specSql.c_str(), 2, NULL, specParams, NULL, NULL, 0);
+            PGresult* specRes = ADD_TEACHER_SPECIALIZATION_NAME.execute(connection, 2, specParams);
             if (PQresultStatus(specRes) != PGRES_COMMAND_OK) {
                 Logger::getInstance().log("❌ Failed to add specialization: " + std::string(PQerrorMessage(connection)), "ERROR");
             }
@@ -102,13 +118,11 @@ bool DatabaseService::addTeacher(const Teacher& teacher) {
 }
 
 bool DatabaseService::updateTeacher(const Teacher& teacher) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "UPDATE teachers SET last_name = $1, first_name = $2, middle_name = $3, experience = $4, email = $5, phone_number = $6 WHERE teacher_id = $7";
     const char* params[7] = {
         teacher.lastName.c_str(),
         teacher.firstName.c_str(),
@@ -119,7 +133,7 @@ bool DatabaseService::updateTeacher(const Teacher& teacher) {
         std::to_string(teacher.teacherId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 7, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_TEACHER.execute(connection, 7, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -127,24 +141,21 @@ bool DatabaseService::updateTeacher(const Teacher& teacher) {
 }
 
 bool DatabaseService::deleteTeacher(int teacherId) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
     // Сначала удаляем специализации преподавателя
-    std::string deleteSpecsSql = "DELETE FROM specialization_list WHERE specialization IN (SELECT specialization FROM teachers WHERE teacher_id = $1)";
     const char* deleteSpecsParams[1] = { std::to_string(teacherId).c_str() };
     
-    PGresult* deleteSpecsRes = PQexecParams(connection, deleteSpecsSql.c_str(), 1, NULL, deleteSpecsParams, NULL, NULL, 0);
+    PGresult* deleteSpecsRes = DELETE_TEACHER_SPECIALIZATIONS.execute(connection, 1, deleteSpecsParams);
     PQclear(deleteSpecsRes);
     
     // Затем удаляем преподавателя
-    std::string sql = "DELETE FROM teachers WHERE teacher_id = $1";
     const char* params[1] = { std::to_string(teacherId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = DELETE_TEACHER.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -153,16 +164,15 @@ bool DatabaseService::deleteTeacher(int teacherId) {
 
 Teacher DatabaseService::getTeacherById(int teacherId) {
     Teacher teacher;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return teacher;
     }
     
-    std::string sql = "SELECT teacher_id, last_name, first_name, middle_name, experience, specialization, email, phone_number FROM teachers WHERE teacher_id = $1";
     const char* params[1] = { std::to_string(teacherId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_TEACHER_BY_ID.execute(connection, 1, params);
     if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0) {
         PQclear(res);
         return teacher;
@@ -189,9 +199,8 @@ Teacher DatabaseService::getTeacherById(int teacherId) {
 }
 
 bool DatabaseService::removeAllTeacherSpecializations(int teacherId) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
@@ -202,10 +211,9 @@ bool DatabaseService::removeAllTeacherSpecializations(int teacherId) {
     }
     
     // Используем specializationCode вместо specialization
-    std::string sql = "DELETE FROM specialization_list WHERE specialization = $1";
     const char* params[1] = { std::to_string(teacher.specializationCode).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = REMOVE_ALL_TEACHER_SPECIALIZATIONS.execute(connection, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     
     if (!success) {
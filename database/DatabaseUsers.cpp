@@ -1,18 +1,34 @@
 #include "database/DatabaseService.h"
+#include "database/StatementRegistry.h"
 #include <libpq-fe.h>
 #include <iostream>
 #include <sstream>
 #include "logger/logger.h"
 
+namespace {
+
+const PreparedStatement ADD_USER("add_user",
+    "INSERT INTO users (email, login, phone_number, password_hash, last_name, first_name, middle_name) VALUES ($1, $2, $3, $4, $5, $6, $7)");
+const PreparedStatement GET_USER_BY_EMAIL("get_user_by_email",
+    "SELECT user_id, login, email, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE email = $1");
+const PreparedStatement GET_USER_BY_LOGIN("get_user_by_login",
+    "SELECT user_id, login, email, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE login = $1");
+const PreparedStatement GET_USER_BY_PHONE_NUMBER("get_user_by_phone_number",
+    "SELECT user_id, login, email, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE phone_number = $1");
+const PreparedStatement UPDATE_USER("update_user",
+    "UPDATE users SET email = $1, phone_number = $2, password_hash = $3, last_name = $4, first_name = $5, middle_name = $6 WHERE user_id = $7");
+const PreparedStatement GET_USER_BY_ID("get_user_by_id",
+    "SELECT user_id, email, login, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE user_id = $1");
+
+}
+
 // User management
 bool DatabaseService::addUser(const User& user) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "INSERT INTO users (email, login, phone_number, password_hash, last_name, first_name, middle_name) VALUES ($1, $2, $3, $4, $5, $6, $7)";
     const char* params[7] = {
         user.email.c_str(),
         user.login.c_str(),
@@ -23,7 +39,7 @@ bool DatabaseService::addUser(const User& user) {
         user.middleName.c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 7, NULL, params, NULL, NULL, 0);
+    PGresult* res = ADD_USER.execute(connection, 7, params);
     
     if (PQresultStatus(res) != PGRES_COMMAND_OK) {
         Logger::getInstance().log("❌ Database error in addUser: " + std::string(PQerrorMessage(connection)), "ERROR");
@@ -39,16 +55,14 @@ User DatabaseService::getUserByEmail(const std::string& email) {
     User user;
     user.userId = 0;
     
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return user;
     }
     
-    std::string sql = "SELECT user_id, login, email, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE email = $1";
     const char* params[1] = { email.c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_USER_BY_EMAIL.execute(connection, 1, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
@@ -77,16 +91,14 @@ User DatabaseService::getUserByLogin(const std::string& login) {
     User user;
     user.userId = 0;
     
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return user;
     }
     
-    std::string sql = "SELECT user_id, login, email, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE login = $1";
     const char* params[1] = { login.c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_USER_BY_LOGIN.execute(connection, 1, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
@@ -115,16 +127,14 @@ User DatabaseService::getUserByPhoneNumber(const std::string& phoneNumber) {
     User user;
     user.userId = 0;
     
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return user;
     }
     
-    std::string sql = "SELECT user_id, login, email, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE phone_number = $1";
     const char* params[1] = { phoneNumber.c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_USER_BY_PHONE_NUMBER.execute(connection, 1, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
@@ -150,13 +160,11 @@ User DatabaseService::getUserByPhoneNumber(const std::string& phoneNumber) {
 }
 
 bool DatabaseService::updateUser(const User& user) {
-    configManager.loadConfig(currentConfig);
-    
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return false;
     }
     
-    std::string sql = "UPDATE users SET email = $1, phone_number = $2, password_hash = $3, last_name = $4, first_name = $5, middle_name = $6 WHERE user_id = $7";
     const char* params[7] = {
         user.email.c_str(),
         user.phoneNumber.c_str(),
@@ -167,7 +175,7 @@ bool DatabaseService::updateUser(const User& user) {
         std::to_string(user.userId).c_str()
     };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 7, NULL, params, NULL, NULL, 0);
+    PGresult* res = UPDATE_USER.execute(connection, 7, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
     
@@ -176,16 +184,15 @@ bool DatabaseService::updateUser(const User& user) {
 
 User DatabaseService::getUserById(int userId) {
     User user;
-    configManager.loadConfig(currentConfig);
     
-    if (!connection && !connect(currentConfig)) {
+    PooledConnection connection = acquireConnection();
+    if (!connection) {
         return user;
     }
     
-    std::string sql = "SELECT user_id, email, login, phone_number, password_hash, last_name, first_name, middle_name FROM users WHERE user_id = $1";
     const char* params[1] = { std::to_string(userId).c_str() };
     
-    PGresult* res = PQexecParams(connection, sql.c_str(), 1, NULL, params, NULL, NULL, 0);
+    PGresult* res = GET_USER_BY_ID.execute(connection, 1, params);
     
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         PQclear(res);
@@ -0,0 +1,244 @@
+#include "database/QueryBatch.h"
+
+namespace {
+
+bool succeeded(const PGresult* res) {
+    ExecStatusType status = PQresultStatus(res);
+    return status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK;
+}
+
+std::vector<const char*> paramPointers(const std::vector<std::string>& params) {
+    std::vector<const char*> pointers;
+    pointers.reserve(params.size());
+    for (const auto& param : params) {
+        pointers.push_back(param.c_str());
+    }
+    return pointers;
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+// Результат очередного запроса конвейера; после него libpq отдает NULL - конец запроса.
+// NULL вместо результата - соединение оборвалось
+PGresult* takeResult(PGconn* connection) {
+    PGresult* res = PQgetResult(connection);
+    if (res) {
+        while (PGresult* extra = PQgetResult(connection)) {
+            PQclear(extra);
+        }
+    }
+    return res;
+}
+
+bool takeSync(PGconn* connection) {
+    PGresult* res = PQgetResult(connection);
+    bool synced = res && PQresultStatus(res) == PGRES_PIPELINE_SYNC;
+    PQclear(res);
+    return synced;
+}
+
+bool sendSync(PGconn* connection) {
+#ifdef LIBPQ_HAS_SEND_PIPELINE_SYNC
+    // Без сброса буфера: весь пакет уходит одним PQflush в конце
+    return PQsendPipelineSync(connection) == 1;
+#else
+    return PQpipelineSync(connection) == 1;
+#endif
+}
+
+bool sendCommand(PGconn* connection, const char* sql) {
+    return PQsendQueryParams(connection, sql, 0, NULL, NULL, NULL, NULL, 0) == 1;
+}
+#endif
+
+}
+
+QueryBatch::QueryBatch(Mode mode) : mode(mode) {}
+
+QueryBatch::~QueryBatch() {
+    clearResults();
+}
+
+size_t QueryBatch::add(const PreparedStatement& statement, std::vector<std::string> params) {
+    items.push_back(Item{&statement, std::move(params), nullptr});
+    return items.size() - 1;
+}
+
+void QueryBatch::clearResults() {
+    for (auto& item : items) {
+        PQclear(item.result);
+        item.result = nullptr;
+    }
+}
+
+PGresult* QueryBatch::result(size_t index) const {
+    return index < items.size() ? items[index].result : nullptr;
+}
+
+size_t QueryBatch::failedIndex() const {
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i].result && !succeeded(items[i].result)) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+std::string QueryBatch::error(size_t index) const {
+    PGresult* res = result(index);
+    return res ? PQresultErrorMessage(res) : failure;
+}
+
+bool QueryBatch::run(PGconn* connection) {
+    clearResults();
+    failure.clear();
+    if (!connection) {
+        failure = "нет соединения с БД";
+        return false;
+    }
+    if (items.empty()) {
+        return true;
+    }
+
+    // Пакет внутри уже открытой транзакции становится ее частью
+    bool ownTransaction = mode == Mode::TRANSACTION && PQtransactionStatus(connection) == PQTRANS_IDLE;
+#ifdef LIBPQ_HAS_PIPELINING
+    return runPipeline(connection, ownTransaction);
+#else
+    return runSequential(connection, ownTransaction);
+#endif
+}
+
+bool QueryBatch::sendItem(PGconn* connection, Item& item, bool prepared) {
+    std::vector<const char*> params = paramPointers(item.params);
+    return StatementRegistry::instance().send(connection, *item.statement, static_cast<int>(params.size()),
+                                              params.data(), prepared);
+}
+
+bool QueryBatch::runPipeline(PGconn* connection, bool ownTransaction) {
+#ifdef LIBPQ_HAS_PIPELINING
+    StatementRegistry& registry = StatementRegistry::instance();
+
+    // Синхронный PQprepare в режиме конвейера недоступен - готовим до входа в него
+    std::vector<char> prepared(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        prepared[i] = registry.ensurePrepared(connection, *items[i].statement);
+    }
+
+    if (PQenterPipelineMode(connection) != 1) {
+        return runSequential(connection, ownTransaction);
+    }
+
+    bool sent = !ownTransaction || sendCommand(connection, "BEGIN");
+    for (size_t i = 0; sent && i < items.size(); i++) {
+        sent = sendItem(connection, items[i], prepared[i]) &&
+               (mode == Mode::TRANSACTION || sendSync(connection));
+    }
+    if (sent && ownTransaction) {
+        sent = sendCommand(connection, "COMMIT");
+    }
+    if (sent && mode == Mode::TRANSACTION) {
+        sent = sendSync(connection);
+    }
+    if (sent) {
+        sent = PQflush(connection) == 0;
+    }
+    if (!sent) {
+        // Если часть пакета уже ушла, выйти из конвейера не получится: соединение останется
+        // занятым, и пул закроет его вместо возврата
+        failure = PQerrorMessage(connection);
+        PQexitPipelineMode(connection);
+        return false;
+    }
+
+    bool ok = true;
+    bool broken = false;
+    if (ownTransaction) {
+        PGresult* res = takeResult(connection);
+        broken = !res;
+        if (res && !succeeded(res)) {
+            ok = false;
+            failure = PQresultErrorMessage(res);
+        }
+        PQclear(res);
+    }
+    for (size_t i = 0; !broken && i < items.size(); i++) {
+        items[i].result = takeResult(connection);
+        if (!items[i].result) {
+            broken = true;
+            break;
+        }
+        registry.checkResult(connection, *items[i].statement, items[i].result);
+        if (!succeeded(items[i].result)) {
+            ok = false;
+        }
+        if (mode == Mode::INDEPENDENT && !takeSync(connection)) {
+            broken = true;
+        }
+    }
+    if (!broken && ownTransaction) {
+        // После ошибки COMMIT пропускается сервером (PGRES_PIPELINE_ABORTED) - это не отдельная ошибка
+        PGresult* res = takeResult(connection);
+        broken = !res;
+        if (res && PQresultStatus(res) == PGRES_FATAL_ERROR) {
+            ok = false;
+            failure = PQresultErrorMessage(res);
+        }
+        PQclear(res);
+    }
+    if (!broken && mode == Mode::TRANSACTION) {
+        broken = !takeSync(connection);
+    }
+
+    if (broken) {
+        failure = PQerrorMessage(connection);
+        PQexitPipelineMode(connection);
+        return false;
+    }
+    PQexitPipelineMode(connection);
+
+    // Ошибка внутри BEGIN оставляет транзакцию прерванной до явного ROLLBACK
+    if (ownTransaction && PQtransactionStatus(connection) == PQTRANS_INERROR) {
+        PGresult* res = PQexec(connection, "ROLLBACK");
+        PQclear(res);
+    }
+    return ok;
+#else
+    return runSequential(connection, ownTransaction);
+#endif
+}
+
+bool QueryBatch::runSequential(PGconn* connection, bool ownTransaction) {
+    if (ownTransaction) {
+        PGresult* res = PQexec(connection, "BEGIN");
+        bool begun = succeeded(res);
+        if (!begun) {
+            failure = PQresultErrorMessage(res);
+        }
+        PQclear(res);
+        if (!begun) {
+            return false;
+        }
+    }
+
+    bool ok = true;
+    for (auto& item : items) {
+        std::vector<const char*> params = paramPointers(item.params);
+        item.result = item.statement->execute(connection, static_cast<int>(params.size()), params.data());
+        if (!succeeded(item.result)) {
+            ok = false;
+            if (mode == Mode::TRANSACTION) {
+                break;
+            }
+        }
+    }
+
+    if (ownTransaction) {
+        PGresult* res = PQexec(connection, ok ? "COMMIT" : "ROLLBACK");
+        if (ok && !succeeded(res)) {
+            ok = false;
+            failure = PQresultErrorMessage(res);
+        }
+        PQclear(res);
+    }
+    return ok;
+}
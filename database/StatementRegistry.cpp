@@ -0,0 +1,154 @@
+#include "database/StatementRegistry.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+// SQLSTATE: такой подготовленный запрос уже есть / такого запроса нет
+const char* DUPLICATE_PREPARED_STATEMENT = "42P05";
+const char* INVALID_SQL_STATEMENT_NAME = "26000";
+
+bool hasState(const PGresult* res, const char* state) {
+    const char* code = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+    return code && std::strcmp(code, state) == 0;
+}
+
+}
+
+PreparedStatement::PreparedStatement(const char* name, const char* sql)
+    : statementName(name), statementSql(sql), index(0), calls(0) {
+    StatementRegistry::instance().add(this);
+}
+
+PGresult* PreparedStatement::execute(PGconn* connection, int paramCount, const char* const* params) const {
+    return StatementRegistry::instance().execute(connection, *this, paramCount, params);
+}
+
+StatementRegistry& StatementRegistry::instance() {
+    static StatementRegistry registry;
+    return registry;
+}
+
+void StatementRegistry::add(PreparedStatement* statement) {
+    statement->index = statements.size();
+    statements.push_back(statement);
+}
+
+size_t StatementRegistry::prepareAll(PGconn* connection) {
+    {
+        // После PQreset серверная сессия новая - прежние отметки недействительны
+        std::unique_lock<std::shared_mutex> lock(preparedMutex);
+        prepared[connection].assign(statements.size(), false);
+    }
+
+    size_t failed = 0;
+    for (const PreparedStatement* statement : statements) {
+        if (!prepare(connection, *statement)) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+void StatementRegistry::forget(PGconn* connection) {
+    std::unique_lock<std::shared_mutex> lock(preparedMutex);
+    prepared.erase(connection);
+}
+
+bool StatementRegistry::prepare(PGconn* connection, const PreparedStatement& statement) {
+    PGresult* res = PQprepare(connection, statement.statementName, statement.statementSql, 0, NULL);
+    bool success = PQresultStatus(res) == PGRES_COMMAND_OK ||
+                   hasState(res, DUPLICATE_PREPARED_STATEMENT);
+    PQclear(res);
+
+    if (success) {
+        std::unique_lock<std::shared_mutex> lock(preparedMutex);
+        auto it = prepared.find(connection);
+        if (it != prepared.end()) {
+            it->second[statement.index] = true;
+        }
+    }
+    return success;
+}
+
+PGresult* StatementRegistry::execute(PGconn* connection, const PreparedStatement& statement,
+                                     int paramCount, const char* const* params) {
+    statement.calls.fetch_add(1, std::memory_order_relaxed);
+
+    bool known = false;
+    bool ready = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(preparedMutex);
+        auto it = prepared.find(connection);
+        if (it != prepared.end()) {
+            known = true;
+            ready = it->second[statement.index];
+        }
+    }
+
+    // Соединение не из пула или запрос не готовится (ошибка в SQL, нет таблицы) -
+    // выполняем текстом, чтобы вызывающий получил обычную ошибку запроса
+    if (!known || (!ready && !prepare(connection, statement))) {
+        return PQexecParams(connection, statement.statementSql, paramCount, NULL, params, NULL, NULL, 0);
+    }
+
+    PGresult* res = PQexecPrepared(connection, statement.statementName, paramCount, params, NULL, NULL, 0);
+    // Запрос пропал на сервере (DEALLOCATE, пулер перед БД). Вне транзакции готовим заново;
+    // внутри транзакции ошибка уже прервала ее, повтор не поможет
+    if (hasState(res, INVALID_SQL_STATEMENT_NAME) && PQtransactionStatus(connection) == PQTRANS_IDLE &&
+        prepare(connection, statement)) {
+        PQclear(res);
+        res = PQexecPrepared(connection, statement.statementName, paramCount, params, NULL, NULL, 0);
+    }
+    return res;
+}
+
+bool StatementRegistry::ensurePrepared(PGconn* connection, const PreparedStatement& statement) {
+    {
+        std::shared_lock<std::shared_mutex> lock(preparedMutex);
+        auto it = prepared.find(connection);
+        if (it == prepared.end()) {
+            return false;
+        }
+        if (it->second[statement.index]) {
+            return true;
+        }
+    }
+    return prepare(connection, statement);
+}
+
+bool StatementRegistry::send(PGconn* connection, const PreparedStatement& statement,
+                             int paramCount, const char* const* params, bool isPrepared) {
+    statement.calls.fetch_add(1, std::memory_order_relaxed);
+    if (isPrepared) {
+        return PQsendQueryPrepared(connection, statement.statementName, paramCount, params, NULL, NULL, 0) == 1;
+    }
+    return PQsendQueryParams(connection, statement.statementSql, paramCount, NULL, params, NULL, NULL, 0) == 1;
+}
+
+void StatementRegistry::checkResult(PGconn* connection, const PreparedStatement& statement, const PGresult* res) {
+    if (!hasState(res, INVALID_SQL_STATEMENT_NAME)) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(preparedMutex);
+    auto it = prepared.find(connection);
+    if (it != prepared.end()) {
+        it->second[statement.index] = false;
+    }
+}
+
+std::vector<StatementRegistry::StatementStats> StatementRegistry::stats() const {
+    std::vector<StatementStats> result;
+    result.reserve(statements.size());
+    for (const PreparedStatement* statement : statements) {
+        StatementStats entry;
+        entry.name = statement->statementName;
+        entry.calls = statement->calls.load(std::memory_order_relaxed);
+        result.push_back(entry);
+    }
+    std::stable_sort(result.begin(), result.end(), [](const StatementStats& a, const StatementStats& b) {
+        return a.calls > b.calls;
+    });
+    return result;
+}
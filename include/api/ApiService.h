@@ -5,7 +5,9 @@
 #include "configs/ConfigManager.h"
 #include "models/Models.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <chrono>
 #include <random>
@@ -13,56 +15,139 @@
 #include <memory>
 #include <atomic>
 
+#include "json.hpp"
 #include "article/ArticleEditor.h"
-
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#define SOCKET_TYPE SOCKET
-#define INVALID_SOCKET_VAL INVALID_SOCKET
-#define CLOSE_SOCKET closesocket
-#else
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
-#include <arpa/inet.h>
-#define SOCKET_TYPE int
-#define INVALID_SOCKET_VAL -1
-#define CLOSE_SOCKET close
-#endif
+#include "api/EventLoop.h"
+#include "api/ClientConnection.h"
+#include "api/WorkerPool.h"
+#include "api/HttpParser.h"
+#include "api/Router.h"
+#include "api/SessionStore.h"
+#include "api/SessionActivityBuffer.h"
+#include "api/RejectedTokenCache.h"
+#include "api/SessionTokenSigner.h"
+#include "api/SessionGenerationTable.h"
+#include "api/RateLimiter.h"
+#include "api/IpFilter.h"
+#include "api/TlsContext.h"
 
 class ApiService {
 private:
     DatabaseService& dbService;
     ConfigManager configManager;
     ApiConfig apiConfig;
-    std::unordered_map<std::string, Session> sessions;
+    // Кэш сессий с посегментными блокировками; запросы к БД выполняются вне их
+    SessionStore sessionStore;
+    // Кэш загружен из БД целиком или сверен с ней после загрузки из снимка
+    std::atomic<bool> sessionCacheComplete;
+    // Продления сессий копятся здесь и пишутся в БД пачками из cleanupThread
+    SessionActivityBuffer sessionActivity;
+    // Недавно отклоненные токены: повтор такого токена не доходит до БД
+    RejectedTokenCache rejectedTokens;
+    // Подписанные токены проверяются без БД; отозванные копируются из revoked_tokens
+    SessionTokenSigner tokenSigner;
+    std::unordered_set<std::string> revokedTokens;
+    std::shared_mutex revokedTokensMutex;
+    // Поколения сессий по userId (только пользователи, отзывавшие сессии); копия users.session_generation
+    SessionGenerationTable sessionGenerations;
+    // Ограничение частоты запросов: O(1) на запрос, память фиксирована rateLimitMaxKeys.
+    // В режиме "cluster" потребление раз в rateLimitSyncIntervalSeconds сводится через БД.
+    RateLimiter rateLimiter;
+    // Списки CIDR и временные баны; проверяется сразу после accept()
+    IpFilter ipFilter;
+    // TLS и HTTP обслуживаются на одном порту; протокол определяется по первым байтам
+    TlsContext tlsContext;
     std::unordered_map<std::string, PasswordResetToken> passwordResetTokens;
-    std::mutex sessionsMutex;
     std::mutex passwordResetMutex;
     std::atomic<bool> running;
     SOCKET_TYPE serverSocket;
     std::thread serverThread;
     std::thread cleanupThread;
+    // Фоновая сверка кэша сессий, загруженного из снимка, с БД
+    std::thread reconcileThread;
+
+    // Реактор и клиентские соединения принадлежат serverThread
+    EventLoop eventLoop;
+    std::unordered_map<SOCKET_TYPE, ClientConnection> connections;
+    uint64_t nextConnectionId;
+
+    // Обработка запросов вынесена из потока событий в пул
+    WorkerPool workerPool;
+    std::mutex completedMutex;
+    std::vector<CompletedResponse> completedResponses;
+
+    // Этап обработки перед маршрутизатором; false - запрос завершен, ответ в response
+    using Middleware = std::function<bool(const Router::Match&, RequestContext&, std::string&)>;
+
+    // Маршруты и этапы строятся один раз в конструкторе, дальше только читаются
+    Router router;
+    std::vector<Middleware> middleware;
 
     ArticleEditor articleEditor;
     
-    std::string getClientInfo(SOCKET_TYPE clientSocket);
     void initializeNetwork();
     void cleanupNetwork();
     void runServer();
-    void handleClient(SOCKET_TYPE clientSocket);
+    void acceptConnections();
+    void handleClientEvent(SOCKET_TYPE clientSocket, uint32_t events);
+    // Смотрит первые байты без чтения: TLS ClientHello, HTTP-метод или мусор (false)
+    bool classifyConnection(ClientConnection& conn);
+    // false - рукопожатие TLS провалилось; tlsEstablished выставляется по его завершении
+    bool continueTlsHandshake(ClientConnection& conn);
+    void watchWritable(ClientConnection& conn);
+    bool pipelineFull(ClientConnection& conn);
+    bool readFromClient(ClientConnection& conn);
+    bool writeToClient(ClientConnection& conn);
+    void dispatchRequests(ClientConnection& conn);
+    void deliverCompletedResponses();
+    void closeConnection(SOCKET_TYPE clientSocket);
+    void closeIdleConnections();
     void runCleanup();
+    // Режим "cluster": отправляет локальное потребление лимитов в БД и подтягивает общее
+    void syncRateLimits();
+    // Раз в 5 минут: размер пула соединений БД и время ожидания соединения
+    void logDatabasePoolStats();
+    // Применяет списки IP и параметры автобанов; log - сообщать о загруженных правилах
+    void applyIpFilterConfig(const ApiConfig& config, bool log);
+    // Перечитывает api_config.json и применяет изменившиеся настройки фильтра IP
+    void reloadIpFilterConfig();
+    // Засчитывает клиенту ответ 400/429; при достижении порога IP банится
+    void recordClientStrike(uint32_t address, const std::string& clientIP, int statusCode);
+    void registerMiddleware();
+    // Списывает стоимость маршрута с бюджета пользователя или (без аутентификации) IP; false - ответ 429
+    bool chargeRateLimit(const Router::Match& match, const RequestContext& ctx, std::string& response);
+    void registerRoutes();
+    void applyRouteCosts();
+    // Заданы respond и deferred, а у маршрута есть асинхронный обработчик - *deferred = true,
+    // возвращается пустая строка, а ответ позже приходит в respond
     std::string processRequest(const std::string& method, const std::string& path,
                                 const std::string& body,
                                 const std::string& sessionToken,
-                                const std::string& clientInfo = "");
-    std::string createJsonResponse(const std::string& content, int statusCode = 200);
+                                const std::string& clientInfo = "",
+                                const Router::Responder& respond = Router::Responder(),
+                                bool* deferred = nullptr);
+    // extraHeaders - готовые строки заголовков, каждая с завершающим \r\n
+    std::string createJsonResponse(const std::string& content, int statusCode = 200, const std::string& extraHeaders = "");
     std::string generateSessionToken();
     
     // Session management
     void cleanupExpiredSessions();
+    void flushSessionActivity();
+    bool authenticateSignedToken(const std::string& token, const SignedTokenClaims& claims, Principal& principal);
+    bool isTokenRevoked(const std::string& token);
+    // Для подписанного токена заносит его в список отзыва; для случайного ничего не делает
+    void revokeSignedToken(const std::string& token);
+    void refreshRevokedTokens();
+    // Сессия выглядит отозванной сменой поколения - перепроверка по строке в БД
+    SessionGenerationTable::Verdict recheckSessionGeneration(const std::string& token, Session& stored);
+    // Отзывает все сессии пользователя за O(1), кроме keep (если задана); false - ошибка БД
+    bool revokeAllUserSessions(const std::string& userId, const Session* keep);
+    void refreshSessionGenerations();
     void loadSessionsFromDB();
+    // Быстрый старт из снимка; если снимка нет или он поврежден - полная загрузка из БД
+    void loadSessions();
+    void reconcileSessions(std::chrono::system_clock::time_point snapshotTime);
+    void saveSessionSnapshot();
     bool validateTokenInDatabase(const std::string& token);
 
 public:
@@ -74,10 +159,16 @@ public:
     return createJsonResponse("{\"success\": true, \"message\": \"Editor endpoint\"}");
 }
 
-    std::string processRequestFromRaw(const std::string& rawRequest, const std::string& clientIP = "");
-    std::string handleRevokeSessionByToken(const std::string& targetToken, const std::string& sessionToken);
+    // *deferred = true - ответ будет передан в respond (см. processRequest), иначе он возвращается
+    std::string processHttpRequest(const HttpParser& request, const std::string& clientIP = "",
+                                   const Router::Responder& respond = Router::Responder(),
+                                   bool* deferred = nullptr);
+    std::string handleRevokeSessionByToken(const std::string& targetToken, const Principal& principal);
     
-    std::string handleGetDashboard(const std::string& sessionToken);
+    std::string handleGetDashboard(const Principal& principal);
+    // Счетчики запрашиваются через асинхронные соединения, рабочий поток не ждет БД
+    void handleGetDashboardAsync(const Principal& principal, Router::Responder respond);
+    std::string createDashboardResponse(const User& user, const DashboardCounts& counts);
 
     // Authentication
     bool isValidPhoneNumber(const std::string& phoneNumber);
@@ -86,15 +177,21 @@ public:
     std::string handleForgotPassword(const std::string& body);
     std::string handleResetPassword(const std::string& body);
     std::string handleLogout(const std::string& sessionToken, const std::string& clientInfo = "");
+    std::string handleVerifyToken(const std::string& method, const std::string& body, const std::string& sessionToken);
     
     // Profile and password management
-    std::string handleChangePassword(const std::string& body, const std::string& sessionToken);
-    std::string getSessionInfo(const std::string& token);
-    std::string handleGetSessions(const std::string& sessionToken);
+    std::string handleChangePassword(const std::string& body, const Principal& principal);
+    std::string getSessionInfo(const Principal& principal);
+    std::string handleGetSessions(const Principal& principal);
+    // Общий JSON-список сессий пользователя для /sessions и /profile; истекшие и отозванные пропускаются
+    nlohmann::json buildSessionListJson(const std::string& userId, const std::string& currentToken);
     std::string handleRevokeSession(const std::string& body, const std::string& sessionToken);
+    std::string handleRevokeAllSessions(const Principal& principal);
     
     // Session validation
     bool validateSession(const std::string& token);
+    // Проверяет сессию и заполняет principal; продление уходит в БД отложенно
+    bool authenticateSession(const std::string& token, Principal& principal);
     std::string getUserIdFromSession(const std::string& token);
     
     // Password hashing
@@ -112,6 +209,7 @@ public:
     // CRUD operations
     std::string handleAddTeacher(const std::string& body);
     std::string handleUpdateTeacher(const std::string& body, int teacherId);
+    std::string handleUpdateTeacherFromBody(const std::string& body);
     std::string handleDeleteTeacher(int teacherId);
     std::string handleAddStudent(const std::string& body);
     std::string handleUpdateStudent(const std::string& body, int studentId);
@@ -120,27 +218,27 @@ public:
     std::string handleUpdateGroup(const std::string& body, int groupId);
     std::string handleDeleteGroup(int groupId);
     std::string handleGetStudentsByGroup(int groupId);
-    std::string handleUpdateProfile(const std::string& body, const std::string& sessionToken);
+    std::string handleUpdateProfile(const std::string& body, const Principal& principal);
     
     // Getters
-    std::string getProfile(const std::string& sessionToken);
-    std::string getTeachersJson(const std::string& sessionToken);
-    std::string getStudentsJson(const std::string& sessionToken);
-    std::string getGroupsJson(const std::string& sessionToken);
-    std::string getSpecializationsJson(const std::string& sessionToken);
+    std::string getProfile(const Principal& principal);
+    std::string getTeachersJson();
+    std::string getStudentsJson();
+    std::string getGroupsJson();
+    std::string getSpecializationsJson();
     std::string handleStatus();
 
     // Portfolio
     std::string handleAddPortfolio(const std::string& body);
     std::string handleUpdatePortfolio(const std::string& body, int portfolioId);
     std::string handleDeletePortfolio(int portfolioId);
-    std::string getPortfolioJson(const std::string& sessionToken);
+    std::string getPortfolioJson();
 
     // Event
     std::string handleAddEvent(const std::string& body);
     std::string handleUpdateEvent(const std::string& body, int eventId);
     std::string handleDeleteEvent(int eventId);
-    std::string getEventsJson(const std::string& sessionToken);
+    std::string getEventsJson();
 
     std::string handleAddEventCategory(const std::string& body);
 
@@ -0,0 +1,61 @@
+#ifndef CLIENTCONNECTION_H
+#define CLIENTCONNECTION_H
+
+#include "api/EventLoop.h"
+#include "api/HttpParser.h"
+#include "api/TlsContext.h"
+#include <string>
+#include <cstdint>
+#include <chrono>
+
+// Состояние одного клиентского соединения, которым владеет поток событий
+struct ClientConnection {
+    // Уникален в пределах процесса, в отличие от номера сокета, который ОС переиспользует
+    uint64_t id = 0;
+    SOCKET_TYPE socket = INVALID_SOCKET_VAL;
+    std::string clientIP;
+    // IPv4 клиента в порядке байт хоста, ключ фильтра IP
+    uint32_t clientAddress = 0;
+
+    // Протокол определяется по первым байтам, пока они не пришли - UNKNOWN
+    enum class Transport {
+        UNKNOWN,
+        PLAIN,
+        TLS
+    };
+    Transport transport = Transport::UNKNOWN;
+    TlsSession tls;
+    bool tlsEstablished = false;
+
+    // Входящие байты, еще не разобранные в запрос
+    std::string inBuffer;
+    // Состояние разбора текущего запроса в inBuffer
+    HttpParser parser;
+
+    // Ответ, который еще не ушел в сокет целиком
+    std::string outBuffer;
+    size_t outOffset = 0;
+
+    std::chrono::steady_clock::time_point acceptedAt;
+    std::chrono::steady_clock::time_point lastActivity;
+
+    // Сколько запросов уже принято по этому соединению (keep-alive)
+    int requestsServed = 0;
+
+    // Запрос передан в пул рабочих потоков, ответ еще не готов
+    bool requestInFlight = false;
+    // Чтение сокета приостановлено: за запросом в работе накопилось слишком много данных
+    bool readPaused = false;
+    bool writeInterest = false;
+    bool closeAfterWrite = false;
+    bool peerClosed = false;
+};
+
+// Готовый ответ, который рабочий поток возвращает потоку событий
+struct CompletedResponse {
+    SOCKET_TYPE socket;
+    uint64_t connectionId;
+    std::string response;
+};
+
+#endif
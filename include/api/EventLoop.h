@@ -0,0 +1,70 @@
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define SOCKET_TYPE SOCKET
+#define INVALID_SOCKET_VAL INVALID_SOCKET
+#define CLOSE_SOCKET closesocket
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#define SOCKET_TYPE int
+#define INVALID_SOCKET_VAL -1
+#define CLOSE_SOCKET close
+#endif
+
+// Реактор ввода-вывода: epoll в edge-triggered режиме на Linux, WSAPoll на Windows.
+// Все методы, кроме wakeup(), вызываются только из потока, который крутит poll().
+class EventLoop {
+public:
+    static constexpr uint32_t EVENT_READ = 1;
+    static constexpr uint32_t EVENT_WRITE = 2;
+    static constexpr uint32_t EVENT_ERROR = 4;
+    // Только для add()/modify(): сокет в level-triggered режиме. Нужен чужим сокетам
+    // (соединения libpq), владелец которых не гарантирует чтение до EAGAIN
+    static constexpr uint32_t EVENT_LEVEL = 8;
+
+    using Handler = std::function<void(SOCKET_TYPE socket, uint32_t events)>;
+
+    EventLoop();
+    ~EventLoop();
+
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    bool add(SOCKET_TYPE socket, uint32_t events);
+    bool modify(SOCKET_TYPE socket, uint32_t events);
+    void remove(SOCKET_TYPE socket);
+
+    // Ждет события не дольше timeoutMs и вызывает handler для каждого готового сокета.
+    // Возвращает количество обработанных событий или -1 при ошибке.
+    int poll(int timeoutMs, const Handler& handler);
+
+    // Прерывает ожидание в poll() из любого потока
+    void wakeup();
+
+    static bool setNonBlocking(SOCKET_TYPE socket);
+
+private:
+    void drainWakeup();
+
+#ifdef _WIN32
+    SOCKET_TYPE wakeupSocket;
+    sockaddr_in wakeupAddr;
+    std::unordered_map<SOCKET_TYPE, uint32_t> interests;
+#else
+    int epollFd;
+    int wakeupFd;
+#endif
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef HTTPPARSER_H
+#define HTTPPARSER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// Инкрементальный разбор HTTP/1.x запроса.
+// Парсер не копирует данные: он запоминает смещения внутри буфера соединения
+// и продолжает разбор с того места, где остановился в прошлый раз, поэтому
+// каждый принятый байт просматривается один раз. Смещения переживают
+// дописывание в буфер и его перемещение; string_view, которые возвращают
+// методы доступа, действительны до следующего изменения буфера.
+class HttpParser {
+public:
+    enum class State {
+        REQUEST_LINE,
+        HEADERS,
+        BODY,
+        COMPLETE,
+        ERROR
+    };
+
+    static const size_t MAX_HEADERS_SIZE = 64 * 1024;
+    static const size_t MAX_BODY_SIZE = 10 * 1024 * 1024;
+
+    HttpParser();
+
+    // Продолжает разбор; buffer - тот же буфер, что и при прошлых вызовах, возможно дописанный
+    State parse(std::string_view buffer);
+    // Привязывает уже разобранный запрос к буферу, в который перемещены те же байты
+    void rebind(std::string_view buffer) { data = buffer; }
+    // Готовит парсер к следующему запросу того же соединения
+    void reset();
+
+    State state() const { return currentState; }
+    bool complete() const { return currentState == State::COMPLETE; }
+    bool failed() const { return currentState == State::ERROR; }
+
+    // Полная длина запроса (заголовки + тело), известна после COMPLETE
+    size_t messageLength() const { return bodyStart + contentLength; }
+
+    std::string_view method() const { return view(methodSpan); }
+    std::string_view path() const { return view(pathSpan); }
+    std::string_view protocol() const { return view(protocolSpan); }
+    std::string_view body() const { return data.substr(bodyStart, contentLength); }
+
+    // Поиск заголовка без учета регистра; пустой view, если заголовка нет
+    std::string_view header(std::string_view name) const;
+    size_t headerCount() const { return headers.size(); }
+    std::string_view headerName(size_t index) const { return view(headers[index].name); }
+    std::string_view headerValue(size_t index) const { return view(headers[index].value); }
+
+    bool keepAlive() const;
+
+    int errorStatus() const { return errorCode; }
+    const char* errorMessage() const { return errorText; }
+
+    static bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+private:
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    struct HeaderSpan {
+        Span name;
+        Span value;
+    };
+
+    std::string_view view(const Span& span) const { return data.substr(span.offset, span.length); }
+    State fail(int status, const char* message);
+    bool parseRequestLine(size_t lineEnd);
+    bool parseHeaderLine(size_t lineEnd);
+
+    std::string_view data;
+    State currentState;
+
+    // Начало текущей строки и позиция, с которой продолжать поиск CRLF
+    size_t lineStart;
+    size_t scanPos;
+
+    Span methodSpan;
+    Span pathSpan;
+    Span protocolSpan;
+    std::vector<HeaderSpan> headers;
+
+    size_t bodyStart;
+    size_t contentLength;
+    bool contentLengthSeen;
+    bool transferEncodingSeen;
+    bool connectionClose;
+    bool connectionKeepAlive;
+
+    int errorCode;
+    const char* errorText;
+};
+
+#endif
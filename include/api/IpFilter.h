@@ -0,0 +1,88 @@
+#ifndef IPFILTER_H
+#define IPFILTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Фильтр IPv4-адресов, проверяемый сразу после accept(), до выделения буферов и логирования.
+// Постоянные правила - списки CIDR (блок/разрешение) в сжатом двоичном префиксном дереве:
+// у узла хранится весь общий префикс, поэтому поиск проходит не больше 33 узлов,
+// а обычно несколько. Решение - по самому длинному совпавшему префиксу,
+// так что разрешенная подсеть внутри заблокированной снова доступна.
+// Дерево неизменяемо и при перезагрузке конфигурации подменяется целиком.
+//
+// Временные баны выдаются автоматически: IP, набравший threshold ответов 400/429
+// за window, блокируется на duration. На разрешенные подсети баны не действуют.
+class IpFilter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    IpFilter();
+
+    // Пересобирает дерево; строки, не являющиеся IPv4/CIDR, возвращаются в invalid
+    void load(const std::vector<std::string>& blocked, const std::vector<std::string>& allowed,
+              std::vector<std::string>& invalid);
+    // threshold = 0 выключает автоматические баны
+    void configureBans(int threshold, std::chrono::seconds window, std::chrono::seconds duration);
+
+    // Адрес в порядке байт хоста
+    bool isBlocked(uint32_t address);
+    // Засчитывает адресу плохой ответ; true - адрес только что забанен
+    bool recordStrike(uint32_t address);
+    // Удаляет истекшие баны и устаревшие счетчики
+    void purgeExpired();
+
+    size_t ruleCount() const;
+    size_t banCount() const { return activeBans.load(std::memory_order_relaxed); }
+
+    static bool parseCidr(const std::string& text, uint32_t& prefix, uint8_t& length);
+
+private:
+    enum Action : int8_t {
+        NONE = -1,
+        BLOCK = 0,
+        ALLOW = 1
+    };
+
+    struct Node {
+        uint32_t prefix = 0;
+        uint8_t length = 0;
+        Action action = NONE;
+        int32_t children[2] = {-1, -1};
+    };
+
+    struct Table {
+        std::vector<Node> nodes;
+        int32_t root = -1;
+        size_t rules = 0;
+
+        void insert(uint32_t prefix, uint8_t length, Action action);
+        Action lookup(uint32_t address) const;
+    };
+
+    struct Strike {
+        int count = 0;
+        Clock::time_point windowStart;
+    };
+
+    mutable std::shared_mutex tableMutex;
+    std::shared_ptr<const Table> table;
+
+    std::mutex banMutex;
+    std::unordered_map<uint32_t, Clock::time_point> bans;
+    std::unordered_map<uint32_t, Strike> strikes;
+    // Позволяет не брать banMutex на каждом accept, пока банов нет
+    std::atomic<size_t> activeBans;
+    int banThreshold = 0;
+    std::chrono::seconds banWindow{60};
+    std::chrono::seconds banDuration{900};
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include "models/Models.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Ограничитель частоты запросов по алгоритму GCRA (generic cell rate algorithm).
+// На ключ хранится одно 8-байтное "теоретическое время прибытия" (TAT):
+// запрос разрешен, если после него TAT опережает текущее время не больше чем на окно.
+// Это эквивалентно корзине токенов на limit запросов, пополняемой равномерно за window,
+// а проверка стоит O(1) независимо от числа запросов в окне.
+//
+// Память фиксирована: ключи лежат в таблицах с открытой адресацией заданной емкости,
+// разбитых на сегменты со своими блокировками. Ключ с TAT в прошлом неотличим
+// от отсутствующего, поэтому такие слоты занимаются без потерь. Если свободных
+// слотов в окне поиска нет, вытесняется ключ с самым ранним TAT - ближайший к простою.
+//
+// Для работы нескольких экземпляров ограничитель копит в слоте потребление
+// (на сколько сдвинут TAT) с последней синхронизации. Периодически оно забирается
+// takeUsage(), складывается в общем хранилище, а итоговые TAT возвращаются
+// через mergeShared(). Проверка запроса при этом остается локальной.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // maxKeys округляется вверх до степени двойки и делится между сегментами
+    explicit RateLimiter(size_t maxKeys = 65536);
+
+    // Меняет емкость; накопленное состояние сбрасывается. Вызывается до приема запросов.
+    void configure(size_t maxKeys);
+
+    // cost - сколько запросов из limit списывает этот вызов; cost больше limit не пройдет никогда
+    bool isAllowed(const std::string& key, uint32_t limit, std::chrono::seconds window, uint32_t cost = 1);
+
+    // Потребление с прошлого вызова (ключ - хэш, value - наносекунды сдвига TAT); счетчики обнуляются
+    std::vector<RateLimitUsage> takeUsage();
+    // Применяет общие TAT (наносекунды Unix-времени): локальный TAT не может быть меньше общего
+    void mergeShared(const std::vector<RateLimitUsage>& shared);
+
+    size_t capacity() const { return shards.size() * slotsPerShard; }
+
+private:
+    struct Slot {
+        // 0 - слот пуст
+        uint64_t key = 0;
+        // Наносекунды steady_clock
+        int64_t tat = 0;
+        // Сдвиг TAT, еще не переданный в общее хранилище
+        int64_t pending = 0;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Slot> slots;
+    };
+
+    static uint64_t hashKey(const std::string& key);
+    static Slot* findSlot(Shard& shard, uint64_t hash, size_t mask, size_t probes);
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t slotsPerShard = 0;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef REJECTEDTOKENCACHE_H
+#define REJECTEDTOKENCACHE_H
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Ограниченный LRU-кэш недавно отклоненных токенов сессий.
+// Клиенты со старыми токенами и сканеры повторяют один и тот же токен,
+// и без кэша каждый такой запрос стоит SELECT в БД. Запись живет ttl,
+// при переполнении вытесняется самая давно использованная.
+class RejectedTokenCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RejectedTokenCache(size_t capacity = 10000,
+                                std::chrono::seconds ttl = std::chrono::seconds(60));
+
+    bool contains(const std::string& token);
+    void add(const std::string& token);
+    // Токен снова действителен (например, только что выдан при входе)
+    void remove(const std::string& token);
+
+private:
+    struct Entry {
+        std::string token;
+        Clock::time_point expiresAt;
+    };
+
+    std::mutex mutex;
+    // Начало списка - самые свежие записи
+    std::list<Entry> order;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t capacity;
+    std::chrono::seconds ttl;
+};
+
+#endif
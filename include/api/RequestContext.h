@@ -0,0 +1,42 @@
+#ifndef REQUESTCONTEXT_H
+#define REQUESTCONTEXT_H
+
+#include "models/Models.h"
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Значения, захваченные из пути шаблонами {id}, {hex}, {str} и {tail}
+struct RouteParams {
+    static const size_t MAX_PARAMS = 4;
+
+    std::string_view values[MAX_PARAMS];
+    // Для {id} число разбирается во время сопоставления, повторный stoi не нужен
+    int ids[MAX_PARAMS] = {};
+    size_t count = 0;
+
+    int id(size_t index) const { return ids[index]; }
+    std::string value(size_t index) const { return std::string(values[index]); }
+};
+
+// Пользователь, от имени которого выполняется запрос.
+// Заполняется один раз этапом аутентификации до вызова обработчика.
+struct Principal {
+    bool authenticated = false;
+    std::string userId;
+    Session session;
+};
+
+// Все, что нужно обработчику маршрута о текущем запросе
+struct RequestContext {
+    const std::string& method;
+    const std::string& path;
+    const std::string& body;
+    const std::string& sessionToken;
+    const std::string& clientInfo;
+    const std::string& clientIP;
+    const RouteParams& params;
+    Principal principal;
+};
+
+#endif
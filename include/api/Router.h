@@ -0,0 +1,99 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include "api/RequestContext.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Таблица маршрутов в виде дерева по сегментам пути.
+// Строится один раз при создании сервиса; сопоставление проходит путь
+// за один проход без выделения памяти. Шаблоны сегментов:
+//   {id}   - десятичное число, помещающееся в int
+//   {hex}  - шестнадцатеричная строка
+//   {str}  - любой непустой сегмент
+//   {tail} - весь остаток пути, включая '/'
+// При неоднозначности приоритет у статического сегмента, затем {id}, {hex}, {str}, {tail}.
+class Router {
+public:
+    using Handler = std::function<std::string(const RequestContext&)>;
+    // Асинхронный обработчик отдает ответ в Responder ровно один раз - сразу или позже из
+    // другого потока. RequestContext действителен только до возврата из обработчика
+    using Responder = std::function<void(std::string response)>;
+    using AsyncHandler = std::function<void(const RequestContext&, Responder)>;
+
+    enum Method : unsigned {
+        METHOD_GET = 1,
+        METHOD_POST = 2,
+        METHOD_PUT = 4,
+        METHOD_DELETE = 8,
+        METHOD_OPTIONS = 16
+    };
+
+    struct Route {
+        Handler handler;
+        // Если задан, используется вместо handler там, где вызывающий умеет ждать ответ
+        AsyncHandler asyncHandler;
+        bool requiresAuth = true;
+        // Сколько единиц бюджета частоты запросов списывает один вызов
+        uint32_t cost = 1;
+    };
+
+    enum class Result {
+        FOUND,
+        NOT_FOUND,
+        METHOD_NOT_ALLOWED
+    };
+
+    struct Match {
+        Result result = Result::NOT_FOUND;
+        const Route* route = nullptr;
+        RouteParams params;
+        // Методы, зарегистрированные для этого пути (для 405 и OPTIONS)
+        unsigned allowedMethods = 0;
+        // Методы этого пути, не требующие авторизации
+        unsigned publicMethods = 0;
+    };
+
+    Router();
+    ~Router();
+
+    void add(std::string_view method, std::string_view pattern, Handler handler, bool requiresAuth = true);
+    // Стоимость уже зарегистрированного маршрута; false - такого маршрута нет
+    bool setCost(std::string_view method, std::string_view pattern, uint32_t cost);
+    // Асинхронный вариант уже зарегистрированного маршрута; false - такого маршрута нет
+    bool setAsyncHandler(std::string_view method, std::string_view pattern, AsyncHandler handler);
+    Match match(std::string_view method, std::string_view path) const;
+
+    static unsigned methodBit(std::string_view method);
+    // Значение заголовка Allow, например "GET, PUT, OPTIONS"
+    static std::string allowHeader(unsigned methods);
+
+private:
+    static const size_t METHOD_COUNT = 5;
+
+    struct Node {
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> staticChildren;
+        std::unique_ptr<Node> idChild;
+        std::unique_ptr<Node> hexChild;
+        std::unique_ptr<Node> strChild;
+        std::unique_ptr<Node> tailChild;
+
+        Route routes[METHOD_COUNT];
+        unsigned methods = 0;
+        unsigned publicMethods = 0;
+    };
+
+    static size_t methodIndex(unsigned bit);
+    // Узел, соответствующий шаблону; create = false - nullptr, если его нет
+    Node* patternNode(std::string_view pattern, bool create);
+    bool matchNode(const Node& node, std::string_view path, size_t pos, unsigned method, Match& match) const;
+    bool matchLeaf(const Node& node, unsigned method, Match& match) const;
+
+    std::unique_ptr<Node> root;
+};
+
+#endif
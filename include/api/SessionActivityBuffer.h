@@ -0,0 +1,55 @@
+#ifndef SESSIONACTIVITYBUFFER_H
+#define SESSIONACTIVITYBUFFER_H
+
+#include "models/Models.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Отложенная запись продления сессий (write-behind).
+// Каждый запрос только запоминает новые last_activity/expires_at для токена;
+// повторные продления одного токена схлопываются в одну запись. Накопленное
+// забирается пачкой и уходит в БД одним многострочным UPDATE.
+// Сброс нужен по таймеру или раньше, если срок жизни сессии в памяти ушел
+// от сохраненного в БД дальше допустимого.
+class SessionActivityBuffer {
+public:
+    using Clock = std::chrono::system_clock;
+
+    SessionActivityBuffer();
+
+    void configure(std::chrono::seconds flushInterval, std::chrono::seconds maxExpiryDrift);
+
+    void record(const std::string& token, Clock::time_point lastActivity, Clock::time_point expiresAt);
+    // Сессия удалена - ее продление больше не нужно писать
+    void forget(const std::string& token);
+
+    bool flushDue(Clock::time_point now) const;
+    // Забирает все несохраненные продления и считает их записанными
+    std::vector<SessionActivity> takePending(Clock::time_point now);
+    // Возвращает пачку, которую не удалось записать в БД
+    void restore(const std::vector<SessionActivity>& batch);
+
+private:
+    struct Entry {
+        Clock::time_point lastActivity;
+        Clock::time_point expiresAt;
+        // expires_at на момент последнего сброса в БД (для новой записи - первого продления)
+        Clock::time_point persistedExpiresAt;
+        // persistedExpiresAt до takePending: если пачка не записалась, restore возвращает его
+        Clock::time_point previousPersistedExpiresAt;
+        bool dirty = false;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    size_t dirtyCount;
+    bool urgent;
+    Clock::time_point lastFlush;
+    std::chrono::seconds flushInterval;
+    std::chrono::seconds maxExpiryDrift;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SESSIONGENERATIONTABLE_H
+#define SESSIONGENERATIONTABLE_H
+
+#include "api/SessionTokenSigner.h"
+#include "models/Models.h"
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Копия users.session_generation (только пользователи, отзывавшие сессии).
+// Сессия из прошлого поколения отозвана вместе со всеми сессиями пользователя.
+//
+// Кэш сессий экземпляра не знает, что другой экземпляр при отзыве сохранил одну
+// сессию, переведя ее в новое поколение только в своем кэше и в БД. Поэтому
+// "устаревшая" по кэшу сессия перед удалением перепроверяется по строке БД (recheck).
+class SessionGenerationTable {
+public:
+    enum class Verdict { CURRENT, REVOKED, UNKNOWN };
+    // Строка sessions по токену: false - ошибка БД, true с пустым token - строки нет
+    using Lookup = std::function<bool(const std::string& token, Session& session)>;
+
+    void replace(const std::vector<UserSessionGeneration>& generations);
+    void publish(const UserSessionGeneration& entry);
+    // 0 - пользователь сессии не отзывал
+    int generation(int userId) const;
+
+    bool isStale(const Session& session) const;
+    // Подписанный токен без записи в кэше: поколение неизвестно, сравниваем время выдачи со временем отзыва
+    bool isStale(const SignedTokenClaims& claims) const;
+
+    // Окончательное решение по сессии, которая выглядит отозванной: CURRENT - строка в БД
+    // в текущем поколении (ее сохранили при отзыве), stored - эта строка; REVOKED - строки
+    // нет или она старая; UNKNOWN - БД не ответила, удалять сессию нельзя
+    Verdict recheck(const std::string& token, const Lookup& lookup, Session& stored) const;
+
+private:
+    mutable std::shared_mutex mutex;
+    std::unordered_map<int, UserSessionGeneration> generations;
+};
+
+#endif
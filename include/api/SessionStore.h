@@ -0,0 +1,161 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include "models/Models.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Кэш активных сессий, разбитый на сегменты (shards) по хэшу токена.
+// У каждого сегмента своя блокировка чтения/записи, поэтому проверки сессий
+// из разных рабочих потоков почти не пересекаются. Хранилище ничего не знает
+// о базе данных: вызывающий код выполняет запросы к БД вне блокировок,
+// а методы, удаляющие сессии, возвращают токены для последующего удаления из БД.
+// Истечение отслеживается кучей по expiresAt в каждом сегменте: продление
+// сессии кучу не трогает, устаревшая запись переставляется только когда
+// доходит до вершины, поэтому проход по истекшим стоит O(истекших), а не O(всех).
+//
+// Внутри сессия хранится компактно: токен - 32 байта вместо 64 hex-символов,
+// запись - 36 байт без указателей (id, поколение, упакованный IPv4, секунды Unix,
+// номера строк email/ОС в общем пуле). Наружу отдается обычный Session.
+// Токены, не являющиеся 64 hex-символами, в кэш не попадают.
+//
+// Каждый сегмент также ведет вторичный индекс userId -> токены своих сессий,
+// поэтому список сессий пользователя собирается из памяти, без запроса к БД.
+class SessionStore {
+public:
+    using Clock = std::chrono::system_clock;
+
+    enum class TouchResult {
+        UPDATED,
+        MISSING,
+        // Сессия истекла и уже удалена из кэша
+        EXPIRED
+    };
+
+    // shardCount округляется вверх до степени двойки
+    explicit SessionStore(size_t shardCount = 16);
+
+    bool find(const std::string& token, Session& session) const;
+    // Все сессии пользователя из кэша (включая истекшие, но еще не вычищенные), по времени создания
+    std::vector<Session> findByUser(const std::string& userId) const;
+    void put(const Session& session);
+    bool erase(const std::string& token);
+
+    // Продлевает сессию до newExpires и возвращает ее актуальную копию
+    TouchResult touch(const std::string& token, Clock::time_point now,
+                      Clock::time_point newExpires, Session& session);
+    // Переводит сессию в новое поколение (она переживает отзыв остальных сессий пользователя)
+    bool setGeneration(const std::string& token, int generation);
+
+    // Полностью заменяет содержимое кэша (загрузка из БД)
+    void replaceAll(const std::vector<Session>& sessions);
+
+    // Удаляет сессии, для которых predicate вернул true; возвращает их токены.
+    // Сегменты обходятся по одному, остальные в это время доступны.
+    std::vector<std::string> eraseIf(const std::function<bool(const Session&)>& predicate);
+
+    // Удаляет истекшие к моменту now сессии; возвращает их токены
+    std::vector<std::string> eraseExpired(Clock::time_point now);
+
+    // Добавляет сессии из БД; у уже известных берет более поздние lastActivity/expiresAt
+    void merge(const std::vector<Session>& sessions);
+    // Удаляет сессии, которых нет в activeTokens, кроме созданных не раньше createdSince
+    // (они могли появиться уже после того, как список был прочитан); возвращает число удаленных
+    size_t retainOnly(const std::vector<std::string>& activeTokens, Clock::time_point createdSince);
+
+    // Снимок кэша в файл: заголовок с версией и контрольной суммой, затем записи
+    // и пул строк как есть. Пишется во временный файл и атомарно переименовывается.
+    bool saveSnapshot(const std::string& path) const;
+    // Загружает снимок (через mmap, где он есть) в пустой кэш; savedAt - время снимка.
+    // Поврежденный или чужой версии файл отвергается целиком.
+    bool loadSnapshot(const std::string& path, Clock::time_point& savedAt);
+
+    size_t size() const;
+
+private:
+    using TokenKey = std::array<uint8_t, 32>;
+
+    // Токены и так случайны, поэтому хэш - просто 8 байт из хвоста
+    // (у подписанных токенов случайна только подпись во второй половине)
+    struct TokenKeyHash {
+        size_t operator()(const TokenKey& key) const;
+    };
+
+    struct SessionRecord {
+        int32_t sessionId;
+        int32_t userId;
+        int32_t generation;
+        uint32_t ipv4;
+        uint32_t emailId;
+        uint32_t userOSId;
+        uint32_t createdAt;
+        uint32_t lastActivity;
+        uint32_t expiresAt;
+    };
+
+    struct ExpiryEntry {
+        uint32_t expiresAt;
+        TokenKey token;
+
+        bool operator>(const ExpiryEntry& other) const { return expiresAt > other.expiresAt; }
+    };
+
+    using SessionMap = std::unordered_map<TokenKey, SessionRecord, TokenKeyHash>;
+    // У пользователя единицы сессий, поэтому вектор с линейным удалением дешевле множества
+    using UserIndex = std::unordered_map<int32_t, std::vector<TokenKey>>;
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        SessionMap sessions;
+        // Меняется только вместе с sessions, под той же блокировкой
+        UserIndex byUser;
+        // Может содержать записи удаленных сессий и устаревшие сроки - проверяются при извлечении
+        std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>> expiry;
+    };
+
+    // Пул строк, общих для многих сессий (email, User-Agent/ОС).
+    // Строки не удаляются: их число ограничено пользователями и клиентами, а не сессиями.
+    class StringPool {
+    public:
+        StringPool();
+        uint32_t intern(const std::string& value);
+        std::string get(uint32_t id) const;
+        std::vector<std::string> copy() const;
+        // Заменяет пул целиком; номера строк совпадают с индексами values
+        void reset(std::vector<std::string> values);
+
+    private:
+        mutable std::shared_mutex mutex;
+        std::deque<std::string> strings;
+        std::unordered_map<std::string_view, uint32_t> ids;
+    };
+
+    static bool parseToken(const std::string& token, TokenKey& key);
+    static std::string formatToken(const TokenKey& key);
+
+    Shard& shardFor(const TokenKey& key) const;
+    static void indexUser(UserIndex& index, int32_t userId, const TokenKey& key);
+    static void unindexUser(UserIndex& index, int32_t userId, const TokenKey& key);
+    static UserIndex buildUserIndex(const SessionMap& sessions);
+    // Удаляет запись вместе с ее строкой в индексе; возвращает следующий итератор
+    static SessionMap::iterator eraseRecord(Shard& shard, SessionMap::iterator it);
+    size_t shardIndex(const TokenKey& key) const;
+    SessionRecord pack(const Session& session);
+    Session unpack(const TokenKey& key, const SessionRecord& record) const;
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shardMask;
+    StringPool strings;
+};
+
+#endif
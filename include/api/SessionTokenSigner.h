@@ -0,0 +1,50 @@
+#ifndef SESSIONTOKENSIGNER_H
+#define SESSIONTOKENSIGNER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Данные, зашитые в подписанный токен
+struct SignedTokenClaims {
+    int userId = 0;
+    std::chrono::system_clock::time_point issuedAt;
+    std::chrono::system_clock::time_point expiresAt;
+};
+
+// Самодостаточные токены сессий, подписанные HMAC-SHA256.
+// Токен - те же 64 шестнадцатеричных символа (32 байта), что и случайный,
+// поэтому помещается в sessions.token и проходит маршруты с {hex}:
+//   [0]      версия формата
+//   [1..4]   userId, big-endian
+//   [5..8]   время выдачи, секунды Unix
+//   [9..12]  время истечения, секунды Unix
+//   [13..15] случайная добавка, чтобы токены одного пользователя не совпадали
+//   [16..31] первые 16 байт HMAC-SHA256 от байтов [0..15]
+// Проверка - только вычисление HMAC, без обращения к кэшу или БД,
+// поэтому токен принимает любой экземпляр API с тем же ключом.
+class SessionTokenSigner {
+public:
+    SessionTokenSigner();
+
+    // Пустой ключ выключает подписанные токены
+    void setKey(const std::string& key);
+    bool enabled() const { return !key.empty(); }
+
+    std::string issue(int userId, std::chrono::system_clock::time_point issuedAt,
+                      std::chrono::system_clock::time_point expiresAt) const;
+    // Проверяет формат (ровно 64 строчных шестнадцатеричных символа) и подпись;
+    // срок действия проверяет вызывающий код
+    bool verify(const std::string& token, SignedTokenClaims& claims) const;
+
+    // Случайный ключ для запуска без настроенного sessionSigningKey
+    static std::string generateKey();
+
+private:
+    bool sign(const uint8_t* payload, size_t length, uint8_t* mac) const;
+
+    std::vector<uint8_t> key;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TLSCONTEXT_H
+#define TLSCONTEXT_H
+
+#include "api/EventLoop.h"
+#include <memory>
+#include <string>
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+
+struct TlsSessionDeleter {
+    void operator()(SSL* ssl) const;
+};
+
+// TLS-состояние одного соединения; освобождается вместе с ClientConnection
+using TlsSession = std::unique_ptr<SSL, TlsSessionDeleter>;
+
+// Серверный контекст OpenSSL для TLS на том же порту, что и HTTP.
+// Возобновление сессий включено двумя способами: кэш сессий на сервере (по session ID)
+// и сессионные билеты (RFC 5077, для TLS 1.3 - PSK). Вернувшийся клиент пропускает
+// полный обмен ключами и проверку сертификата, что заметно дешевле полного рукопожатия.
+// Ключи билетов OpenSSL генерирует сам при создании контекста, поэтому билеты
+// действуют до перезапуска и только на этом экземпляре.
+class TlsContext {
+public:
+    TlsContext();
+    ~TlsContext();
+
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    // Загружает сертификат (цепочку PEM) и ключ; при ошибке error содержит причину
+    bool load(const std::string& certPath, const std::string& keyPath,
+              int sessionCacheSize, int sessionTimeoutSeconds, std::string& error);
+    bool enabled() const { return ctx != nullptr; }
+
+    // Серверная сторона TLS поверх уже принятого неблокирующего сокета
+    TlsSession createSession(SOCKET_TYPE socket) const;
+
+    // Первый байт записи TLS Handshake (ClientHello) - тип содержимого 0x16
+    static bool looksLikeClientHello(const unsigned char* data, size_t length);
+
+private:
+    SSL_CTX* ctx;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+// Пул рабочих потоков фиксированного размера.
+// У каждого потока своя очередь задач; простаивающий поток забирает работу
+// с хвоста чужих очередей (work stealing), поэтому медленная задача
+// не задерживает остальные, попавшие в ту же очередь.
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    WorkerPool();
+    ~WorkerPool();
+
+    // threadCount == 0 означает "по числу ядер"
+    void start(size_t threadCount);
+    // Дожидается выполнения уже поставленных задач и останавливает потоки
+    void stop();
+    void submit(Task task);
+    size_t size() const { return threads.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running;
+    std::atomic<size_t> nextQueue;
+    std::atomic<size_t> pendingTasks;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+};
+
+#endif
@@ -13,6 +13,7 @@ public:
     bool apiConfigExists();
     DatabaseConfig getDefaultDbConfig();
     ApiConfig getDefaultApiConfig();
+    const std::string& getDbConfigPath() const { return dbConfigFile; }
 
 private:
     DatabaseConfig currentDbConfig;
@@ -0,0 +1,139 @@
+#ifndef ASYNCDATABASE_H
+#define ASYNCDATABASE_H
+
+#include "database/StatementRegistry.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <libpq-fe.h>
+
+// Запросы к БД без блокировки потока: результат приходит в обратный вызов.
+// Несколько неблокирующих соединений libpq в режиме конвейера; их сокеты (PQsocket)
+// опрашивает реактор сервера вместе с клиентскими, поэтому ожидание ответа БД не
+// занимает ни одного потока, а на каждом соединении в работе может быть сразу много
+// запросов - каждый со своей точкой синхронизации, ошибка одного не задевает соседей.
+//
+// submit() вызывается из любого потока. Все остальное, включая обратные вызовы,
+// выполняется в потоке реактора: обработчик должен быть коротким и не ждать БД сам.
+class AsyncDatabase {
+public:
+    // result - nullptr, если до сервера запрос не дошел (нет соединения, сервис остановлен),
+    // тогда причина в error. Результат освобождается после возврата из обработчика
+    using Callback = std::function<void(const PGresult* result, const std::string& error)>;
+
+    // Как следить за сокетами соединений; чтение нужно всегда, запись - пока libpq не
+    // отправил буфер целиком. notify() вызывается из submit() в любом потоке
+    struct Reactor {
+        std::function<void(int socket)> add;
+        std::function<void(int socket, bool writable)> setWritable;
+        std::function<void(int socket)> remove;
+        std::function<void()> notify;
+    };
+
+    struct Stats {
+        size_t connections = 0;
+        size_t connected = 0;
+        size_t inFlight = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+    };
+
+    AsyncDatabase();
+    ~AsyncDatabase();
+
+    AsyncDatabase(const AsyncDatabase&) = delete;
+    AsyncDatabase& operator=(const AsyncDatabase&) = delete;
+
+    // Открывает соединения (блокирующе, до запуска реактора) и регистрирует их сокеты.
+    // Неподключившиеся переподключаются в фоне. false - не подключилось ни одно
+    bool open(const std::string& connectionInfo, size_t size, Reactor reactor);
+    // Завершает все ожидающие запросы ошибкой и закрывает соединения
+    void close();
+    bool isOpen() const;
+
+    // false - сервис не открыт: вызывающий выполняет запрос обычным способом.
+    // Параметры копируются
+    bool submit(const PreparedStatement& statement, std::vector<std::string> params, Callback callback);
+
+    // Поток реактора: принадлежит ли сокет соединению БД и обработка его событий
+    bool owns(int socket) const;
+    void handleEvent(int socket, bool readable, bool writable);
+    // Поток реактора, после каждого опроса: отправка новых запросов, переподключение
+    // и сброс соединений, где запрос ждет ответа дольше QUERY_TIMEOUT
+    void process();
+
+    Stats stats() const;
+
+private:
+    enum class State { CONNECTED, RESETTING, BROKEN };
+
+    // Ответ, которого ждем от сервера; приходят строго в порядке отправки
+    struct Expected {
+        enum class Kind { PREPARE, QUERY, SYNC };
+        Kind kind;
+        const PreparedStatement* statement;
+        Callback callback;
+        PGresult* result;
+        // Для QUERY: когда отправлен; по нему process() находит зависшие запросы
+        std::chrono::steady_clock::time_point sentAt;
+    };
+
+    struct Request {
+        const PreparedStatement* statement;
+        std::vector<std::string> params;
+        Callback callback;
+    };
+
+    struct Connection {
+        PGconn* connection = nullptr;
+        int socket = -1;
+        State state = State::BROKEN;
+        bool writable = false;
+        std::deque<Expected> expected;
+        // Запросов в работе: отправлены, но ответ еще не передан обработчику
+        size_t queries = 0;
+        // Подготовленные на этом соединении; после переподключения список пуст
+        std::unordered_set<const PreparedStatement*> prepared;
+        std::chrono::steady_clock::time_point retryAt;
+    };
+
+    bool enterAsyncMode(Connection& conn);
+    void watch(Connection& conn);
+    void unwatch(Connection& conn);
+    void setWritable(Connection& conn, bool writable);
+    bool send(Connection& conn, Request& request);
+    void flush(Connection& conn);
+    void readResults(Connection& conn);
+    void complete(const Callback& callback, const PGresult* result, const std::string& error);
+    void fail(Connection& conn, const std::string& error);
+    void startReset(Connection& conn);
+    void continueReset(Connection& conn);
+    void expireQueries(std::chrono::steady_clock::time_point now);
+    Connection* leastLoaded();
+    void dispatchBacklog();
+
+    std::vector<Connection> connections;
+    std::unordered_map<int, size_t> sockets;
+    Reactor reactor;
+    // Запросы, дожидающиеся места на соединении; только поток реактора
+    std::deque<Request> backlog;
+
+    mutable std::mutex incomingMutex;
+    std::vector<Request> incoming;
+    bool accepting;
+
+    std::atomic<size_t> connectionCount;
+    std::atomic<size_t> connectedCount;
+    std::atomic<size_t> inFlightCount;
+    std::atomic<uint64_t> completedCount;
+    std::atomic<uint64_t> failedCount;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <libpq-fe.h>
+
+class ConnectionPool;
+
+// Соединение, взятое из пула; возвращается в пул деструктором.
+// Неявно приводится к PGconn*, поэтому передается в PQexec/PQexecParams как есть;
+// пустой дескриптор (пул исчерпан или БД недоступна) приводится к nullptr.
+class PooledConnection {
+public:
+    PooledConnection() = default;
+    PooledConnection(PooledConnection&& other) noexcept;
+    PooledConnection& operator=(PooledConnection&& other) noexcept;
+    PooledConnection(const PooledConnection&) = delete;
+    PooledConnection& operator=(const PooledConnection&) = delete;
+    ~PooledConnection();
+
+    operator PGconn*() const { return connection; }
+    PGconn* get() const { return connection; }
+
+private:
+    friend class ConnectionPool;
+    PooledConnection(ConnectionPool* pool, PGconn* connection, uint64_t generation);
+    void release();
+
+    ConnectionPool* pool = nullptr;
+    PGconn* connection = nullptr;
+    uint64_t generation = 0;
+};
+
+// Пул соединений libpq для рабочих потоков API и консоли.
+// Одно соединение нельзя использовать из двух потоков одновременно, поэтому каждый
+// поток берет свое. Повторный acquire() в том же потоке, пока внешний дескриптор жив,
+// возвращает то же соединение: вложенные вызовы DatabaseService (например, пересчет
+// счетчика группы внутри транзакции добавления студента) остаются в одной транзакции
+// и не занимают второе соединение.
+//
+// При выдаче соединение проверяется: разорванное переподключается через PQreset,
+// а простоявшее дольше IDLE_CHECK_AFTER - еще и пустым запросом к серверу.
+// Соединение, возвращенное посреди транзакции, закрывается, а не отдается следующему.
+// Подключенные обработчики узнают о каждом открытии (и PQreset) и закрытии соединения -
+// через них реестр запросов готовит запросы на соединении.
+class ConnectionPool {
+public:
+    struct Stats {
+        size_t open = 0;
+        size_t idle = 0;
+        size_t maxSize = 0;
+        uint64_t checkouts = 0;
+        // Сколько выдач ждали освобождения соединения и сколько так и не дождались
+        uint64_t waits = 0;
+        uint64_t timeouts = 0;
+        uint64_t connectFailures = 0;
+        uint64_t totalWaitMicros = 0;
+        uint64_t maxWaitMicros = 0;
+    };
+
+    ConnectionPool();
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Задаются до configure(); вызываются в потоке, открывающем или закрывающем соединение
+    void setConnectionHooks(std::function<void(PGconn*)> onOpen, std::function<void(PGconn*)> onClose);
+
+    // Задает параметры и сразу открывает minSize соединений. Соединения со старыми
+    // параметрами закрываются (выданные - при возврате). false - не открылось ни одно.
+    bool configure(const std::string& connectionInfo, size_t minSize, size_t maxSize,
+                   std::chrono::milliseconds acquireTimeout);
+    bool configured() const;
+    // Меняет предел и таймаут без переподключения; лишние свободные соединения закрываются
+    void resize(size_t maxSize, std::chrono::milliseconds acquireTimeout);
+    // Закрывает все свободные соединения; выданные закроются при возврате
+    void close();
+
+    PooledConnection acquire();
+
+    Stats stats() const;
+
+private:
+    friend class PooledConnection;
+
+    struct IdleConnection {
+        PGconn* connection;
+        std::chrono::steady_clock::time_point returnedAt;
+    };
+
+    PGconn* openConnection(const std::string& connectionInfo);
+    bool checkHealth(PGconn* connection, std::chrono::steady_clock::time_point returnedAt);
+    void discard(PGconn* connection);
+    void finish(PGconn* connection);
+    void release(PGconn* connection, uint64_t generation);
+    void recordWait(std::chrono::steady_clock::duration waited, bool waitedForRelease);
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::vector<IdleConnection> idle;
+    std::string connectionInfo;
+    size_t maxSize;
+    std::chrono::milliseconds acquireTimeout;
+    // Открытые соединения: свободные, выданные и открываемые прямо сейчас
+    size_t openCount;
+    // Меняется при configure()/close(); соединения прошлых поколений не возвращаются в пул
+    uint64_t generation;
+    bool isConfigured;
+    Stats counters;
+    std::function<void(PGconn*)> openHook;
+    std::function<void(PGconn*)> closeHook;
+};
+
+#endif
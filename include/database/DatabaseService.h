@@ -3,8 +3,16 @@
 
 #include "configs/ConfigManager.h"
 #include "models/Models.h"
+#include "database/AsyncDatabase.h"
+#include "database/ConnectionPool.h"
+#include "database/QueryBatch.h"
+#include "database/StatementRegistry.h"
 #include <vector>
 #include <string>
+#include <mutex>
+#include <memory>
+#include <filesystem>
+#include <functional>
 #include <libpq-fe.h>
 
 class DatabaseService {
@@ -17,6 +25,8 @@ public:
     void disconnect();
     bool testConnection();
     bool setupDatabase();
+    // Выполняет пакет запросов на соединении текущего потока за один сетевой круг
+    bool executeBatch(QueryBatch& batch);
 
     // DashBoard info
     int getTeachersCount();
@@ -24,6 +34,11 @@ public:
     int getGroupsCount();
     int getPortfoliosCount();
     int getEventsCount();
+    // Все пять счетчиков одним пакетом
+    DashboardCounts getDashboardCounts();
+    // То же без блокировки: done вызывается в потоке событий API, неудавшиеся счетчики равны 0.
+    // false - асинхронные соединения недоступны, done не будет вызван
+    bool getDashboardCountsAsync(std::function<void(const DashboardCounts&)> done);
     
     // User management
     bool addUser(const User& user);
@@ -99,26 +114,88 @@ public:
     bool deleteEventCategory(int eventCode);
     
     // Get current config
-    DatabaseConfig getCurrentConfig() const { return currentConfig; }
+    DatabaseConfig getCurrentConfig() const;
+    // Конфигурация читается из файла один раз; эти методы перечитывают ее явно.
+    // Пул переподключается, только если изменились параметры соединения.
+    bool reloadConfig();
+    // Перечитывает конфигурацию, если файл изменился с прошлой загрузки; true - перечитана
+    bool reloadConfigIfChanged();
+    // Размер пула и время ожидания свободного соединения
+    ConnectionPool::Stats getPoolStats() const { return pool.stats(); }
+    // Вызовы подготовленных запросов, самые частые первыми
+    std::vector<StatementRegistry::StatementStats> getStatementStats() const {
+        return StatementRegistry::instance().stats();
+    }
+
+    // Открывает asyncConnections неблокирующих соединений, сокеты которых опрашивает
+    // реактор API; параметры подключения читаются один раз, при запуске сервера
+    bool openAsync(AsyncDatabase::Reactor reactor);
+    AsyncDatabase& getAsyncDatabase() { return asyncDatabase; }
+    AsyncDatabase::Stats getAsyncStats() const { return asyncDatabase.stats(); }
 
     // Sessions management
-    bool addSession(const Session& session);
-    bool createSession(const Session& session) { return addSession(session); } // Алиас для обратной совместимости
+    // Заполняет sessionId и текущее поколение сессий пользователя
+    bool addSession(Session& session);
+    bool createSession(Session& session) { return addSession(session); } // Алиас для обратной совместимости
     Session getSessionByToken(const std::string& token);
+    // false - ошибка БД или пул исчерпан; true с пустым session.token - сессии точно нет
+    bool getSessionByToken(const std::string& token, Session& session);
     bool updateSessionLastActivity(const std::string& token, 
                                   const std::chrono::system_clock::time_point& newLastActivity,
                                   const std::chrono::system_clock::time_point& newExpiresAt);
+    // Продлевает пачку сессий одним многострочным UPDATE
+    bool updateSessionsLastActivity(const std::vector<SessionActivity>& activities);
     bool deleteSession(const std::string& token);
+    // Удаляет пачку сессий одним запросом
+    bool deleteSessions(const std::vector<std::string>& tokens);
     std::vector<Session> getSessionsByUserId(const std::string& userId);
     std::vector<Session> getAllActiveSessions();
+    // Активные сессии, созданные или продленные начиная с since
+    std::vector<Session> getSessionsChangedSince(const std::chrono::system_clock::time_point& since);
+    // Только токены активных сессий - без разбора дат, для сверки кэша с БД.
+    // false - запрос не удался (пустой список в этом случае не означает "сессий нет")
+    bool getActiveSessionTokens(std::vector<std::string>& tokens);
     bool deleteExpiredSessions();
 
+    // Список отзыва подписанных токенов
+    bool addRevokedToken(const std::string& token, const std::chrono::system_clock::time_point& expiresAt);
+    // false - запрос не удался (пустой список в этом случае не означает "отозванных нет")
+    bool getRevokedTokens(std::vector<std::string>& tokens);
+    bool deleteExpiredRevokedTokens();
+    // Поколения сессий: увеличение поколения разом делает недействительными все сессии пользователя
+    bool bumpSessionGeneration(int userId, const std::chrono::system_clock::time_point& revokedAt, int& generation);
+    bool updateSessionGeneration(const std::string& token, int generation);
+    // false - запрос не удался (пустой список в этом случае не означает "отзывов не было")
+    bool getSessionGenerations(std::vector<UserSessionGeneration>& generations);
+    // Удаляет строки сессий, отставших от поколения пользователя, одним запросом
+    bool deleteStaleGenerationSessions();
+
+    // Общее состояние ограничителя частоты для нескольких экземпляров API.
+    // Складывает локальные сдвиги TAT и возвращает итоговые TAT этих ключей.
+    bool syncRateLimits(const std::vector<RateLimitUsage>& usage, std::vector<RateLimitUsage>& shared);
+    bool deleteIdleRateLimits();
+
 private:
     void executeSQL(const std::string& sql);
+    // Соединение для текущего метода; при первом обращении пул настраивается по текущей конфигурации
+    PooledConnection acquireConnection();
+    std::shared_ptr<const DatabaseConfig> configSnapshot() const;
+    void publishConfig(const DatabaseConfig& config);
+    bool reloadConfigLocked();
+    std::filesystem::file_time_type configModificationTime() const;
     
-    PGconn* connection;
-    DatabaseConfig currentConfig;
+    // Каждый рабочий поток API получает свое соединение; вложенные вызовы в том же потоке
+    // переиспользуют уже взятое
+    ConnectionPool pool;
+    // Сериализует настройку пула и перечитывание конфигурации; защищает configManager и configFileTime
+    std::mutex poolSetupMutex;
+    // Неизменяемый снимок конфигурации; при перечитывании заменяется целиком
+    mutable std::mutex configMutex;
+    std::shared_ptr<const DatabaseConfig> currentConfig;
+    std::filesystem::file_time_type configFileTime;
     ConfigManager configManager;
+    // Запросы из потока событий API без блокировки; соединения не из пула
+    AsyncDatabase asyncDatabase;
 };
 
 #endif
\ No newline at end of file
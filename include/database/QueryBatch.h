@@ -0,0 +1,63 @@
+#ifndef QUERYBATCH_H
+#define QUERYBATCH_H
+
+#include "database/StatementRegistry.h"
+#include <string>
+#include <vector>
+#include <libpq-fe.h>
+
+// Пакет запросов, отправляемый на сервер без ожидания ответа на каждый - режим конвейера
+// libpq (PQenterPipelineMode). Клиент ждет один сетевой круг на весь пакет вместо круга
+// на каждый запрос; при удаленной БД именно круги, а не выполнение, занимают основное время.
+//
+// INDEPENDENT - запросы независимы: за каждым идет своя точка синхронизации, и ошибка
+// одного не отменяет остальные, как при отдельных вызовах.
+// TRANSACTION - запросы обрамляются BEGIN/COMMIT (если соединение еще не в транзакции);
+// после первой ошибки сервер пропускает остальные, и транзакция откатывается.
+//
+// Соединение при этом остается блокирующим, поэтому пакет рассчитан на несколько
+// запросов, а не на тысячи: большой пакет может упереться в заполненные буферы сокета.
+class QueryBatch {
+public:
+    enum class Mode { INDEPENDENT, TRANSACTION };
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit QueryBatch(Mode mode = Mode::INDEPENDENT);
+    ~QueryBatch();
+
+    QueryBatch(const QueryBatch&) = delete;
+    QueryBatch& operator=(const QueryBatch&) = delete;
+
+    // Параметры копируются; возвращает номер запроса для result()
+    size_t add(const PreparedStatement& statement, std::vector<std::string> params = {});
+    size_t size() const { return items.size(); }
+
+    // Выполняет пакет; true - все запросы (и COMMIT) выполнены успешно
+    bool run(PGconn* connection);
+
+    // Результат запроса последнего run(); nullptr, если до запроса дело не дошло
+    PGresult* result(size_t index) const;
+    // Номер первого неудачного запроса или npos (ошибка вне запросов - нет соединения, COMMIT)
+    size_t failedIndex() const;
+    std::string error(size_t index) const;
+    // Ошибка всего пакета, не привязанная к запросу
+    const std::string& batchError() const { return failure; }
+
+private:
+    struct Item {
+        const PreparedStatement* statement;
+        std::vector<std::string> params;
+        PGresult* result;
+    };
+
+    bool runPipeline(PGconn* connection, bool ownTransaction);
+    bool runSequential(PGconn* connection, bool ownTransaction);
+    bool sendItem(PGconn* connection, Item& item, bool prepared);
+    void clearResults();
+
+    Mode mode;
+    std::vector<Item> items;
+    std::string failure;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef STATEMENTREGISTRY_H
+#define STATEMENTREGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <libpq-fe.h>
+
+// Именованный запрос DatabaseService. Объявляется константой на уровне файла и
+// регистрируется при статической инициализации, поэтому к открытию первого соединения
+// реестр уже знает все запросы. Сервер разбирает и планирует запрос один раз на
+// соединение, дальше передаются только параметры.
+class PreparedStatement {
+public:
+    PreparedStatement(const char* name, const char* sql);
+    PreparedStatement(const PreparedStatement&) = delete;
+    PreparedStatement& operator=(const PreparedStatement&) = delete;
+
+    // PQexecPrepared; результат и ошибки - как у PQexecParams с тем же текстом
+    PGresult* execute(PGconn* connection, int paramCount = 0, const char* const* params = nullptr) const;
+
+    const char* name() const { return statementName; }
+    const char* sql() const { return statementSql; }
+
+private:
+    friend class StatementRegistry;
+
+    const char* statementName;
+    const char* statementSql;
+    size_t index;
+    mutable std::atomic<uint64_t> calls;
+};
+
+// Реестр подготовленных запросов и их состояния на каждом соединении пула.
+// Пул вызывает prepareAll() для нового и переподключенного соединения и forget() перед
+// его закрытием. Запрос, который не удалось подготовить заранее (например, таблица
+// создается позже в setupDatabase), готовится при первом вызове на этом соединении.
+class StatementRegistry {
+public:
+    struct StatementStats {
+        std::string name;
+        uint64_t calls = 0;
+    };
+
+    static StatementRegistry& instance();
+
+    // Готовит все запросы на соединении; возвращает число неудачных
+    size_t prepareAll(PGconn* connection);
+    void forget(PGconn* connection);
+
+    PGresult* execute(PGconn* connection, const PreparedStatement& statement,
+                      int paramCount, const char* const* params);
+
+    // Для пакетов в режиме конвейера, где синхронный PQprepare недоступен: запрос готовится
+    // заранее, до PQenterPipelineMode, а отправляется без ожидания результата.
+    // false - запрос придется отправить текстом
+    bool ensurePrepared(PGconn* connection, const PreparedStatement& statement);
+    bool send(PGconn* connection, const PreparedStatement& statement,
+              int paramCount, const char* const* params, bool isPrepared);
+    // Если сервер ответил, что запроса нет (SQLSTATE 26000), при следующем вызове он готовится заново
+    void checkResult(PGconn* connection, const PreparedStatement& statement, const PGresult* res);
+
+    // Число вызовов каждого запроса с момента запуска, по убыванию
+    std::vector<StatementStats> stats() const;
+
+private:
+    friend class PreparedStatement;
+
+    StatementRegistry() = default;
+    void add(PreparedStatement* statement);
+    bool prepare(PGconn* connection, const PreparedStatement& statement);
+
+    // Заполняется только при статической инициализации, дальше только читается
+    std::vector<PreparedStatement*> statements;
+    // Какие запросы уже подготовлены на соединении. Соединением в каждый момент владеет
+    // один поток, но таблица общая для всех
+    mutable std::shared_mutex preparedMutex;
+    std::unordered_map<PGconn*, std::vector<bool>> prepared;
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include <map>
 #include <vector>
 
 struct DatabaseConfig {
@@ -12,6 +14,12 @@ struct DatabaseConfig {
     std::string database;
     std::string username;
     std::string password;
+    // Пул соединений: сколько открыть сразу, сколько максимум и сколько ждать свободного
+    int poolMinConnections;
+    int poolMaxConnections;
+    int poolAcquireTimeoutMs;
+    // Неблокирующие соединения для асинхронных запросов из потока событий API; 0 - отключены
+    int asyncConnections;
 };
 
 struct ApiConfig {
@@ -25,8 +33,43 @@ struct ApiConfig {
     bool enableSSL;
     std::string sslCertPath;
     std::string sslKeyPath;
-    int rateLimitRequests;
-    int rateLimitWindow;
+    // Возобновление TLS-сессий: емкость серверного кэша и срок жизни сессии/билета
+    int sslSessionCacheSize;
+    int sslSessionTimeoutSeconds;
+    // Сколько IP одновременно отслеживает ограничитель частоты; память - 24 байта на ключ
+    int rateLimitMaxKeys;
+    // Взвешенные бюджеты после аутентификации: отдельно для анонимных IP и для пользователей.
+    // Стоимость маршрута задается в rateLimitRouteCosts ключом "METHOD /шаблон", по умолчанию 1.
+    int rateLimitAnonymousRequests;
+    int rateLimitAnonymousWindow;
+    int rateLimitUserRequests;
+    int rateLimitUserWindow;
+    std::map<std::string, int> rateLimitRouteCosts;
+    // "local" - каждый экземпляр считает сам; "cluster" - потребление сводится через таблицу rate_limits
+    std::string rateLimitMode;
+    int rateLimitSyncIntervalSeconds;
+    // IPv4/CIDR-списки, проверяемые при accept(); перечитываются из файла без перезапуска.
+    // Разрешенные адреса не блокируются и не попадают под автоматические баны.
+    std::vector<std::string> ipBlocklist;
+    std::vector<std::string> ipAllowlist;
+    // Бан на ipAutoBanDurationSeconds после ipAutoBanThreshold ответов 400/429 за окно; 0 - выключено
+    int ipAutoBanThreshold;
+    int ipAutoBanWindowSeconds;
+    int ipAutoBanDurationSeconds;
+    int workerThreads;
+    int keepAliveTimeoutSeconds;
+    int maxKeepAliveRequests;
+    int sessionFlushIntervalSeconds;
+    int sessionMaxExpiryDriftSeconds;
+    // "random" - случайный токен, проверяемый по кэшу и БД; "signed" - токен с HMAC-подписью
+    std::string sessionTokenFormat;
+    std::string sessionSigningKey;
+    // Снимок кэша сессий для быстрого старта; пустой путь отключает снимки
+    std::string sessionSnapshotPath;
+    int sessionSnapshotIntervalSeconds;
+    // true - API работает одним экземпляром: кэш сессий полон, и список сессий пользователя
+    // собирается из него без запроса к БД. При нескольких экземплярах нужно false
+    bool singleInstance;
 };
 
 struct User {
@@ -78,7 +121,9 @@ struct StudentGroup {
 };
 
 struct Session {
-    int sessionId;
+    int sessionId = 0;
+    // Поколение сессий пользователя на момент входа; сессия старше users.session_generation недействительна
+    int generation = 0;
     std::string token;
     std::string userId;
     std::string email;
@@ -89,6 +134,37 @@ struct Session {
     std::string userOS;
 };
 
+// Текущее поколение сессий пользователя: увеличивается при отзыве всех его сессий
+struct UserSessionGeneration {
+    int userId = 0;
+    int generation = 0;
+    // Когда поколение сменилось в последний раз - по нему проверяются подписанные токены без записи в кэше
+    std::chrono::system_clock::time_point revokedAt;
+};
+
+// Состояние ограничителя частоты для общего хранилища: key - 64-битный хэш ключа,
+// value - либо сдвиг TAT в наносекундах, либо сам TAT в наносекундах Unix-времени
+struct RateLimitUsage {
+    int64_t key = 0;
+    int64_t value = 0;
+};
+
+// Счетчики для главной страницы
+struct DashboardCounts {
+    int teachers = 0;
+    int students = 0;
+    int groups = 0;
+    int portfolios = 0;
+    int events = 0;
+};
+
+// Продление сессии, ожидающее записи в БД
+struct SessionActivity {
+    std::string token;
+    std::chrono::system_clock::time_point lastActivity;
+    std::chrono::system_clock::time_point expiresAt;
+};
+
 struct PasswordResetToken {
     std::string email;
     std::chrono::system_clock::time_point createdAt;
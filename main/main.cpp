@@ -138,6 +138,7 @@ public:
             DatabaseConfig config = dbService.getCurrentConfig();
             config.language = newLanguage;
             configManager.saveConfig(config);
+            dbService.reloadConfig();
             
             showMessage(MessageType::SUCCESS, tr("language_changed"));
         }
@@ -358,6 +359,8 @@ private:
             if (!pass.empty()) currentConfig.password = pass;
 
             if (configManager.saveConfig(currentConfig)) {
+                // Соединения пересоздаются, только если изменились параметры подключения
+                dbService.reloadConfig();
                 showMessage(MessageType::SUCCESS, tr("settings_saved"));
             } else {
                 showMessage(MessageType::ERR, "Failed to save settings");
@@ -0,0 +1,115 @@
+#include "api/HttpParser.h"
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& name) {
+    if (!condition) {
+        std::cerr << "FAIL: " << name << std::endl;
+        failures++;
+    }
+}
+
+// Разбирает запрос, пришедший одним куском
+HttpParser parseWhole(const std::string& request) {
+    HttpParser parser;
+    parser.parse(request);
+    return parser;
+}
+
+}
+
+int main() {
+    // Запрос приходит по частям: разрыв внутри строки запроса, внутри CRLF и внутри тела
+    {
+        const std::string request =
+            "POST /login HTTP/1.1\r\nHost: x\r\nContent-Length: 11\r\n\r\n{\"a\": \"bc\"}";
+        std::string buffer;
+        HttpParser parser;
+        bool prematureComplete = false;
+        for (size_t cut : {5, 21, 40, 56, 60}) {
+            buffer.append(request, buffer.size(), cut - buffer.size());
+            prematureComplete |= parser.parse(buffer) == HttpParser::State::COMPLETE;
+        }
+        check(!prematureComplete, "split request is not complete before the last byte");
+        check(parser.state() == HttpParser::State::BODY, "headers done, waiting for body");
+        buffer.append(request, buffer.size(), std::string::npos);
+        check(parser.parse(buffer) == HttpParser::State::COMPLETE, "split request completes");
+        check(parser.method() == "POST" && parser.path() == "/login", "request line survives splits");
+        check(parser.header("content-length") == "11", "header lookup ignores case");
+        check(parser.body() == "{\"a\": \"bc\"}", "body survives splits");
+        check(parser.messageLength() == request.size(), "message length covers headers and body");
+    }
+
+    // Буфер переносится в другую строку между вызовами (как при росте std::string)
+    {
+        std::string first = "GET /a HTTP/1.1\r\nHo";
+        HttpParser parser;
+        parser.parse(first);
+        std::string moved = first + "st: x\r\n\r\n";
+        check(parser.parse(moved) == HttpParser::State::COMPLETE, "parser resumes on a reallocated buffer");
+        check(parser.header("Host") == "x", "header read from the new buffer");
+    }
+
+    // Два конвейерных запроса в одном буфере
+    {
+        std::string buffer =
+            "POST /one HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+            "GET /two HTTP/1.1\r\nConnection: close\r\n\r\n";
+        HttpParser parser;
+        check(parser.parse(buffer) == HttpParser::State::COMPLETE, "first pipelined request completes");
+        check(parser.path() == "/one" && parser.body() == "abc", "first request does not eat the second");
+        check(parser.keepAlive(), "HTTP/1.1 defaults to keep-alive");
+        buffer.erase(0, parser.messageLength());
+        parser.reset();
+        check(parser.parse(buffer) == HttpParser::State::COMPLETE, "second pipelined request completes");
+        check(parser.path() == "/two" && parser.body().empty(), "second request parsed after reset");
+        check(!parser.keepAlive(), "Connection: close is honoured");
+    }
+
+    // Content-Length
+    {
+        HttpParser same = parseWhole("POST / HTTP/1.1\r\nContent-Length: 2\r\nContent-Length: 2\r\n\r\nok");
+        check(same.complete() && same.body() == "ok", "repeated equal Content-Length is accepted");
+
+        HttpParser conflict = parseWhole("POST / HTTP/1.1\r\nContent-Length: 2\r\nContent-Length: 3\r\n\r\nok!");
+        check(conflict.failed() && conflict.errorStatus() == 400, "conflicting Content-Length is rejected");
+
+        HttpParser invalid = parseWhole("POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n");
+        check(invalid.failed() && invalid.errorStatus() == 400, "non-numeric Content-Length is rejected");
+
+        HttpParser huge = parseWhole("POST / HTTP/1.1\r\nContent-Length: " +
+                                     std::to_string(HttpParser::MAX_BODY_SIZE + 1) + "\r\n\r\n");
+        check(huge.failed() && huge.errorStatus() == 413, "oversized body is rejected before it arrives");
+    }
+
+    // Transfer-Encoding не поддерживается: тело chunked иначе стало бы следующим запросом
+    {
+        HttpParser chunked = parseWhole("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n");
+        check(chunked.failed() && chunked.errorStatus() == 501, "Transfer-Encoding alone is 501");
+
+        HttpParser before = parseWhole("POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n");
+        check(before.failed() && before.errorStatus() == 400, "Content-Length then Transfer-Encoding is 400");
+
+        HttpParser after = parseWhole("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\n");
+        check(after.failed() && after.errorStatus() == 400, "Transfer-Encoding then Content-Length is 400");
+
+        HttpParser mixedCase = parseWhole("POST / HTTP/1.1\r\ntransfer-ENCODING: chunked\r\n\r\n");
+        check(mixedCase.failed() && mixedCase.errorStatus() == 501, "header name match ignores case");
+    }
+
+    // Заголовки без конца не копятся дольше предела
+    {
+        std::string endless = "GET / HTTP/1.1\r\nX: " + std::string(HttpParser::MAX_HEADERS_SIZE, 'a');
+        HttpParser parser = parseWhole(endless);
+        check(parser.failed() && parser.errorStatus() == 400, "unterminated headers hit the size limit");
+    }
+
+    if (failures == 0) {
+        std::cout << "HttpParser: all checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
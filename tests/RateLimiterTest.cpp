@@ -0,0 +1,63 @@
+#include "api/RateLimiter.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& name) {
+    if (!condition) {
+        std::cerr << "FAIL: " << name << std::endl;
+        failures++;
+    }
+}
+
+// Сколько запросов подряд пропускает ограничитель (с запасом над limit)
+int burst(RateLimiter& limiter, const std::string& key, uint32_t limit, std::chrono::seconds window,
+          uint32_t cost = 1) {
+    int allowed = 0;
+    for (uint32_t i = 0; i < limit * 2 + 2; i++) {
+        if (limiter.isAllowed(key, limit, window, cost)) {
+            allowed++;
+        }
+    }
+    return allowed;
+}
+
+}
+
+int main() {
+    RateLimiter limiter(1024);
+    check(limiter.capacity() >= 1024, "capacity covers maxKeys");
+
+    const std::chrono::seconds minute(60);
+    check(burst(limiter, "ip:a", 10, minute) == 10, "burst equals limit");
+    check(!limiter.isAllowed("ip:a", 10, minute), "key stays exhausted");
+    check(burst(limiter, "ip:b", 10, minute) == 10, "keys have independent budgets");
+
+    // Вес маршрута: стоимость 4 из 10 - два запроса, третий не помещается
+    check(burst(limiter, "user:cost", 10, minute, 4) == 2, "cost is charged per request");
+    check(limiter.isAllowed("user:cost", 10, minute, 2), "remaining units are still usable");
+
+    check(limiter.isAllowed("user:whole", 10, minute, 10), "cost equal to limit passes on an idle key");
+    check(!limiter.isAllowed("user:fresh", 10, minute, 11), "cost above limit is denied on an idle key");
+    check(burst(limiter, "user:fresh", 10, minute, 11) == 0, "cost above limit is never allowed");
+
+    check(!limiter.isAllowed("ip:zero", 0, minute), "limit 0 denies everything");
+    check(limiter.isAllowed("ip:nowindow", 1, std::chrono::seconds(0)), "empty window disables the limit");
+
+    // Пополнение: одна единица за window/limit. 4 запроса за 2 секунды - единица раз в 500 мс
+    const std::chrono::seconds twoSeconds(2);
+    check(burst(limiter, "ip:refill", 4, twoSeconds) == 4, "refill key starts with a full burst");
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    check(limiter.isAllowed("ip:refill", 4, twoSeconds), "one unit returns after window/limit");
+    check(!limiter.isAllowed("ip:refill", 4, twoSeconds), "only one unit returns after window/limit");
+
+    if (failures == 0) {
+        std::cout << "RateLimiter: all checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
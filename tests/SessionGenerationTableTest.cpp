@@ -0,0 +1,91 @@
+#include "api/SessionGenerationTable.h"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& name) {
+    if (!condition) {
+        std::cerr << "FAIL: " << name << std::endl;
+        failures++;
+    }
+}
+
+Session row(const std::string& token, const std::string& userId, int generation) {
+    Session session;
+    session.token = token;
+    session.userId = userId;
+    session.generation = generation;
+    return session;
+}
+
+}
+
+int main() {
+    using Verdict = SessionGenerationTable::Verdict;
+    auto now = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+
+    // Экземпляр B с холодным кэшем: пользователь 7 сменил пароль на экземпляре A,
+    // тот перевел сохраненную сессию "kept" в поколение 2 только у себя и в БД
+    SessionGenerationTable table;
+    UserSessionGeneration entry;
+    entry.userId = 7;
+    entry.generation = 2;
+    entry.revokedAt = now;
+    table.replace({entry});
+
+    std::map<std::string, Session> database = {
+        {"kept", row("kept", "7", 2)},
+        {"other", row("other", "7", 1)},
+    };
+    bool databaseUp = true;
+    SessionGenerationTable::Lookup lookup = [&](const std::string& token, Session& session) {
+        if (!databaseUp) return false;
+        auto it = database.find(token);
+        if (it != database.end()) session = it->second;
+        return true;
+    };
+
+    check(table.generation(7) == 2, "generation is published");
+    check(table.generation(8) == 0, "users without revocations have generation 0");
+
+    // Подписанный токен выдан до отзыва - по времени выдачи он выглядит отозванным
+    SignedTokenClaims claims;
+    claims.userId = 7;
+    claims.issuedAt = now - std::chrono::minutes(10);
+    check(table.isStale(claims), "signed token issued before revocation looks stale");
+
+    Session stored;
+    check(table.recheck("kept", lookup, stored) == Verdict::CURRENT, "kept session survives cold-cache recheck");
+    check(stored.generation == 2 && stored.userId == "7", "recheck returns the stored row");
+
+    // Случайный токен в кэше B остался в старом поколении
+    Session cached = row("kept", "7", 1);
+    check(table.isStale(cached), "cached copy of kept session looks stale");
+    check(table.recheck(cached.token, lookup, stored) == Verdict::CURRENT, "cached kept session is confirmed by DB");
+
+    check(table.recheck("other", lookup, stored) == Verdict::REVOKED, "other session of the user is revoked");
+    check(table.recheck("missing", lookup, stored) == Verdict::REVOKED, "deleted session is revoked");
+
+    databaseUp = false;
+    check(table.recheck("kept", lookup, stored) == Verdict::UNKNOWN, "DB failure is not a revocation");
+    databaseUp = true;
+
+    claims.issuedAt = now + std::chrono::seconds(1);
+    check(!table.isStale(claims), "token issued after revocation is current");
+    claims.issuedAt = now;
+    check(table.isStale(claims), "token issued in the revocation second is stale");
+
+    entry.generation = 3;
+    table.publish(entry);
+    check(table.recheck("kept", lookup, stored) == Verdict::REVOKED, "later revocation without keep wins");
+
+    if (failures == 0) {
+        std::cout << "SessionGenerationTable: all checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#include "api/SessionTokenSigner.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& name) {
+    if (!condition) {
+        std::cerr << "FAIL: " << name << std::endl;
+        failures++;
+    }
+}
+
+}
+
+int main() {
+    SessionTokenSigner signer;
+    signer.setKey("test-signing-key");
+
+    auto now = std::chrono::system_clock::now();
+    std::string token = signer.issue(42, now, now + std::chrono::hours(1));
+    check(token.size() == 64, "issued token is 64 characters");
+
+    SignedTokenClaims claims;
+    check(signer.verify(token, claims), "issued token verifies");
+    check(claims.userId == 42, "claims carry userId");
+
+    // Отозванный токен ищется в кэше и списке отзыва как строка: тот же токен
+    // в верхнем регистре не должен проходить подпись
+    std::string upper = token;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    check(upper != token, "token contains hex letters");
+    check(!signer.verify(upper, claims), "uppercase replay is rejected");
+
+    std::string mixed = token;
+    for (char& c : mixed) {
+        if (c >= 'a' && c <= 'f') {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            break;
+        }
+    }
+    check(!signer.verify(mixed, claims), "single uppercase digit is rejected");
+
+    std::string tampered = token;
+    tampered[63] = tampered[63] == '0' ? '1' : '0';
+    check(!signer.verify(tampered, claims), "tampered MAC is rejected");
+    check(!signer.verify(token.substr(0, 62), claims), "short token is rejected");
+
+    if (failures == 0) {
+        std::cout << "SessionTokenSigner: all checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}